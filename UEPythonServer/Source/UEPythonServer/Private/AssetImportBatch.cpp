@@ -0,0 +1,192 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "AssetImportBatch.h"
+#include "AssetUploadStaging.h"
+#include "UObject/SoftObjectPath.h"
+
+#if WITH_EDITOR
+#include "AssetToolsModule.h"
+#include "AssetImportTask.h"
+#include "FileHelpers.h"
+#include "UObject/Package.h"
+#endif
+
+const TCHAR* LexToString(EAssetImportItemState State)
+{
+	switch (State)
+	{
+	case EAssetImportItemState::Pending:
+		return TEXT("pending");
+	case EAssetImportItemState::Imported:
+		return TEXT("imported");
+	case EAssetImportItemState::Failed:
+		return TEXT("failed");
+	default:
+		return TEXT("unknown");
+	}
+}
+
+FAssetImportBatch::FAssetImportBatch(TArray<FAssetImportBatchItem> InItems, bool bInReplaceExisting, bool bInSave, int32 InSliceSize)
+	: Id(FGuid::NewGuid())
+	, Items(MoveTemp(InItems))
+	, bReplaceExisting(bInReplaceExisting)
+	, bSave(bInSave)
+	, SliceSize(FMath::Max(InSliceSize, 1))
+{
+}
+
+bool FAssetImportBatch::ImportNextSlice(FAssetUploadStaging& UploadStaging)
+{
+	check(IsInGameThread());
+	
+	if (bFinished)
+	{
+		return true;
+	}
+	
+	const int32 SliceEnd = FMath::Min(NextItemIndex + SliceSize, Items.Num());
+	
+#if WITH_EDITOR
+	// Importers prompt for overwrites and options unless the import is unattended
+	TGuardValue<bool> UnattendedScriptGuard(GIsRunningUnattendedScript, true);
+	
+	TArray<UAssetImportTask*> Tasks;
+	TArray<int32> TaskItemIndices;
+	TArray<TSharedPtr<const FStagedUpload>> FileBackedUploads;
+	
+	for (int32 Index = NextItemIndex; Index < SliceEnd; ++Index)
+	{
+		FAssetImportBatchItem& Item = Items[Index];
+		FString FileName = Item.FileName;
+		
+		if (Item.UploadId.IsValid())
+		{
+			TSharedPtr<const FStagedUpload> Upload = UploadStaging.Find(Item.UploadId);
+			if (!Upload.IsValid())
+			{
+				Item.State = EAssetImportItemState::Failed;
+				Item.Error = TEXT("Unknown or expired upload id");
+				continue;
+			}
+			
+			// Formats with an in-memory factory are created right away, the save is still deferred to the end
+			if (FAssetUploadStaging::CanImportFromMemory(Upload->FileName))
+			{
+				FStagedUploadImportOptions Options;
+				Options.DestinationPath = Item.DestinationPath;
+				Options.AssetName = Item.AssetName;
+				Options.bReplaceExisting = bReplaceExisting;
+				Options.bSave = false;
+				
+				bool bFromMemory = false;
+				const bool bImported = FAssetUploadStaging::Import(*Upload, Options, Item.ObjectPaths, bFromMemory, Item.Error);
+				Item.State = bImported ? EAssetImportItemState::Imported : EAssetImportItemState::Failed;
+				UploadStaging.Release(Item.UploadId);
+				continue;
+			}
+			
+			FileName = FAssetUploadStaging::WriteStagingFile(*Upload);
+			if (FileName.IsEmpty())
+			{
+				Item.State = EAssetImportItemState::Failed;
+				Item.Error = FString::Printf(TEXT("Failed to write the staging file of %s"), *Upload->FileName);
+				continue;
+			}
+			FileBackedUploads.Add(Upload);
+		}
+		
+		UAssetImportTask* Task = NewObject<UAssetImportTask>();
+		Task->Filename = FileName;
+		Task->DestinationPath = Item.DestinationPath;
+		Task->DestinationName = Item.AssetName;
+		Task->bReplaceExisting = bReplaceExisting;
+		Task->bAutomated = true;
+		Task->bSave = false;
+		
+		Tasks.Add(Task);
+		TaskItemIndices.Add(Index);
+	}
+	
+	// One AssetTools call for the whole slice
+	if (Tasks.Num() > 0)
+	{
+		FAssetToolsModule& AssetToolsModule = FModuleManager::LoadModuleChecked<FAssetToolsModule>("AssetTools");
+		AssetToolsModule.Get().ImportAssetTasks(Tasks);
+	}
+	
+	for (int32 TaskIndex = 0; TaskIndex < Tasks.Num(); ++TaskIndex)
+	{
+		FAssetImportBatchItem& Item = Items[TaskItemIndices[TaskIndex]];
+		Item.ObjectPaths = Tasks[TaskIndex]->ImportedObjectPaths;
+		if (Item.ObjectPaths.Num() > 0)
+		{
+			Item.State = EAssetImportItemState::Imported;
+		}
+		else
+		{
+			Item.State = EAssetImportItemState::Failed;
+			Item.Error = FString::Printf(TEXT("Failed to import %s"), *Tasks[TaskIndex]->Filename);
+		}
+	}
+	
+	for (const TSharedPtr<const FStagedUpload>& Upload : FileBackedUploads)
+	{
+		FAssetUploadStaging::DeleteStagingFile(*Upload);
+		UploadStaging.Release(Upload->Id);
+	}
+#else
+	for (int32 Index = NextItemIndex; Index < SliceEnd; ++Index)
+	{
+		Items[Index].State = EAssetImportItemState::Failed;
+		Items[Index].Error = TEXT("Asset import requires an editor build");
+	}
+#endif
+
+	NextItemIndex = SliceEnd;
+	if (NextItemIndex >= Items.Num())
+	{
+		SavePackages();
+		bFinished = true;
+	}
+	return bFinished;
+}
+
+void FAssetImportBatch::Abort(const FString& Reason)
+{
+	for (int32 Index = NextItemIndex; Index < Items.Num(); ++Index)
+	{
+		Items[Index].State = EAssetImportItemState::Failed;
+		Items[Index].Error = Reason;
+	}
+	NextItemIndex = Items.Num();
+	
+	// Keep what was imported before the batch was cut short
+	SavePackages();
+	bFinished = true;
+}
+
+void FAssetImportBatch::SavePackages()
+{
+	bSaved = !bSave;
+	
+#if WITH_EDITOR
+	if (!bSave)
+	{
+		return;
+	}
+	
+	TArray<UPackage*> Packages;
+	for (const FAssetImportBatchItem& Item : Items)
+	{
+		for (const FString& ObjectPath : Item.ObjectPaths)
+		{
+			if (UObject* Asset = FSoftObjectPath(ObjectPath).ResolveObject())
+			{
+				Packages.AddUnique(Asset->GetOutermost());
+			}
+		}
+	}
+	
+	bSaved = Packages.Num() == 0 || UEditorLoadingAndSavingUtils::SavePackages(Packages, /* bOnlyDirty */ false);
+#endif
+}
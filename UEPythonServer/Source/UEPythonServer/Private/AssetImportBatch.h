@@ -0,0 +1,102 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/Guid.h"
+
+class FAssetUploadStaging;
+
+/** Progress of a single manifest item */
+enum class EAssetImportItemState : uint8
+{
+	Pending,
+	Imported,
+	Failed
+};
+
+/** Returns the lowercase name used for an item state in responses */
+const TCHAR* LexToString(EAssetImportItemState State);
+
+/** One file of an /import/batch manifest */
+struct FAssetImportBatchItem
+{
+	/** Id chosen by the client, the index in the manifest by default */
+	FString Id;
+	
+	/** File on the editor host to import, unless UploadId is set */
+	FString FileName;
+	
+	/** Upload staged through /upload?import=0 to import instead of a file */
+	FGuid UploadId;
+	
+	/** Content folder to import into */
+	FString DestinationPath;
+	
+	/** Name of the new asset, the file name without extension when empty */
+	FString AssetName;
+	
+	EAssetImportItemState State = EAssetImportItemState::Pending;
+	
+	/** Object paths of the imported assets */
+	TArray<FString> ObjectPaths;
+	
+	/** Why the item failed */
+	FString Error;
+};
+
+/**
+ * A manifest of asset imports run a slice at a time on the game thread.
+ * Every file item of a slice goes to AssetTools in one ImportAssetTasks call, and packages are not
+ * saved per asset. Instead every package the batch touched is saved once the last slice is done.
+ * Must only be used on the game thread.
+ */
+class FAssetImportBatch
+{
+public:
+	/**
+	 * @param InItems The manifest
+	 * @param bInReplaceExisting Whether existing assets are replaced
+	 * @param bInSave Whether the imported packages are saved once every item has been imported
+	 * @param InSliceSize Items imported per dispatcher job, so progress can be polled between slices
+	 */
+	FAssetImportBatch(TArray<FAssetImportBatchItem> InItems, bool bInReplaceExisting, bool bInSave, int32 InSliceSize);
+	
+	const FGuid& GetId() const { return Id; }
+	const TArray<FAssetImportBatchItem>& GetItems() const { return Items; }
+	
+	/** Items that have been imported or have failed */
+	int32 GetNumCompleted() const { return NextItemIndex; }
+	
+	/** Whether every item has been processed and the packages saved */
+	bool IsFinished() const { return bFinished; }
+	
+	/** Whether the final save ran and succeeded, or no save was requested */
+	bool HasSaved() const { return bSaved; }
+	
+	/**
+	 * Imports the next slice of items. Once the last slice is done, the touched packages are saved.
+	 * @param UploadStaging Staging area holding the uploads referenced by the manifest
+	 * @return True when the batch is finished
+	 */
+	bool ImportNextSlice(FAssetUploadStaging& UploadStaging);
+	
+	/** Fails every item not yet imported and finishes the batch, used when the batch cannot be continued */
+	void Abort(const FString& Reason);
+	
+private:
+	/** Saves every package the batch imported into, in one call */
+	void SavePackages();
+	
+	FGuid Id;
+	TArray<FAssetImportBatchItem> Items;
+	bool bReplaceExisting;
+	bool bSave;
+	int32 SliceSize;
+	
+	/** First item of the next slice */
+	int32 NextItemIndex = 0;
+	
+	bool bFinished = false;
+	bool bSaved = false;
+};
@@ -0,0 +1,276 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "AssetUploadStaging.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/FileManager.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/Paths.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+
+#if WITH_EDITOR
+#include "AssetToolsModule.h"
+#include "AssetImportTask.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Factories/TextureFactory.h"
+#include "Factories/SoundFactory.h"
+#include "FileHelpers.h"
+#include "Misc/FeedbackContext.h"
+#include "UObject/Package.h"
+#endif
+
+namespace AssetUploadStaging
+{
+#if WITH_EDITOR
+	/** Gets the factory that can create an asset of this format straight from a buffer, or null if the format needs a file */
+	static UClass* GetInMemoryFactoryClass(const FString& Extension)
+	{
+		static const TCHAR* TextureExtensions[] = { TEXT("png"), TEXT("jpg"), TEXT("jpeg"), TEXT("bmp"), TEXT("tga"), TEXT("exr"), TEXT("hdr"), TEXT("dds") };
+		for (const TCHAR* TextureExtension : TextureExtensions)
+		{
+			if (Extension == TextureExtension)
+			{
+				return UTextureFactory::StaticClass();
+			}
+		}
+		
+		if (Extension == TEXT("wav"))
+		{
+			return USoundFactory::StaticClass();
+		}
+		return nullptr;
+	}
+	
+	/** Creates the asset with the factory's FactoryCreateBinary, reading the upload in place */
+	static bool ImportFromMemory(UClass* FactoryClass, const FStagedUpload& Upload, const FStagedUploadImportOptions& Options, const FString& AssetName, const FString& Extension, TArray<FString>& OutObjectPaths, FString& OutError)
+	{
+		const FString PackageName = Options.DestinationPath / AssetName;
+		FText Reason;
+		if (!FPackageName::IsValidLongPackageName(PackageName, false, &Reason))
+		{
+			OutError = Reason.ToString();
+			return false;
+		}
+		
+		if (!Options.bReplaceExisting && FPackageName::DoesPackageExist(PackageName))
+		{
+			OutError = FString::Printf(TEXT("Asset %s already exists"), *PackageName);
+			return false;
+		}
+		
+		UFactory* Factory = NewObject<UFactory>(GetTransientPackage(), FactoryClass);
+		Factory->AddToRoot();
+		
+		UPackage* Package = CreatePackage(*PackageName);
+		Package->FullyLoad();
+		
+		const uint8* Buffer = Upload.Data.GetData();
+		UObject* Asset = Factory->FactoryCreateBinary(
+			Factory->ResolveSupportedClass(),
+			Package,
+			FName(*AssetName),
+			RF_Public | RF_Standalone | RF_Transactional,
+			nullptr,
+			*Extension,
+			Buffer,
+			Buffer + Upload.Data.Num(),
+			GWarn);
+		
+		Factory->RemoveFromRoot();
+		
+		if (Asset == nullptr)
+		{
+			OutError = FString::Printf(TEXT("Failed to create an asset from %s"), *Upload.FileName);
+			return false;
+		}
+		
+		FAssetRegistryModule::AssetCreated(Asset);
+		Asset->PostEditChange();
+		Package->MarkPackageDirty();
+		
+		if (Options.bSave)
+		{
+			UEditorLoadingAndSavingUtils::SavePackages({ Package }, /* bOnlyDirty */ false);
+		}
+		
+		OutObjectPaths.Add(Asset->GetPathName());
+		return true;
+	}
+	
+	/** Imports through AssetImportTask from a temporary file, for formats whose importer only reads files (FBX, OBJ, glTF) */
+	static bool ImportFromStagingFile(const FStagedUpload& Upload, const FStagedUploadImportOptions& Options, const FString& AssetName, TArray<FString>& OutObjectPaths, FString& OutError)
+	{
+		const FString StagingFile = FAssetUploadStaging::WriteStagingFile(Upload);
+		if (StagingFile.IsEmpty())
+		{
+			OutError = FString::Printf(TEXT("Failed to write the staging file of %s"), *Upload.FileName);
+			return false;
+		}
+		
+		UAssetImportTask* Task = NewObject<UAssetImportTask>();
+		Task->Filename = StagingFile;
+		Task->DestinationPath = Options.DestinationPath;
+		Task->DestinationName = AssetName;
+		Task->bReplaceExisting = Options.bReplaceExisting;
+		Task->bAutomated = true;
+		Task->bSave = Options.bSave;
+		
+		FAssetToolsModule& AssetToolsModule = FModuleManager::LoadModuleChecked<FAssetToolsModule>("AssetTools");
+		AssetToolsModule.Get().ImportAssetTasks({ Task });
+		
+		FAssetUploadStaging::DeleteStagingFile(Upload);
+		
+		if (Task->ImportedObjectPaths.Num() == 0)
+		{
+			OutError = FString::Printf(TEXT("Failed to import %s"), *Upload.FileName);
+			return false;
+		}
+		
+		OutObjectPaths.Append(Task->ImportedObjectPaths);
+		return true;
+	}
+#endif
+
+	/** Folder holding the temporary import file of an upload */
+	static FString GetStagingDir(const FStagedUpload& Upload)
+	{
+		// Local to the editor host, never a network share
+		return FPaths::ProjectIntermediateDir() / TEXT("PythonServerUploads") / Upload.Id.ToString();
+	}
+}
+
+FAssetUploadStaging::FAssetUploadStaging(int64 InMaxStagedBytes, double InMaxIdleSeconds)
+	: MaxStagedBytes(InMaxStagedBytes)
+	, MaxIdleSeconds(InMaxIdleSeconds)
+{
+}
+
+bool FAssetUploadStaging::IsValidFileName(const FString& FileName)
+{
+	if (FileName.IsEmpty() || FileName.Len() > 255 || FPaths::GetExtension(FileName).IsEmpty())
+	{
+		return false;
+	}
+	
+	// The name ends up in a staging path, so it must not be able to leave the staging folder
+	return !FileName.Contains(TEXT("/")) && !FileName.Contains(TEXT("\\")) && !FileName.Contains(TEXT("..")) && !FileName.Contains(TEXT(":"));
+}
+
+TSharedPtr<const FStagedUpload> FAssetUploadStaging::Stage(const FString& FileName, TArrayView<const uint8> Data)
+{
+	FScopeLock Lock(&Mutex);
+	
+	RemoveExpired();
+	
+	if (NumStagedBytes + Data.Num() > MaxStagedBytes)
+	{
+		return nullptr;
+	}
+	
+	TSharedPtr<FStagedUpload> Upload = MakeShared<FStagedUpload>();
+	Upload->Id = FGuid::NewGuid();
+	Upload->FileName = FileName;
+	Upload->Data.Append(Data.GetData(), Data.Num());
+	Upload->StageTime = FPlatformTime::Seconds();
+	
+	NumStagedBytes += Upload->Data.Num();
+	Uploads.Add(Upload->Id, Upload);
+	return Upload;
+}
+
+TSharedPtr<const FStagedUpload> FAssetUploadStaging::Find(const FGuid& Id) const
+{
+	FScopeLock Lock(&Mutex);
+	return Uploads.FindRef(Id);
+}
+
+void FAssetUploadStaging::Release(const FGuid& Id)
+{
+	FScopeLock Lock(&Mutex);
+	
+	TSharedPtr<FStagedUpload> Upload;
+	if (Uploads.RemoveAndCopyValue(Id, Upload))
+	{
+		NumStagedBytes -= Upload->Data.Num();
+	}
+}
+
+FAssetUploadStagingStats FAssetUploadStaging::GetStats() const
+{
+	FScopeLock Lock(&Mutex);
+	
+	FAssetUploadStagingStats Stats;
+	Stats.NumUploads = Uploads.Num();
+	Stats.NumBytes = NumStagedBytes;
+	Stats.MaxBytes = MaxStagedBytes;
+	return Stats;
+}
+
+void FAssetUploadStaging::Empty()
+{
+	FScopeLock Lock(&Mutex);
+	Uploads.Reset();
+	NumStagedBytes = 0;
+}
+
+void FAssetUploadStaging::RemoveExpired()
+{
+	const double ExpireTime = FPlatformTime::Seconds() - MaxIdleSeconds;
+	for (auto It = Uploads.CreateIterator(); It; ++It)
+	{
+		if (It->Value->StageTime < ExpireTime)
+		{
+			NumStagedBytes -= It->Value->Data.Num();
+			It.RemoveCurrent();
+		}
+	}
+}
+
+bool FAssetUploadStaging::Import(const FStagedUpload& Upload, const FStagedUploadImportOptions& Options, TArray<FString>& OutObjectPaths, bool& bOutFromMemory, FString& OutError)
+{
+	check(IsInGameThread());
+	
+	bOutFromMemory = false;
+	
+#if WITH_EDITOR
+	const FString AssetName = Options.AssetName.IsEmpty() ? FPaths::GetBaseFilename(Upload.FileName) : Options.AssetName;
+	const FString Extension = FPaths::GetExtension(Upload.FileName).ToLower();
+	
+	// Importers prompt for overwrites and options unless the import is unattended
+	TGuardValue<bool> UnattendedScriptGuard(GIsRunningUnattendedScript, true);
+	
+	if (UClass* FactoryClass = AssetUploadStaging::GetInMemoryFactoryClass(Extension))
+	{
+		bOutFromMemory = true;
+		return AssetUploadStaging::ImportFromMemory(FactoryClass, Upload, Options, AssetName, Extension, OutObjectPaths, OutError);
+	}
+	return AssetUploadStaging::ImportFromStagingFile(Upload, Options, AssetName, OutObjectPaths, OutError);
+#else
+	OutError = TEXT("Asset import requires an editor build");
+	return false;
+#endif
+}
+
+bool FAssetUploadStaging::CanImportFromMemory(const FString& FileName)
+{
+#if WITH_EDITOR
+	return AssetUploadStaging::GetInMemoryFactoryClass(FPaths::GetExtension(FileName).ToLower()) != nullptr;
+#else
+	return false;
+#endif
+}
+
+FString FAssetUploadStaging::WriteStagingFile(const FStagedUpload& Upload)
+{
+	const FString StagingFile = FPaths::ConvertRelativePathToFull(AssetUploadStaging::GetStagingDir(Upload) / Upload.FileName);
+	if (!FFileHelper::SaveArrayToFile(Upload.Data, *StagingFile))
+	{
+		return FString();
+	}
+	return StagingFile;
+}
+
+void FAssetUploadStaging::DeleteStagingFile(const FStagedUpload& Upload)
+{
+	IFileManager::Get().DeleteDirectory(*AssetUploadStaging::GetStagingDir(Upload), /* RequireExists */ false, /* Tree */ true);
+}
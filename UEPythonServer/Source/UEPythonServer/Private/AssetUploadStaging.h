@@ -0,0 +1,129 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/Guid.h"
+#include "HAL/CriticalSection.h"
+
+/** Asset bytes uploaded through /upload, held in memory until imported */
+struct FStagedUpload
+{
+	/** Id returned to the client, used to import the upload later */
+	FGuid Id;
+	
+	/** Original file name, its extension selects the importer */
+	FString FileName;
+	
+	/** The uploaded file */
+	TArray<uint8> Data;
+	
+	/** Time in FPlatformTime::Seconds() the upload was staged */
+	double StageTime = 0.0;
+};
+
+/** Snapshot of the staging area */
+struct FAssetUploadStagingStats
+{
+	int32 NumUploads = 0;
+	int64 NumBytes = 0;
+	int64 MaxBytes = 0;
+};
+
+/** Where an import of a staged upload should go */
+struct FStagedUploadImportOptions
+{
+	/** Content folder to import into, such as /Game/Uploads */
+	FString DestinationPath = TEXT("/Game/Uploads");
+	
+	/** Name of the new asset, the file name without extension when empty */
+	FString AssetName;
+	
+	/** Whether an existing asset with the same name is replaced */
+	bool bReplaceExisting = true;
+	
+	/** Whether the imported packages are saved right away */
+	bool bSave = false;
+};
+
+/**
+ * Memory-backed staging area for uploaded asset files.
+ * Uploads are staged by the HTTP handler and imported on the game thread. Formats whose factory
+ * can create assets straight from a buffer (textures, sounds) never touch the disk, other formats
+ * are written to the project's Intermediate folder for the duration of the import.
+ */
+class FAssetUploadStaging
+{
+public:
+	/**
+	 * @param InMaxStagedBytes Total size of the uploads that can be staged at once
+	 * @param InMaxIdleSeconds Time after which an upload that was never imported is dropped
+	 */
+	explicit FAssetUploadStaging(int64 InMaxStagedBytes = 1024ll * 1024 * 1024, double InMaxIdleSeconds = 600.0);
+	
+	/** Whether the name can be used for an upload (no path separators, has an extension) */
+	static bool IsValidFileName(const FString& FileName);
+	
+	/**
+	 * Copies uploaded bytes into the staging area
+	 * @param FileName Original file name of the upload
+	 * @param Data The file bytes
+	 * @return The staged upload, or nullptr if the staging area is full
+	 */
+	TSharedPtr<const FStagedUpload> Stage(const FString& FileName, TArrayView<const uint8> Data);
+	
+	/**
+	 * Gets a staged upload
+	 * @return The upload, or nullptr if it is unknown, already imported or expired
+	 */
+	TSharedPtr<const FStagedUpload> Find(const FGuid& Id) const;
+	
+	/** Drops a staged upload, usually once it has been imported */
+	void Release(const FGuid& Id);
+	
+	/** Gets a snapshot of the staging area */
+	FAssetUploadStagingStats GetStats() const;
+	
+	/** Drops every staged upload */
+	void Empty();
+	
+	/**
+	 * Imports a staged upload as one or more assets. Must be called on the game thread, and only
+	 * succeeds in editor builds.
+	 * @param Upload The staged upload
+	 * @param Options Where the import should go
+	 * @param OutObjectPaths The object paths of the imported assets
+	 * @param bOutFromMemory Set to whether the asset was created straight from memory
+	 * @param OutError Set to the reason the import failed
+	 * @return True if at least one asset was imported
+	 */
+	static bool Import(const FStagedUpload& Upload, const FStagedUploadImportOptions& Options, TArray<FString>& OutObjectPaths, bool& bOutFromMemory, FString& OutError);
+	
+	/** Whether uploads with this file name are imported straight from memory */
+	static bool CanImportFromMemory(const FString& FileName);
+	
+	/**
+	 * Writes a staged upload to its temporary import file, for importers that only read files
+	 * @return The full path of the file, or an empty string if it could not be written
+	 */
+	static FString WriteStagingFile(const FStagedUpload& Upload);
+	
+	/** Deletes the temporary import file of a staged upload */
+	static void DeleteStagingFile(const FStagedUpload& Upload);
+	
+private:
+	/** Drops uploads that were never imported, the mutex must be held */
+	void RemoveExpired();
+	
+	int64 MaxStagedBytes;
+	double MaxIdleSeconds;
+	
+	/** Guards the members below */
+	mutable FCriticalSection Mutex;
+	
+	/** Staged uploads by id */
+	TMap<FGuid, TSharedPtr<FStagedUpload>> Uploads;
+	
+	/** Total size of the staged uploads */
+	int64 NumStagedBytes = 0;
+};
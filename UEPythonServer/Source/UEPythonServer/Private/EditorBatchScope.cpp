@@ -0,0 +1,87 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "EditorBatchScope.h"
+#include "PythonServerTrace.h"
+#include "AI/NavigationSystemBase.h"
+
+#if WITH_EDITOR
+#include "Editor.h"
+#include "ScopedTransaction.h"
+#include "Selection.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#endif
+
+FEditorBatchScope::FEditorBatchScope(const FText& Description)
+{
+#if WITH_EDITOR
+	if (!GIsEditor || GEditor == nullptr)
+	{
+		return;
+	}
+	
+	// Transactions opened by the scripts, such as unreal.ScopedEditorTransaction, nest in this one
+	Transaction = MakeUnique<FScopedTransaction>(TEXT("PythonServer"), Description, nullptr);
+	
+	// Every spawned or moved actor would otherwise queue its own navigation octree and navmesh update
+	if (UWorld* World = GEditor->GetEditorWorldContext().World())
+	{
+		NavigationLock = MakeUnique<FNavigationLockContext>(World, ENavigationLockReason::Unknown);
+	}
+	
+	// Each selection change refreshes the details panel, so they are notified once at the end
+	if (USelection* SelectedActors = GEditor->GetSelectedActors())
+	{
+		SelectedActors->BeginBatchSelectOperation();
+		bBatchingSelection = true;
+	}
+	
+	// Scripts tend to query the registry once per asset they touch
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	bWasCachingAssetRegistry = AssetRegistry.GetTemporaryCachingMode();
+	AssetRegistry.SetTemporaryCachingMode(true);
+#endif
+}
+
+FEditorBatchScope::~FEditorBatchScope()
+{
+#if WITH_EDITOR
+	if (!Transaction.IsValid())
+	{
+		return;
+	}
+	
+	PYTHONSERVER_TRACE_SCOPE("PythonServer.BatchFlush");
+	
+	if (FAssetRegistryModule* AssetRegistryModule = FModuleManager::GetModulePtr<FAssetRegistryModule>(TEXT("AssetRegistry")))
+	{
+		AssetRegistryModule->Get().SetTemporaryCachingMode(bWasCachingAssetRegistry);
+	}
+	
+	if (bBatchingSelection && GEditor != nullptr)
+	{
+		if (USelection* SelectedActors = GEditor->GetSelectedActors())
+		{
+			SelectedActors->EndBatchSelectOperation(/* bNotify */ true);
+		}
+	}
+	
+	// Releasing the lock applies the navigation updates held back during the batch
+	NavigationLock.Reset();
+	Transaction.Reset();
+	
+	if (GEditor != nullptr)
+	{
+		GEditor->RedrawLevelEditingViewports(/* bInvalidateHitProxies */ true);
+	}
+#endif
+}
+
+bool FEditorBatchScope::IsTransacting() const
+{
+#if WITH_EDITOR
+	return Transaction.IsValid() && Transaction->IsOutstanding();
+#else
+	return false;
+#endif
+}
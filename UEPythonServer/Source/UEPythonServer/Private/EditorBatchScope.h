@@ -0,0 +1,43 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FScopedTransaction;
+class FNavigationLockContext;
+
+/**
+ * Groups the edits of an /execute_batch into one editor transaction, so they are undone with a
+ * single Ctrl+Z, and holds back the editor's per-edit bookkeeping until the batch is done.
+ * While it is alive, navigation updates are locked, selection changes are batched and the asset
+ * registry caches its queries. Its destruction flushes them once, then redraws the level viewports.
+ * Does nothing outside the editor. Must be created and destroyed on the game thread, within one job.
+ */
+class FEditorBatchScope
+{
+public:
+	/**
+	 * @param Description Name of the transaction in the undo history
+	 */
+	explicit FEditorBatchScope(const FText& Description);
+	~FEditorBatchScope();
+	
+	FEditorBatchScope(const FEditorBatchScope&) = delete;
+	FEditorBatchScope& operator=(const FEditorBatchScope&) = delete;
+	
+	/** Whether a transaction was opened, false outside the editor or while the editor is undoing */
+	bool IsTransacting() const;
+	
+private:
+#if WITH_EDITOR
+	TUniquePtr<FScopedTransaction> Transaction;
+#endif
+	TUniquePtr<FNavigationLockContext> NavigationLock;
+	
+	/** The selection batch to end, when one was begun */
+	bool bBatchingSelection = false;
+	
+	/** Caching mode of the asset registry before the batch, restored after it */
+	bool bWasCachingAssetRegistry = false;
+};
@@ -0,0 +1,434 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "MeshStreamRegistry.h"
+#include "SceneFastPath.h"
+#include "PythonServerTrace.h"
+#include "ProceduralMeshComponent.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/Actor.h"
+#include "Materials/MaterialInterface.h"
+
+#if WITH_EDITOR
+#include "Editor.h"
+#endif
+
+namespace UEPythonServer
+{
+	/** Size of the layout header, and of the header of each buffer */
+	static constexpr int32 MeshStreamHeaderBytes = 16;
+	static constexpr int32 MeshBufferHeaderBytes = 8;
+	
+	/** Blender works in meters, Unreal in centimeters */
+	static constexpr float BlenderUnitScale = 100.0f;
+	
+	/** Reads a little-endian integer, every platform the plugin runs on is little-endian */
+	template <typename T>
+	static T ReadLittleEndian(const uint8* Data)
+	{
+		T Value;
+		FMemory::Memcpy(&Value, Data, sizeof(T));
+		return Value;
+	}
+	
+	/** Decodes float32 triples, mirroring Y for Blender's right-handed space */
+	static void ReadVectors(const uint8* Data, int32 Num, float Scale, bool bBlenderSpace, TArray<FVector>& OutVectors)
+	{
+		const float* Floats = reinterpret_cast<const float*>(Data);
+		const float ScaleY = bBlenderSpace ? -Scale : Scale;
+		OutVectors.SetNumUninitialized(Num);
+		for (int32 Index = 0; Index < Num; ++Index)
+		{
+			OutVectors[Index] = FVector(Floats[Index * 3] * Scale, Floats[Index * 3 + 1] * ScaleY, Floats[Index * 3 + 2] * Scale);
+		}
+	}
+	
+	/** Name of the tag that finds the actor of a streamed mesh */
+	static FName GetMeshStreamTag(const FString& Name)
+	{
+		return FName(*FString::Printf(TEXT("PythonServerMesh.%s"), *Name));
+	}
+}
+
+const TCHAR* LexToString(EMeshStreamBuffer Buffer)
+{
+	switch (Buffer)
+	{
+	case EMeshStreamBuffer::Positions:
+		return TEXT("positions");
+	case EMeshStreamBuffer::Indices:
+		return TEXT("indices");
+	case EMeshStreamBuffer::Normals:
+		return TEXT("normals");
+	case EMeshStreamBuffer::UV0:
+		return TEXT("uv0");
+	case EMeshStreamBuffer::Colors:
+		return TEXT("colors");
+	case EMeshStreamBuffer::Tangents:
+		return TEXT("tangents");
+	default:
+		return TEXT("unknown");
+	}
+}
+
+bool FMeshStreamRegistry::ParseUpdate(const TArray<uint8>& Body, bool bBlenderSpace, FMeshStreamUpdate& OutUpdate, FString& OutError)
+{
+	PYTHONSERVER_TRACE_SCOPE("PythonServer.MeshParse");
+	
+	const uint8* Data = Body.GetData();
+	if (Body.Num() < UEPythonServer::MeshStreamHeaderBytes || FMemory::Memcmp(Data, "UEMS", 4) != 0)
+	{
+		OutError = TEXT("Invalid mesh stream, expected the UEMS header");
+		return false;
+	}
+	
+	const uint16 LayoutVersion = UEPythonServer::ReadLittleEndian<uint16>(Data + 4);
+	if (LayoutVersion != Version)
+	{
+		OutError = FString::Printf(TEXT("Unsupported mesh stream version %u, expected %u"), LayoutVersion, Version);
+		return false;
+	}
+	
+	OutUpdate.Section = UEPythonServer::ReadLittleEndian<uint16>(Data + 6);
+	const uint32 NumVertices = UEPythonServer::ReadLittleEndian<uint32>(Data + 8);
+	const uint32 NumBuffers = UEPythonServer::ReadLittleEndian<uint32>(Data + 12);
+	if (NumVertices == 0 || NumVertices > MaxVertices)
+	{
+		OutError = FString::Printf(TEXT("Vertex count must be between 1 and %u"), MaxVertices);
+		return false;
+	}
+	OutUpdate.NumVertices = static_cast<int32>(NumVertices);
+	
+	int64 Offset = UEPythonServer::MeshStreamHeaderBytes;
+	for (uint32 BufferIndex = 0; BufferIndex < NumBuffers; ++BufferIndex)
+	{
+		if (Offset + UEPythonServer::MeshBufferHeaderBytes > Body.Num())
+		{
+			OutError = TEXT("Truncated mesh stream, a buffer header is missing");
+			return false;
+		}
+		
+		const uint32 Type = UEPythonServer::ReadLittleEndian<uint32>(Data + Offset);
+		const uint32 NumBytes = UEPythonServer::ReadLittleEndian<uint32>(Data + Offset + 4);
+		Offset += UEPythonServer::MeshBufferHeaderBytes;
+		if (Offset + NumBytes > Body.Num())
+		{
+			OutError = FString::Printf(TEXT("Truncated mesh stream, buffer %u is cut short"), BufferIndex);
+			return false;
+		}
+		
+		const EMeshStreamBuffer Buffer = static_cast<EMeshStreamBuffer>(Type);
+		const uint8* BufferData = Data + Offset;
+		
+		// Vertex attributes must cover every vertex, indices whole triangles
+		int64 ExpectedBytes = 0;
+		switch (Buffer)
+		{
+		case EMeshStreamBuffer::Positions:
+		case EMeshStreamBuffer::Normals:
+		case EMeshStreamBuffer::Tangents:
+			ExpectedBytes = int64(NumVertices) * 3 * sizeof(float);
+			break;
+		case EMeshStreamBuffer::UV0:
+			ExpectedBytes = int64(NumVertices) * 2 * sizeof(float);
+			break;
+		case EMeshStreamBuffer::Colors:
+			ExpectedBytes = int64(NumVertices) * 4;
+			break;
+		case EMeshStreamBuffer::Indices:
+			if (NumBytes == 0 || NumBytes % (3 * sizeof(uint32)) != 0)
+			{
+				OutError = FString::Printf(TEXT("Mesh buffer 'indices' has %u bytes, which is not a whole number of triangles"), NumBytes);
+				return false;
+			}
+			ExpectedBytes = NumBytes;
+			break;
+		default:
+			OutError = FString::Printf(TEXT("Unknown mesh buffer type %u"), Type);
+			return false;
+		}
+		if (NumBytes != ExpectedBytes)
+		{
+			OutError = FString::Printf(TEXT("Mesh buffer '%s' has %u bytes, which does not match %u vertices"), LexToString(Buffer), NumBytes, NumVertices);
+			return false;
+		}
+		
+		switch (Buffer)
+		{
+		case EMeshStreamBuffer::Positions:
+			UEPythonServer::ReadVectors(BufferData, NumVertices, bBlenderSpace ? UEPythonServer::BlenderUnitScale : 1.0f, bBlenderSpace, OutUpdate.Positions);
+			break;
+		case EMeshStreamBuffer::Normals:
+			UEPythonServer::ReadVectors(BufferData, NumVertices, 1.0f, bBlenderSpace, OutUpdate.Normals);
+			break;
+		case EMeshStreamBuffer::Tangents:
+			UEPythonServer::ReadVectors(BufferData, NumVertices, 1.0f, bBlenderSpace, OutUpdate.Tangents);
+			break;
+		case EMeshStreamBuffer::UV0:
+		{
+			// Blender's V axis points up, Unreal's down
+			const float* Floats = reinterpret_cast<const float*>(BufferData);
+			OutUpdate.UV0.SetNumUninitialized(NumVertices);
+			for (uint32 Index = 0; Index < NumVertices; ++Index)
+			{
+				OutUpdate.UV0[Index] = FVector2D(Floats[Index * 2], bBlenderSpace ? 1.0f - Floats[Index * 2 + 1] : Floats[Index * 2 + 1]);
+			}
+			break;
+		}
+		case EMeshStreamBuffer::Colors:
+		{
+			OutUpdate.Colors.SetNumUninitialized(NumVertices);
+			for (uint32 Index = 0; Index < NumVertices; ++Index)
+			{
+				const uint8* Color = BufferData + Index * 4;
+				OutUpdate.Colors[Index] = FColor(Color[0], Color[1], Color[2], Color[3]);
+			}
+			break;
+		}
+		case EMeshStreamBuffer::Indices:
+		{
+			const int32 NumIndices = NumBytes / sizeof(uint32);
+			const uint32* Indices = reinterpret_cast<const uint32*>(BufferData);
+			OutUpdate.Indices.SetNumUninitialized(NumIndices);
+			for (int32 Index = 0; Index < NumIndices; ++Index)
+			{
+				if (Indices[Index] >= NumVertices)
+				{
+					OutError = FString::Printf(TEXT("Mesh index %u is out of range of %u vertices"), Indices[Index], NumVertices);
+					return false;
+				}
+				OutUpdate.Indices[Index] = static_cast<int32>(Indices[Index]);
+			}
+			
+			// Mirroring Y flips the handedness, so the winding is reversed to keep faces pointing out
+			if (bBlenderSpace)
+			{
+				for (int32 Index = 0; Index < NumIndices; Index += 3)
+				{
+					Swap(OutUpdate.Indices[Index + 1], OutUpdate.Indices[Index + 2]);
+				}
+			}
+			break;
+		}
+		default:
+			break;
+		}
+		
+		OutUpdate.BufferMask |= 1u << Type;
+		Offset += Align(NumBytes, 4);
+	}
+	return true;
+}
+
+UProceduralMeshComponent* FMeshStreamRegistry::FindComponent(const FString& Name)
+{
+	if (const TWeakObjectPtr<UProceduralMeshComponent>* Component = Meshes.Find(Name))
+	{
+		if (Component->IsValid())
+		{
+			return Component->Get();
+		}
+		Meshes.Remove(Name);
+	}
+	
+	UWorld* World = SceneFastPath::GetWorld();
+	if (World == nullptr)
+	{
+		return nullptr;
+	}
+	
+	const FName Tag = UEPythonServer::GetMeshStreamTag(Name);
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		if (It->ActorHasTag(Tag))
+		{
+			if (UProceduralMeshComponent* Component = It->FindComponentByClass<UProceduralMeshComponent>())
+			{
+				Meshes.Add(Name, Component);
+				return Component;
+			}
+		}
+	}
+	return nullptr;
+}
+
+bool FMeshStreamRegistry::Apply(const FString& Name, const FMeshStreamUpdate& Update, const FMeshStreamOptions& Options, FJsonObject& OutResponse, FString& OutError)
+{
+	PYTHONSERVER_TRACE_SCOPE("PythonServer.MeshStream");
+	
+	UMaterialInterface* Material = nullptr;
+	if (!Options.Material.IsEmpty())
+	{
+		Material = LoadObject<UMaterialInterface>(nullptr, *Options.Material);
+		if (Material == nullptr)
+		{
+			OutError = FString::Printf(TEXT("Unknown material '%s'"), *Options.Material);
+			return false;
+		}
+	}
+	
+	UProceduralMeshComponent* Component = FindComponent(Name);
+	if (Component == nullptr)
+	{
+		if (!Update.Has(EMeshStreamBuffer::Positions) || !Update.Has(EMeshStreamBuffer::Indices))
+		{
+			OutError = FString::Printf(TEXT("Unknown mesh '%s', send its positions and indices first"), *Name);
+			return false;
+		}
+		
+		UWorld* World = SceneFastPath::GetWorld();
+		if (World == nullptr)
+		{
+			OutError = TEXT("No world to spawn into");
+			return false;
+		}
+		
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		SpawnParams.ObjectFlags |= RF_Transactional;
+		AActor* Actor = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams);
+		if (Actor == nullptr)
+		{
+			OutError = FString::Printf(TEXT("Failed to spawn the actor of mesh '%s'"), *Name);
+			return false;
+		}
+		
+		// Cooking the collision on a worker keeps positions updates from hitching the editor
+		Component = NewObject<UProceduralMeshComponent>(Actor, TEXT("StreamedMesh"), RF_Transactional);
+		Component->bUseAsyncCooking = true;
+		Component->SetMobility(EComponentMobility::Movable);
+		Actor->SetRootComponent(Component);
+		Actor->AddInstanceComponent(Component);
+		Component->RegisterComponent();
+		Actor->Tags.Add(UEPythonServer::GetMeshStreamTag(Name));
+#if WITH_EDITOR
+		Actor->SetActorLabel(Name);
+#endif
+		Meshes.Add(Name, Component);
+	}
+	
+	const FProcMeshSection* Existing = Component->GetProcMeshSection(Update.Section);
+	const bool bSameVertices = Existing != nullptr && Existing->ProcVertexBuffer.Num() == Update.NumVertices && Existing->ProcIndexBuffer.Num() > 0;
+	if (!bSameVertices && !(Update.Has(EMeshStreamBuffer::Positions) && Update.Has(EMeshStreamBuffer::Indices)))
+	{
+		OutError = FString::Printf(TEXT("Section %d of mesh '%s' is new or changed its vertex count, send its positions and indices"), Update.Section, *Name);
+		return false;
+	}
+	
+	TArray<FProcMeshTangent> Tangents;
+	Tangents.Reserve(Update.Tangents.Num());
+	for (const FVector& Tangent : Update.Tangents)
+	{
+		Tangents.Emplace(Tangent, /* bFlipTangentY */ false);
+	}
+	
+	// Without new topology, the vertices are rewritten in place and the buffers not sent are kept
+	const bool bRebuild = !bSameVertices || Update.Has(EMeshStreamBuffer::Indices);
+	if (!bRebuild)
+	{
+		Component->UpdateMeshSection(Update.Section, Update.Positions, Update.Normals, Update.UV0, Update.Colors, Tangents);
+	}
+	else
+	{
+		// The buffers not sent come from the section being replaced, when its vertices line up
+		TArray<FVector> Positions = Update.Positions;
+		TArray<FVector> Normals = Update.Normals;
+		TArray<FVector2D> UV0 = Update.UV0;
+		TArray<FColor> Colors = Update.Colors;
+		if (bSameVertices)
+		{
+			const TArray<FProcMeshVertex>& Vertices = Existing->ProcVertexBuffer;
+			const bool bKeepPositions = !Update.Has(EMeshStreamBuffer::Positions);
+			const bool bKeepNormals = !Update.Has(EMeshStreamBuffer::Normals);
+			const bool bKeepUV0 = !Update.Has(EMeshStreamBuffer::UV0);
+			const bool bKeepColors = !Update.Has(EMeshStreamBuffer::Colors);
+			const bool bKeepTangents = !Update.Has(EMeshStreamBuffer::Tangents);
+			for (const FProcMeshVertex& Vertex : Vertices)
+			{
+				if (bKeepPositions)
+				{
+					Positions.Add(Vertex.Position);
+				}
+				if (bKeepNormals)
+				{
+					Normals.Add(Vertex.Normal);
+				}
+				if (bKeepUV0)
+				{
+					UV0.Add(Vertex.UV0);
+				}
+				if (bKeepColors)
+				{
+					Colors.Add(Vertex.Color);
+				}
+				if (bKeepTangents)
+				{
+					Tangents.Add(Vertex.Tangent);
+				}
+			}
+		}
+		
+		const bool bCollision = Options.Collision.Get(Existing != nullptr && Existing->bEnableCollision);
+		Component->CreateMeshSection(Update.Section, Positions, Update.Indices, Normals, UV0, Colors, Tangents, bCollision);
+	}
+	
+	if (Material != nullptr)
+	{
+		Component->SetMaterial(Update.Section, Material);
+	}
+	
+#if WITH_EDITOR
+	// Viewports that are not realtime only redraw when told to
+	if (GIsEditor && GEditor)
+	{
+		GEditor->RedrawLevelEditingViewports(/* bInvalidateHitProxies */ false);
+	}
+#endif
+
+	TArray<TSharedPtr<FJsonValue>> UpdatedBuffers;
+	for (uint32 Type = static_cast<uint32>(EMeshStreamBuffer::Positions); Type <= static_cast<uint32>(EMeshStreamBuffer::Tangents); ++Type)
+	{
+		if (Update.Has(static_cast<EMeshStreamBuffer>(Type)))
+		{
+			UpdatedBuffers.Add(MakeShared<FJsonValueString>(LexToString(static_cast<EMeshStreamBuffer>(Type))));
+		}
+	}
+	
+	const FProcMeshSection* Section = Component->GetProcMeshSection(Update.Section);
+	OutResponse.SetStringField(TEXT("name"), Name);
+	OutResponse.SetStringField(TEXT("actor"), Component->GetOwner()->GetName());
+	OutResponse.SetNumberField(TEXT("section"), Update.Section);
+	OutResponse.SetNumberField(TEXT("vertices"), Section ? Section->ProcVertexBuffer.Num() : 0);
+	OutResponse.SetNumberField(TEXT("triangles"), Section ? Section->ProcIndexBuffer.Num() / 3 : 0);
+	OutResponse.SetBoolField(TEXT("rebuilt"), bRebuild);
+	OutResponse.SetArrayField(TEXT("updated"), UpdatedBuffers);
+	return true;
+}
+
+bool FMeshStreamRegistry::Remove(const FString& Name)
+{
+	UProceduralMeshComponent* Component = FindComponent(Name);
+	Meshes.Remove(Name);
+	if (Component == nullptr)
+	{
+		return false;
+	}
+	
+	Component->GetOwner()->Destroy();
+	return true;
+}
+
+void FMeshStreamRegistry::Reset()
+{
+	Meshes.Reset();
+}
+
+int32 FMeshStreamRegistry::GetNum() const
+{
+	int32 NumAlive = 0;
+	for (const TPair<FString, TWeakObjectPtr<UProceduralMeshComponent>>& Mesh : Meshes)
+	{
+		NumAlive += Mesh.Value.IsValid() ? 1 : 0;
+	}
+	return NumAlive;
+}
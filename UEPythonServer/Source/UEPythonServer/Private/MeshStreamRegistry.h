@@ -0,0 +1,118 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonObject.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+class UProceduralMeshComponent;
+
+/** Buffer types of the /meshes binary layout */
+enum class EMeshStreamBuffer : uint32
+{
+	/** float32 x, y, z per vertex */
+	Positions = 1,
+	
+	/** uint32 per corner, three per triangle */
+	Indices = 2,
+	
+	/** float32 x, y, z per vertex */
+	Normals = 3,
+	
+	/** float32 u, v per vertex */
+	UV0 = 4,
+	
+	/** uint8 r, g, b, a per vertex */
+	Colors = 5,
+	
+	/** float32 x, y, z per vertex */
+	Tangents = 6
+};
+
+/** Returns the lowercase name used for a buffer type in responses */
+const TCHAR* LexToString(EMeshStreamBuffer Buffer);
+
+/** Buffers of one mesh section decoded from a /meshes request, only the ones that were sent */
+struct FMeshStreamUpdate
+{
+	int32 Section = 0;
+	int32 NumVertices = 0;
+	
+	/** Bit (1 << type) of each buffer present */
+	uint32 BufferMask = 0;
+	
+	TArray<FVector> Positions;
+	TArray<int32> Indices;
+	TArray<FVector> Normals;
+	TArray<FVector2D> UV0;
+	TArray<FColor> Colors;
+	TArray<FVector> Tangents;
+	
+	bool Has(EMeshStreamBuffer Buffer) const { return (BufferMask & (1u << static_cast<uint32>(Buffer))) != 0; }
+};
+
+/** Settings of a /meshes request that are not buffers */
+struct FMeshStreamOptions
+{
+	/** Material of the section, kept as it is when empty */
+	FString Material;
+	
+	/** Whether the section gets complex collision, cooked again each time the positions change. Unset keeps the section's, off for a new one */
+	TOptional<bool> Collision;
+};
+
+/**
+ * Meshes streamed by clients such as Blender, each shown by a procedural mesh component on an actor
+ * labelled with its name, so edits show up without an FBX export and import.
+ * Requests carry a compact little-endian layout: a 16 byte header, "UEMS", uint16 version (1),
+ * uint16 section, uint32 vertex count and uint32 buffer count, then each buffer as uint32 type,
+ * uint32 byte length and its data, padded to 4 bytes.
+ * A section is created from its positions and indices. After that, a request may send only the
+ * buffers that changed: without indices and with the same vertex count, the vertex data is updated
+ * in place, without rebuilding the section.
+ * Must only be used on the game thread.
+ */
+class FMeshStreamRegistry
+{
+public:
+	/** Layout version this server reads */
+	static constexpr uint16 Version = 1;
+	
+	/** Largest vertex count of a section */
+	static constexpr uint32 MaxVertices = 16 * 1024 * 1024;
+	
+	/**
+	 * Decodes the body of a /meshes request
+	 * @param bBlenderSpace Whether the buffers are in Blender space, right-handed and in meters, and
+	 *                      must be converted to Unreal's left-handed centimeters
+	 * @return False with OutError set if the layout is invalid
+	 */
+	static bool ParseUpdate(const TArray<uint8>& Body, bool bBlenderSpace, FMeshStreamUpdate& OutUpdate, FString& OutError);
+	
+	/**
+	 * Creates or updates a section of a streamed mesh, spawning its actor in the editor world if needed
+	 * @param Name The mesh name, also the label of its actor
+	 * @return False with OutError set if the update does not fit the mesh, such as a partial update
+	 *         of a section that does not exist yet
+	 */
+	bool Apply(const FString& Name, const FMeshStreamUpdate& Update, const FMeshStreamOptions& Options, FJsonObject& OutResponse, FString& OutError);
+	
+	/**
+	 * Destroys the actor of a streamed mesh
+	 * @return False if there is no streamed mesh with this name
+	 */
+	bool Remove(const FString& Name);
+	
+	/** Forgets the streamed meshes, their actors stay in the level */
+	void Reset();
+	
+	/** Number of streamed meshes whose actor is alive */
+	int32 GetNum() const;
+	
+private:
+	/** Finds the component of a streamed mesh, also after a restart of the server from its actor's tag */
+	UProceduralMeshComponent* FindComponent(const FString& Name);
+	
+	TMap<FString, TWeakObjectPtr<UProceduralMeshComponent>> Meshes;
+};
@@ -0,0 +1,137 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PythonCodeCache.h"
+#include "Hash/CityHash.h"
+#include "IncludePython.h"
+
+namespace UEPythonServer
+{
+	static uint64 HashSource(const FString& Code, bool bEval)
+	{
+		return CityHash64WithSeed(reinterpret_cast<const char*>(*Code), Code.Len() * sizeof(TCHAR), bEval ? 1 : 0);
+	}
+	
+	/** Compiles the source in exec mode, or for evaluation with its final expression split off with the ast module */
+	static FPyObjectPtr CompileSource(const FString& Code, bool bEval, FPyObjectPtr& OutExpression)
+	{
+		OutExpression.Reset();
+		if (!bEval)
+		{
+			return FPyObjectPtr::StealReference(Py_CompileString(TCHAR_TO_UTF8(*Code), "<string>", Py_file_input));
+		}
+		
+		FPyObjectPtr AstModule = FPyObjectPtr::StealReference(PyImport_ImportModule("ast"));
+		FPyObjectPtr BuiltinsModule = FPyObjectPtr::StealReference(PyImport_ImportModule("builtins"));
+		if (!AstModule || !BuiltinsModule)
+		{
+			return FPyObjectPtr();
+		}
+		
+		FPyObjectPtr Tree = FPyObjectPtr::StealReference(PyObject_CallMethod(AstModule.Get(), "parse", "ss", TCHAR_TO_UTF8(*Code), "<string>"));
+		FPyObjectPtr Statements = Tree ? FPyObjectPtr::StealReference(PyObject_GetAttrString(Tree.Get(), "body")) : FPyObjectPtr();
+		FPyObjectPtr ExprType = FPyObjectPtr::StealReference(PyObject_GetAttrString(AstModule.Get(), "Expr"));
+		if (!Statements || !ExprType || !PyList_Check(Statements.Get()))
+		{
+			return FPyObjectPtr();
+		}
+		
+		const Py_ssize_t NumStatements = PyList_Size(Statements.Get());
+		PyObject* LastStatement = NumStatements > 0 ? PyList_GetItem(Statements.Get(), NumStatements - 1) : nullptr;
+		if (LastStatement != nullptr && PyObject_IsInstance(LastStatement, ExprType.Get()) == 1)
+		{
+			FPyObjectPtr Value = FPyObjectPtr::StealReference(PyObject_GetAttrString(LastStatement, "value"));
+			FPyObjectPtr Expression = Value ? FPyObjectPtr::StealReference(PyObject_CallMethod(AstModule.Get(), "Expression", "O", Value.Get())) : FPyObjectPtr();
+			if (!Expression)
+			{
+				return FPyObjectPtr();
+			}
+			
+			OutExpression = FPyObjectPtr::StealReference(PyObject_CallMethod(BuiltinsModule.Get(), "compile", "Oss", Expression.Get(), "<string>", "eval"));
+			if (!OutExpression || PyList_SetSlice(Statements.Get(), NumStatements - 1, NumStatements, nullptr) != 0)
+			{
+				OutExpression.Reset();
+				return FPyObjectPtr();
+			}
+		}
+		
+		FPyObjectPtr CodeObject = FPyObjectPtr::StealReference(PyObject_CallMethod(BuiltinsModule.Get(), "compile", "Oss", Tree.Get(), "<string>", "exec"));
+		if (!CodeObject)
+		{
+			OutExpression.Reset();
+		}
+		return CodeObject;
+	}
+}
+
+FPythonCodeCache::FPythonCodeCache(int32 InMaxEntries)
+	: Entries(InMaxEntries)
+{
+}
+
+FPythonCodeCache::~FPythonCodeCache()
+{
+	// Owners empty the cache with the GIL held, this only catches misuse
+	check(Entries.Num() == 0);
+}
+
+FPyObjectPtr FPythonCodeCache::FindOrCompile(const FString& Code)
+{
+	FPyObjectPtr Expression;
+	return FindOrCompile(Code, /* bEval */ false, Expression);
+}
+
+FPyObjectPtr FPythonCodeCache::FindOrCompileEval(const FString& Code, FPyObjectPtr& OutExpression)
+{
+	return FindOrCompile(Code, /* bEval */ true, OutExpression);
+}
+
+FPyObjectPtr FPythonCodeCache::FindOrCompile(const FString& Code, bool bEval, FPyObjectPtr& OutExpression)
+{
+	const uint64 Hash = UEPythonServer::HashSource(Code, bEval);
+	
+	if (const FEntry* Entry = Entries.FindAndTouch(Hash))
+	{
+		if (Entry->bEval == bEval && Entry->Source.Equals(Code, ESearchCase::CaseSensitive))
+		{
+			++NumHits;
+			OutExpression = Entry->ExpressionObject;
+			return Entry->CodeObject;
+		}
+		
+		// A hash collision, compile without caching so the resident entry stays valid
+		++NumMisses;
+		return UEPythonServer::CompileSource(Code, bEval, OutExpression);
+	}
+	
+	++NumMisses;
+	
+	FPyObjectPtr CodeObject = UEPythonServer::CompileSource(Code, bEval, OutExpression);
+	if (!CodeObject)
+	{
+		// Do not cache failures, the Python error is left set for the caller
+		return CodeObject;
+	}
+	
+	if (Entries.Num() == Entries.Max())
+	{
+		++NumEvictions;
+	}
+	Entries.Add(Hash, FEntry{ Code, CodeObject, OutExpression, bEval });
+	return CodeObject;
+}
+
+FPythonCodeCacheStats FPythonCodeCache::GetStats() const
+{
+	FPythonCodeCacheStats Stats;
+	Stats.NumEntries = Entries.Num();
+	Stats.MaxEntries = Entries.Max();
+	Stats.NumHits = NumHits;
+	Stats.NumMisses = NumMisses;
+	Stats.NumEvictions = NumEvictions;
+	return Stats;
+}
+
+void FPythonCodeCache::Empty()
+{
+	Entries.Empty(Entries.Max());
+}
@@ -0,0 +1,71 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/LruCache.h"
+#include "PyPtr.h"
+
+/** Hit/miss counters of the compiled-code cache */
+struct FPythonCodeCacheStats
+{
+	int32 NumEntries = 0;
+	int32 MaxEntries = 0;
+	uint64 NumHits = 0;
+	uint64 NumMisses = 0;
+	uint64 NumEvictions = 0;
+};
+
+/**
+ * LRU cache of compiled Python code objects, keyed by a hash of the source.
+ * Repeat scripts skip compilation entirely. The source is kept alongside the code object
+ * so that a hash collision can never run the wrong code.
+ * Every method must be called with the GIL held.
+ */
+class FPythonCodeCache
+{
+public:
+	explicit FPythonCodeCache(int32 InMaxEntries = 256);
+	~FPythonCodeCache();
+	
+	/**
+	 * Gets the compiled code object for the given source, compiling and caching it on a miss
+	 * @param Code The Python source, compiled in exec mode
+	 * @return The code object, or null with the Python error set if compilation failed
+	 */
+	FPyObjectPtr FindOrCompile(const FString& Code);
+	
+	/**
+	 * Gets the compiled code objects for evaluating the given source, cached apart from FindOrCompile's.
+	 * A final expression statement is split off and compiled on its own, so its value can be returned.
+	 * @param Code The Python source
+	 * @param OutExpression Set to the final expression compiled in eval mode, null if the source does not end with one
+	 * @return The code object of the other statements, or null with the Python error set if compilation failed
+	 */
+	FPyObjectPtr FindOrCompileEval(const FString& Code, FPyObjectPtr& OutExpression);
+	
+	/** Gets a snapshot of the cache counters */
+	FPythonCodeCacheStats GetStats() const;
+	
+	/** Drops every cached code object */
+	void Empty();
+	
+private:
+	struct FEntry
+	{
+		FString Source;
+		FPyObjectPtr CodeObject;
+		
+		/** Final expression of an entry compiled for evaluation */
+		FPyObjectPtr ExpressionObject;
+		bool bEval = false;
+	};
+	
+	FPyObjectPtr FindOrCompile(const FString& Code, bool bEval, FPyObjectPtr& OutExpression);
+	
+	TLruCache<uint64, FEntry> Entries;
+	
+	uint64 NumHits = 0;
+	uint64 NumMisses = 0;
+	uint64 NumEvictions = 0;
+};
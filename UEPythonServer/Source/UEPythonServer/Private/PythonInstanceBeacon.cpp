@@ -0,0 +1,49 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PythonInstanceBeacon.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+FPythonInstanceBeacon::FPythonInstanceBeacon(const FString& InDirectory, uint32 Port)
+{
+	FilePath = FPaths::Combine(InDirectory, FString::Printf(TEXT("instance-%u.json"), Port));
+	TempFilePath = FilePath + FString::Printf(TEXT(".%u.tmp"), FPlatformProcess::GetCurrentProcessId());
+	IFileManager::Get().MakeDirectory(*InDirectory, /* Tree */ true);
+}
+
+FPythonInstanceBeacon::~FPythonInstanceBeacon()
+{
+	Remove();
+}
+
+FString FPythonInstanceBeacon::GetDefaultDirectory()
+{
+	FString Directory;
+	if (FParse::Value(FCommandLine::Get(), TEXT("PythonServerDiscoveryDir="), Directory) && !Directory.IsEmpty())
+	{
+		return Directory;
+	}
+	return FPaths::Combine(FPlatformProcess::UserTempDir(), TEXT("UEPythonServer"), TEXT("instances"));
+}
+
+bool FPythonInstanceBeacon::Publish(const FString& Body)
+{
+	const bool bWritten = FFileHelper::SaveStringToFile(Body, *TempFilePath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM)
+		&& IFileManager::Get().Move(*FilePath, *TempFilePath, /* bReplace */ true, /* bEvenIfReadOnly */ true);
+	if (!bWritten && !bPublishFailed)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UEPythonServer could not write its discovery file %s"), *FilePath);
+	}
+	bPublishFailed = !bWritten;
+	return bWritten;
+}
+
+void FPythonInstanceBeacon::Remove()
+{
+	IFileManager::Get().Delete(*FilePath, /* bRequireExists */ false, /* bEvenReadOnly */ true, /* bQuiet */ true);
+	IFileManager::Get().Delete(*TempFilePath, /* bRequireExists */ false, /* bEvenReadOnly */ true, /* bQuiet */ true);
+}
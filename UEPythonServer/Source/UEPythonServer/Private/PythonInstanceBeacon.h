@@ -0,0 +1,51 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Advertises a running server in a discovery directory shared by every editor of the machine, so
+ * a router can find the instances and send work to the least loaded one.
+ * Each instance owns one JSON file named after its port, rewritten about once a second with its
+ * load. The file is replaced with a rename so readers never see it half written, and deleted when
+ * the server stops. An editor that crashed leaves its file behind, readers tell from its
+ * updated_at time and from the status port not answering.
+ */
+class FPythonInstanceBeacon
+{
+public:
+	/**
+	 * @param InDirectory The discovery directory
+	 * @param Port The HTTP port of the server, names the file
+	 */
+	FPythonInstanceBeacon(const FString& InDirectory, uint32 Port);
+	~FPythonInstanceBeacon();
+	
+	/**
+	 * Gets the discovery directory, -PythonServerDiscoveryDir= or else UEPythonServer/instances
+	 * in the user's temp directory
+	 */
+	static FString GetDefaultDirectory();
+	
+	/**
+	 * Replaces the instance file, on the game thread
+	 * @param Body The JSON describing the instance
+	 * @return False if the file could not be written
+	 */
+	bool Publish(const FString& Body);
+	
+	/** Deletes the instance file */
+	void Remove();
+	
+	const FString& GetFilePath() const { return FilePath; }
+	
+private:
+	FString FilePath;
+	
+	/** File written before being renamed over FilePath */
+	FString TempFilePath;
+	
+	/** Whether the last Publish failed, so a read-only directory is only reported once */
+	bool bPublishFailed = false;
+};
@@ -0,0 +1,53 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PythonInterrupt.h"
+#include "IncludePython.h"
+#include <atomic>
+
+namespace PythonInterrupt
+{
+	/** Serial of the job whose Python is running, 0 if none */
+	static std::atomic<uint64> RunningSerial(0);
+	
+	/** Python thread id of the thread running it */
+	static std::atomic<unsigned long> RunningThreadId(0);
+	
+	/** Runs in the interpreter with the GIL held, the job may have finished since the request */
+	static int RaiseInterrupt(void* Arg)
+	{
+		const uint64 Serial = static_cast<uint64>(reinterpret_cast<UPTRINT>(Arg));
+		if (Serial != 0 && RunningSerial.load() == Serial)
+		{
+			PyThreadState_SetAsyncExc(RunningThreadId.load(), PyExc_KeyboardInterrupt);
+		}
+		return 0;
+	}
+	
+	FScopedRun::FScopedRun(uint64 InSerial)
+		: Serial(InSerial)
+	{
+		RunningThreadId.store(PyThread_get_thread_ident());
+		RunningSerial.store(Serial);
+	}
+	
+	FScopedRun::~FScopedRun()
+	{
+		RunningSerial.store(0);
+		
+		// An interrupt raised as the script returned is still pending on the thread, and would
+		// otherwise hit the next Python to run on it
+		if (Serial != 0)
+		{
+			PyThreadState_SetAsyncExc(RunningThreadId.load(), nullptr);
+		}
+	}
+	
+	bool RequestInterrupt(uint64 Serial)
+	{
+		if (Serial == 0 || RunningSerial.load() != Serial)
+		{
+			return false;
+		}
+		return Py_AddPendingCall(&RaiseInterrupt, reinterpret_cast<void*>(static_cast<UPTRINT>(Serial))) == 0;
+	}
+}
@@ -0,0 +1,36 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Interrupts the Python of a running job with KeyboardInterrupt, from any thread.
+ *
+ * PyThreadState_SetAsyncExc needs the GIL, which the game thread holds while a script runs, so a
+ * cancelling thread cannot call it directly. Instead the request goes through Py_AddPendingCall,
+ * which needs no GIL. The interpreter runs the pending call between two bytecodes of the running
+ * script, and from there the asynchronous exception is raised in the job's thread.
+ * Code stuck in a native call is interrupted once it returns to Python, and a script that catches
+ * BaseException can ignore the interrupt.
+ */
+namespace PythonInterrupt
+{
+	/** Marks the Python of a job as running on this thread for its lifetime. Must be created and destroyed with the GIL held */
+	class FScopedRun
+	{
+	public:
+		explicit FScopedRun(uint64 InSerial);
+		~FScopedRun();
+		
+	private:
+		uint64 Serial;
+	};
+	
+	/**
+	 * Asks the Python of a job to stop at its next bytecode
+	 * @param Serial The serial of the job
+	 * @return False if the job's Python is not running
+	 */
+	bool RequestInterrupt(uint64 Serial);
+}
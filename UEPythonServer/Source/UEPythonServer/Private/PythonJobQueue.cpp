@@ -0,0 +1,405 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PythonJobQueue.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/ScopeLock.h"
+#include "PythonServerTrace.h"
+
+const TCHAR* LexToString(EPythonJobState State)
+{
+	switch (State)
+	{
+	case EPythonJobState::Pending:
+		return TEXT("pending");
+	case EPythonJobState::Running:
+		return TEXT("running");
+	case EPythonJobState::Succeeded:
+		return TEXT("succeeded");
+	case EPythonJobState::Failed:
+		return TEXT("failed");
+	case EPythonJobState::Cancelled:
+		return TEXT("cancelled");
+	default:
+		return TEXT("unknown");
+	}
+}
+
+const TCHAR* LexToString(EPythonJobPriority Priority)
+{
+	switch (Priority)
+	{
+	case EPythonJobPriority::Interactive:
+		return TEXT("interactive");
+	case EPythonJobPriority::Normal:
+		return TEXT("normal");
+	case EPythonJobPriority::Batch:
+		return TEXT("batch");
+	default:
+		return TEXT("unknown");
+	}
+}
+
+bool LexTryParseString(EPythonJobPriority& OutPriority, const TCHAR* Buffer)
+{
+	for (int32 Index = 0; Index < static_cast<int32>(EPythonJobPriority::Count); ++Index)
+	{
+		if (FCString::Stricmp(Buffer, LexToString(static_cast<EPythonJobPriority>(Index))) == 0)
+		{
+			OutPriority = static_cast<EPythonJobPriority>(Index);
+			return true;
+		}
+	}
+	return false;
+}
+
+namespace UEPythonServer
+{
+	/** Jobs each lane may start per round while every lane has work, by priority */
+	static constexpr int32 LaneWeights[static_cast<int32>(EPythonJobPriority::Count)] = { 8, 4, 1 };
+}
+
+FPythonJobQueue::FPythonJobQueue(int32 InMaxPendingJobs, int32 InMaxRetainedJobs, int32 InMaxStreamBufferChars, int64 InMaxRetainedChars)
+	: MaxPendingJobs(InMaxPendingJobs)
+	, MaxRetainedJobs(InMaxRetainedJobs)
+	, MaxStreamBufferChars(InMaxStreamBufferChars)
+	, MaxRetainedChars(InMaxRetainedChars)
+{
+}
+
+TSharedPtr<const FPythonJob> FPythonJobQueue::Enqueue(FJobWork Work, FOnJobCompleted OnCompleted, bool bStreamOutput, const FString& RequestId, EPythonJobPriority Priority, double TimeoutSeconds)
+{
+	FScopeLock Lock(&Mutex);
+	
+	TArray<FQueuedJob>& Lane = PendingJobs[static_cast<int32>(Priority)];
+	if (Lane.Num() >= MaxPendingJobs)
+	{
+		return nullptr;
+	}
+	
+	TSharedPtr<FPythonJob> Job = MakeShared<FPythonJob>();
+	Job->Id = FGuid::NewGuid();
+	Job->RequestId = RequestId;
+	Job->Serial = NextSerial++;
+	Job->Priority = Priority;
+	Job->TimeoutSeconds = FMath::Max(TimeoutSeconds, 0.0);
+	Job->EnqueueTime = FPlatformTime::Seconds();
+	Job->bStreamOutput = bStreamOutput;
+	
+	Lane.Add({ Job, MoveTemp(Work), MoveTemp(OnCompleted) });
+	JobsById.Add(Job->Id, Job);
+	return Job;
+}
+
+EPythonJobCancelResult FPythonJobQueue::Cancel(const FGuid& Id, uint64& OutSerial)
+{
+	FScopeLock Lock(&Mutex);
+	
+	const TSharedPtr<FPythonJob>* Job = JobsById.Find(Id);
+	if (Job == nullptr)
+	{
+		return EPythonJobCancelResult::Unknown;
+	}
+	
+	FPythonJob& CancelledJob = **Job;
+	if (CancelledJob.IsFinished())
+	{
+		return EPythonJobCancelResult::Finished;
+	}
+	
+	// Pending jobs stay in their lane until Tick, callbacks must be invoked on the game thread
+	if (CancelledJob.State == EPythonJobState::Pending)
+	{
+		CancelledJob.State = EPythonJobState::Cancelled;
+		CancelledJob.Result = TEXT("Job was cancelled before it ran");
+		CancelledJob.EndTime = FPlatformTime::Seconds();
+		return EPythonJobCancelResult::Cancelled;
+	}
+	
+	CancelledJob.bCancelRequested = true;
+	OutSerial = CancelledJob.Serial;
+	return EPythonJobCancelResult::Interrupting;
+}
+
+uint64 FPythonJobQueue::GetRunningJobSerial() const
+{
+	FScopeLock Lock(&Mutex);
+	return RunningJob.IsValid() ? RunningJob->Serial : 0;
+}
+
+double FPythonJobQueue::GetRunningJobDeadline() const
+{
+	FScopeLock Lock(&Mutex);
+	if (!RunningJob.IsValid() || RunningJob->TimeoutSeconds <= 0.0)
+	{
+		return 0.0;
+	}
+	return RunningJob->StartTime + RunningJob->TimeoutSeconds;
+}
+
+void FPythonJobQueue::MarkRunningJobTimedOut()
+{
+	FScopeLock Lock(&Mutex);
+	if (RunningJob.IsValid())
+	{
+		RunningJob->bTimedOut = true;
+	}
+}
+
+bool FPythonJobQueue::GetJob(const FGuid& Id, FPythonJob& OutJob) const
+{
+	FScopeLock Lock(&Mutex);
+	
+	const TSharedPtr<FPythonJob>* Job = JobsById.Find(Id);
+	if (Job == nullptr)
+	{
+		return false;
+	}
+	
+	OutJob = **Job;
+	return true;
+}
+
+void FPythonJobQueue::AppendRunningOutput(const FString& Output)
+{
+	FScopeLock Lock(&Mutex);
+	
+	if (!RunningJob.IsValid() || !RunningJob->bStreamOutput)
+	{
+		return;
+	}
+	
+	RunningJob->StreamedOutput += Output;
+	
+	// Keep the most recent output only, clients that fall behind are told how much they missed
+	const int32 NumOver = RunningJob->StreamedOutput.Len() - MaxStreamBufferChars;
+	if (NumOver > 0)
+	{
+		RunningJob->StreamedOutput.RemoveAt(0, NumOver, /* bAllowShrinking */ false);
+		RunningJob->StreamBaseOffset += NumOver;
+	}
+}
+
+bool FPythonJobQueue::ReadStreamedOutput(const FGuid& Id, int64 Offset, FPythonJobOutputChunk& OutChunk) const
+{
+	FScopeLock Lock(&Mutex);
+	
+	const TSharedPtr<FPythonJob>* Job = JobsById.Find(Id);
+	if (Job == nullptr || !(*Job)->bStreamOutput)
+	{
+		return false;
+	}
+	
+	const FPythonJob& StreamJob = **Job;
+	const int64 EndOffset = StreamJob.StreamBaseOffset + StreamJob.StreamedOutput.Len();
+	const int64 StartOffset = FMath::Clamp(Offset, StreamJob.StreamBaseOffset, EndOffset);
+	
+	OutChunk.Output = StreamJob.StreamedOutput.Mid(static_cast<int32>(StartOffset - StreamJob.StreamBaseOffset));
+	OutChunk.Offset = StartOffset;
+	OutChunk.NextOffset = EndOffset;
+	OutChunk.NumDropped = FMath::Max<int64>(StartOffset - FMath::Max<int64>(Offset, 0), 0);
+	OutChunk.State = StreamJob.State;
+	return true;
+}
+
+int32 FPythonJobQueue::Tick(double BudgetSeconds)
+{
+	check(IsInGameThread());
+	PYTHONSERVER_TRACE_SCOPE("PythonServer.Dispatch");
+	
+	const double StartTime = FPlatformTime::Seconds();
+	const double Deadline = StartTime + BudgetSeconds;
+	
+	int32 NumExecuted = 0;
+	while (NumExecuted == 0 || FPlatformTime::Seconds() < Deadline)
+	{
+		FQueuedJob Queued;
+		if (!DequeuePending(Queued))
+		{
+			break;
+		}
+		
+		// Jobs cancelled while pending only need their callback
+		if (Queued.Job->State == EPythonJobState::Cancelled)
+		{
+			if (Queued.OnCompleted)
+			{
+				Queued.OnCompleted(*Queued.Job);
+			}
+			RetireJob(Queued.Job, /* bDelivered */ static_cast<bool>(Queued.OnCompleted));
+			continue;
+		}
+		
+		// Execute outside the lock so clients can keep polling while the job runs
+		FString Result;
+		bool bSuccess = false;
+		{
+			PYTHONSERVER_TRACE_SCOPE("PythonServer.Job");
+			PYTHONSERVER_TRACE_BOOKMARK(TEXT("PythonServer.Job %s"), *Queued.Job->RequestId);
+			bSuccess = Queued.Work(Result);
+		}
+		
+		{
+			FScopeLock Lock(&Mutex);
+			RunningJob.Reset();
+			Queued.Job->Result = MoveTemp(Result);
+			Queued.Job->State = bSuccess ? EPythonJobState::Succeeded : EPythonJobState::Failed;
+			Queued.Job->EndTime = FPlatformTime::Seconds();
+			if (Queued.Job->bCancelRequested)
+			{
+				Queued.Job->State = EPythonJobState::Cancelled;
+				Queued.Job->Result += TEXT("\nJob was cancelled while it ran");
+				++TickStats.NumCancelled;
+			}
+			else if (Queued.Job->bTimedOut)
+			{
+				Queued.Job->State = EPythonJobState::Failed;
+				++TickStats.NumTimedOut;
+			}
+		}
+		
+		if (Queued.OnCompleted)
+		{
+			Queued.OnCompleted(*Queued.Job);
+		}
+		
+		RetireJob(Queued.Job, /* bDelivered */ static_cast<bool>(Queued.OnCompleted));
+		++NumExecuted;
+	}
+	
+	const double TickSeconds = FPlatformTime::Seconds() - StartTime;
+	
+	FScopeLock Lock(&Mutex);
+	TickStats.LastTickSeconds = TickSeconds;
+	TickStats.LastTickJobs = NumExecuted;
+	TickStats.TotalJobsRun += NumExecuted;
+	if (TickSeconds > BudgetSeconds)
+	{
+		++TickStats.NumTicksOverBudget;
+	}
+	
+	return NumExecuted;
+}
+
+int32 FPythonJobQueue::GetNumPending() const
+{
+	FScopeLock Lock(&Mutex);
+	
+	int32 NumPending = 0;
+	for (const TArray<FQueuedJob>& Lane : PendingJobs)
+	{
+		NumPending += Lane.Num();
+	}
+	return NumPending;
+}
+
+FPythonJobQueueStats FPythonJobQueue::GetStats() const
+{
+	FScopeLock Lock(&Mutex);
+	
+	FPythonJobQueueStats Stats = TickStats;
+	const double Now = FPlatformTime::Seconds();
+	for (int32 LaneIndex = 0; LaneIndex < static_cast<int32>(EPythonJobPriority::Count); ++LaneIndex)
+	{
+		const TArray<FQueuedJob>& Lane = PendingJobs[LaneIndex];
+		Stats.NumPendingByPriority[LaneIndex] = Lane.Num();
+		Stats.NumPending += Lane.Num();
+		if (Lane.Num() > 0)
+		{
+			Stats.OldestPendingSeconds = FMath::Max(Stats.OldestPendingSeconds, Now - Lane[0].Job->EnqueueTime);
+		}
+	}
+	return Stats;
+}
+
+void FPythonJobQueue::Reset()
+{
+	FScopeLock Lock(&Mutex);
+	for (TArray<FQueuedJob>& Lane : PendingJobs)
+	{
+		Lane.Reset();
+	}
+	JobsById.Reset();
+	FinishedJobIds.Reset();
+	NumRetainedChars = 0;
+	RunningJob.Reset();
+}
+
+bool FPythonJobQueue::DequeuePending(FQueuedJob& OutJob)
+{
+	FScopeLock Lock(&Mutex);
+	
+	// Take from the highest priority lane that has work and credit left. Once every lane with work
+	// has spent its credit, a new round starts
+	int32 LaneIndex = INDEX_NONE;
+	for (int32 Attempt = 0; Attempt < 2 && LaneIndex == INDEX_NONE; ++Attempt)
+	{
+		for (int32 Index = 0; Index < static_cast<int32>(EPythonJobPriority::Count); ++Index)
+		{
+			if (PendingJobs[Index].Num() > 0 && LaneCredits[Index] > 0)
+			{
+				LaneIndex = Index;
+				break;
+			}
+		}
+		
+		if (LaneIndex == INDEX_NONE)
+		{
+			for (int32 Index = 0; Index < static_cast<int32>(EPythonJobPriority::Count); ++Index)
+			{
+				LaneCredits[Index] = UEPythonServer::LaneWeights[Index];
+			}
+		}
+	}
+	
+	if (LaneIndex == INDEX_NONE)
+	{
+		return false;
+	}
+	
+	TArray<FQueuedJob>& Lane = PendingJobs[LaneIndex];
+	OutJob = MoveTemp(Lane[0]);
+	Lane.RemoveAt(0, 1, /* bAllowShrinking */ false);
+	
+	if (OutJob.Job->State == EPythonJobState::Cancelled)
+	{
+		++TickStats.NumCancelled;
+		return true;
+	}
+	--LaneCredits[LaneIndex];
+	
+	OutJob.Job->State = EPythonJobState::Running;
+	OutJob.Job->StartTime = FPlatformTime::Seconds();
+	RunningJob = OutJob.Job;
+	return true;
+}
+
+void FPythonJobQueue::RetireJob(const TSharedPtr<FPythonJob>& Job, bool bDelivered)
+{
+	FScopeLock Lock(&Mutex);
+	
+	// The callback already sent the result, only a streaming client may still read the job's output
+	if (bDelivered && !Job->bStreamOutput)
+	{
+		Job->Result.Empty();
+		Job->bResultDelivered = true;
+	}
+	
+	FinishedJobIds.Add(Job->Id);
+	NumRetainedChars += GetRetainedChars(*Job);
+	
+	// Evict by count and by size, but always keep the job just finished so it can be polled once
+	int32 NumToEvict = 0;
+	while (NumToEvict < FinishedJobIds.Num() - 1 && (FinishedJobIds.Num() - NumToEvict > MaxRetainedJobs || NumRetainedChars > MaxRetainedChars))
+	{
+		TSharedPtr<FPythonJob> Evicted;
+		if (JobsById.RemoveAndCopyValue(FinishedJobIds[NumToEvict], Evicted))
+		{
+			NumRetainedChars -= GetRetainedChars(*Evicted);
+		}
+		++NumToEvict;
+	}
+	if (NumToEvict > 0)
+	{
+		FinishedJobIds.RemoveAt(0, NumToEvict, /* bAllowShrinking */ false);
+	}
+}
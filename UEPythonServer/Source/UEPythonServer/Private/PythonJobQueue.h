@@ -0,0 +1,295 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/Guid.h"
+#include "HAL/CriticalSection.h"
+
+/** Lifecycle of a queued Python job */
+enum class EPythonJobState : uint8
+{
+	Pending,
+	Running,
+	Succeeded,
+	Failed,
+	Cancelled
+};
+
+/** Returns the lowercase name used for a job state in responses */
+const TCHAR* LexToString(EPythonJobState State);
+
+/** Priority class of a job, each has its own lane in the dispatcher */
+enum class EPythonJobPriority : uint8
+{
+	/** Work a user is waiting on, such as viewport camera moves */
+	Interactive,
+	/** The default */
+	Normal,
+	/** Bulk work such as batch imports, runs when the other lanes leave room */
+	Batch,
+	
+	Count
+};
+
+/** Returns the lowercase name used for a priority in requests and responses */
+const TCHAR* LexToString(EPythonJobPriority Priority);
+
+/** Parses a priority name, returning false if it is not one */
+bool LexTryParseString(EPythonJobPriority& OutPriority, const TCHAR* Buffer);
+
+/** Outcome of a cancellation request */
+enum class EPythonJobCancelResult : uint8
+{
+	/** The job is unknown or has been evicted */
+	Unknown,
+	/** The job had already finished */
+	Finished,
+	/** The job was pending and will not run */
+	Cancelled,
+	/** The job is running, its Python will be interrupted */
+	Interrupting
+};
+
+/**
+ * A unit of game-thread work submitted to the dispatcher, usually Python code
+ */
+struct FPythonJob
+{
+	/** Unique id returned to the client for polling */
+	FGuid Id;
+	
+	/** Id of the request that queued the job, bookmarked at the start of the job's trace span */
+	FString RequestId;
+	
+	/** Sequence number of the job, unlike Id it fits in a pointer for interpreter callbacks */
+	uint64 Serial = 0;
+	
+	/** Lane the job was queued in */
+	EPythonJobPriority Priority = EPythonJobPriority::Normal;
+	
+	/** Set when the job was cancelled while it was running */
+	bool bCancelRequested = false;
+	
+	/** Time the job may run for before the watchdog interrupts it, 0 for no limit */
+	double TimeoutSeconds = 0.0;
+	
+	/** Set when the job ran past its timeout and was interrupted */
+	bool bTimedOut = false;
+	
+	/** Current state of the job */
+	EPythonJobState State = EPythonJobState::Pending;
+	
+	/** Captured output once the job has finished */
+	FString Result;
+	
+	/** Set when Result was handed to the job's completion callback and then released */
+	bool bResultDelivered = false;
+	
+	/** Times in FPlatformTime::Seconds() */
+	double EnqueueTime = 0.0;
+	double StartTime = 0.0;
+	double EndTime = 0.0;
+	
+	/** Whether output is streamed to StreamedOutput while the job runs */
+	bool bStreamOutput = false;
+	
+	/** Streamed output not yet dropped by the buffer cap, starting at StreamBaseOffset */
+	FString StreamedOutput;
+	
+	/** Offset in characters of the first character of StreamedOutput in the whole output */
+	int64 StreamBaseOffset = 0;
+	
+	/** Whether the job has finished, successfully or not */
+	bool IsFinished() const { return State == EPythonJobState::Succeeded || State == EPythonJobState::Failed || State == EPythonJobState::Cancelled; }
+};
+
+/** A slice of a job's streamed output */
+struct FPythonJobOutputChunk
+{
+	/** Output from the requested offset, or from the oldest retained character */
+	FString Output;
+	
+	/** Offset in characters where Output starts */
+	int64 Offset = 0;
+	
+	/** Offset to request next */
+	int64 NextOffset = 0;
+	
+	/** Characters between the requested offset and Offset that were dropped by the buffer cap */
+	int64 NumDropped = 0;
+	
+	/** State of the job when the chunk was read */
+	EPythonJobState State = EPythonJobState::Pending;
+};
+
+/** Snapshot of how far behind the dispatcher is */
+struct FPythonJobQueueStats
+{
+	/** Jobs waiting to run */
+	int32 NumPending = 0;
+	
+	/** Jobs waiting to run in each lane */
+	int32 NumPendingByPriority[static_cast<int32>(EPythonJobPriority::Count)] = {};
+	
+	/** Time the oldest pending job has been waiting, in seconds */
+	double OldestPendingSeconds = 0.0;
+	
+	/** Time spent running jobs during the last tick, in seconds */
+	double LastTickSeconds = 0.0;
+	
+	/** Jobs run during the last tick */
+	int32 LastTickJobs = 0;
+	
+	/** Jobs run since the queue was created */
+	uint64 TotalJobsRun = 0;
+	
+	/** Ticks that went over budget because a single job took longer than the budget */
+	uint64 NumTicksOverBudget = 0;
+	
+	/** Jobs cancelled before or while running */
+	uint64 NumCancelled = 0;
+	
+	/** Jobs interrupted by the watchdog for running past their timeout */
+	uint64 NumTimedOut = 0;
+};
+
+/**
+ * Game-thread dispatcher for Python work.
+ * Jobs are queued from the HTTP handlers and drained from an FTSTicker callback until the
+ * per-tick budget is used up. Finished jobs are retained so clients can poll their result,
+ * oldest first out, up to a number of jobs and a number of retained characters. Jobs with a
+ * completion callback have already delivered their result, so only their state is retained.
+ * Each priority has its own lane, drained in weighted round-robin order: while every lane has
+ * work, 8 interactive jobs run for every 4 normal and 1 batch job, so batch work is slowed
+ * down but never starved.
+ */
+class FPythonJobQueue
+{
+public:
+	/** Runs the job on the game thread, fills in its output and returns whether it succeeded */
+	using FJobWork = TFunction<bool(FString& /*OutResult*/)>;
+	
+	/** Called on the game thread once a job has finished */
+	using FOnJobCompleted = TFunction<void(const FPythonJob& /*Job*/)>;
+	
+	FPythonJobQueue(int32 InMaxPendingJobs = 256, int32 InMaxRetainedJobs = 1024, int32 InMaxStreamBufferChars = 1024 * 1024, int64 InMaxRetainedChars = 64 * 1024 * 1024);
+	
+	/**
+	 * Adds a job to the queue
+	 * @param Work The work to run on the game thread
+	 * @param OnCompleted Optional callback invoked once the job has finished
+	 * @param bStreamOutput Whether the job's output is appended to its stream buffer with AppendRunningOutput
+	 * @param RequestId Id of the request the job belongs to, see PythonServerProtocol::GetRequestId
+	 * @param Priority Lane to queue the job in
+	 * @param TimeoutSeconds Time the job may run for once started, 0 for no limit
+	 * @return The new job, or nullptr if the job's lane is full
+	 */
+	TSharedPtr<const FPythonJob> Enqueue(FJobWork Work, FOnJobCompleted OnCompleted = nullptr, bool bStreamOutput = false, const FString& RequestId = FString(), EPythonJobPriority Priority = EPythonJobPriority::Normal, double TimeoutSeconds = 0.0);
+	
+	/**
+	 * Cancels a job, from any thread. A pending job is marked cancelled and its callback is invoked
+	 * by the next Tick without running it. A running job is only flagged, the caller interrupts
+	 * its Python, and it is reported as cancelled once it returns.
+	 * @param OutSerial Set to the serial of the job when it is running
+	 */
+	EPythonJobCancelResult Cancel(const FGuid& Id, uint64& OutSerial);
+	
+	/** Gets the serial of the job being run by Tick, 0 if none */
+	uint64 GetRunningJobSerial() const;
+	
+	/** Gets the time the job being run by Tick must finish by, in FPlatformTime::Seconds(), 0 if it has no timeout */
+	double GetRunningJobDeadline() const;
+	
+	/** Marks the job being run by Tick as timed out, it is then reported as failed */
+	void MarkRunningJobTimedOut();
+	
+	/**
+	 * Appends output to the stream buffer of the job currently running, if it streams its output.
+	 * Once the buffer is over its cap, the oldest output is dropped.
+	 */
+	void AppendRunningOutput(const FString& Output);
+	
+	/**
+	 * Reads a job's streamed output from the given offset
+	 * @return False if the job is unknown, has been evicted or does not stream its output
+	 */
+	bool ReadStreamedOutput(const FGuid& Id, int64 Offset, FPythonJobOutputChunk& OutChunk) const;
+	
+	/**
+	 * Copies the current state of a job
+	 * @return False if the job is unknown or has been evicted
+	 */
+	bool GetJob(const FGuid& Id, FPythonJob& OutJob) const;
+	
+	/**
+	 * Runs pending jobs until the budget is used up. At least one job is started per call
+	 * so that a budget smaller than a single job still makes progress.
+	 * @param BudgetSeconds Time allowed for this call
+	 * @return Number of jobs executed
+	 */
+	int32 Tick(double BudgetSeconds);
+	
+	/** Number of jobs waiting to run */
+	int32 GetNumPending() const;
+	
+	/** Gets a snapshot of the queue backlog and the last tick */
+	FPythonJobQueueStats GetStats() const;
+	
+	/** Drops all pending and finished jobs. Pending jobs never run and their callbacks are not invoked */
+	void Reset();
+	
+private:
+	/** A pending job along with the work to run */
+	struct FQueuedJob
+	{
+		TSharedPtr<FPythonJob> Job;
+		FJobWork Work;
+		FOnJobCompleted OnCompleted;
+	};
+	
+	/** Pops the next pending job in weighted lane order, returning false if there is none */
+	bool DequeuePending(FQueuedJob& OutJob);
+	
+	/**
+	 * Records a finished job and evicts the oldest finished ones beyond the retention limits
+	 * @param bDelivered Whether the job's completion callback has consumed its result
+	 */
+	void RetireJob(const TSharedPtr<FPythonJob>& Job, bool bDelivered);
+	
+	/** Characters a finished job keeps alive, its result and streamed output */
+	static int64 GetRetainedChars(const FPythonJob& Job) { return Job.Result.Len() + Job.StreamedOutput.Len(); }
+	
+	/** Limit of each lane, so a flood of batch work cannot lock out interactive requests */
+	int32 MaxPendingJobs;
+	int32 MaxRetainedJobs;
+	int32 MaxStreamBufferChars;
+	int64 MaxRetainedChars;
+	
+	/** Guards every container below */
+	mutable FCriticalSection Mutex;
+	
+	/** Jobs waiting to run per lane, in submission order */
+	TArray<FQueuedJob> PendingJobs[static_cast<int32>(EPythonJobPriority::Count)];
+	
+	/** Jobs each lane may still start in the current round of the weighted round-robin */
+	int32 LaneCredits[static_cast<int32>(EPythonJobPriority::Count)] = {};
+	
+	/** Serial of the next job */
+	uint64 NextSerial = 1;
+	
+	/** Every known job by id */
+	TMap<FGuid, TSharedPtr<FPythonJob>> JobsById;
+	
+	/** Finished job ids, oldest first */
+	TArray<FGuid> FinishedJobIds;
+	
+	/** Characters held by the finished jobs */
+	int64 NumRetainedChars = 0;
+	
+	/** The job being run by Tick, if any */
+	TSharedPtr<FPythonJob> RunningJob;
+	
+	/** Stats of the last tick, the backlog fields are filled in by GetStats */
+	FPythonJobQueueStats TickStats;
+};
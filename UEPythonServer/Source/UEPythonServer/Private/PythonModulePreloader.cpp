@@ -0,0 +1,115 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PythonModulePreloader.h"
+#include "IncludePython.h"
+#include "PyPtr.h"
+#include "Dom/JsonValue.h"
+#include "HAL/PlatformTime.h"
+
+namespace UEPythonServer
+{
+	/** Characters of a failed import's error kept for /status */
+	static constexpr int32 MaxPreloadErrorChars = 1024;
+}
+
+FPythonModulePreloader::FPythonModulePreloader(const TArray<FString>& InModuleNames, double InStartTime)
+	: StartTime(InStartTime)
+{
+	Modules.Reserve(InModuleNames.Num());
+	for (const FString& ModuleName : InModuleNames)
+	{
+		FPythonPreloadedModule& Module = Modules.AddDefaulted_GetRef();
+		Module.Name = ModuleName;
+	}
+	EndTime = StartTime;
+}
+
+bool FPythonModulePreloader::ImportModule(const FString& Name)
+{
+	FPyObjectPtr Module = FPyObjectPtr::StealReference(PyImport_ImportModule(TCHAR_TO_UTF8(*Name)));
+	if (Module)
+	{
+		return true;
+	}
+	
+	// unreal.EditorAssetLibrary is a type of the unreal module, not a submodule
+	int32 DotIndex = INDEX_NONE;
+	if (!PyErr_ExceptionMatches(PyExc_ImportError) || !Name.FindLastChar(TEXT('.'), DotIndex))
+	{
+		return false;
+	}
+	PyErr_Clear();
+	
+	FPyObjectPtr Parent = FPyObjectPtr::StealReference(PyImport_ImportModule(TCHAR_TO_UTF8(*Name.Left(DotIndex))));
+	if (!Parent)
+	{
+		return false;
+	}
+	FPyObjectPtr Attribute = FPyObjectPtr::StealReference(PyObject_GetAttrString(Parent.Get(), TCHAR_TO_UTF8(*Name.Mid(DotIndex + 1))));
+	return Attribute.IsValid();
+}
+
+TArray<FString> FPythonModulePreloader::ParseModuleList(const FString& List)
+{
+	TArray<FString> ModuleNames;
+	const TCHAR* Delimiters[] = { TEXT(","), TEXT(";"), TEXT(" "), TEXT("\t"), TEXT("\n"), TEXT("\r") };
+	List.ParseIntoArray(ModuleNames, Delimiters, UE_ARRAY_COUNT(Delimiters), /* bCullEmpty */ true);
+	return ModuleNames;
+}
+
+void FPythonModulePreloader::OnModuleFinished(int32 Index, const FPythonJob& Job)
+{
+	FPythonPreloadedModule& Module = Modules[Index];
+	Module.State = Job.State;
+	Module.Seconds = Job.EndTime - Job.StartTime;
+	if (Job.State != EPythonJobState::Succeeded)
+	{
+		Module.Error = Job.Result.Left(UEPythonServer::MaxPreloadErrorChars);
+		++NumFailed;
+		UE_LOG(LogTemp, Warning, TEXT("UEPythonServer could not preload %s: %s"), *Module.Name, *Module.Error);
+	}
+	
+	++NumFinished;
+	EndTime = FMath::Max(EndTime, Job.EndTime);
+	if (IsFinished())
+	{
+		UE_LOG(LogTemp, Log, TEXT("UEPythonServer preloaded %d modules in %.1f ms, %d failed"), Modules.Num(), (EndTime - StartTime) * 1000.0, NumFailed);
+	}
+}
+
+void FPythonModulePreloader::OnModuleFailed(int32 Index, const FString& Error)
+{
+	FPythonPreloadedModule& Module = Modules[Index];
+	Module.State = EPythonJobState::Failed;
+	Module.Error = Error;
+	++NumFailed;
+	++NumFinished;
+	EndTime = FMath::Max(EndTime, FPlatformTime::Seconds());
+}
+
+TSharedRef<FJsonObject> FPythonModulePreloader::ToJson() const
+{
+	TSharedRef<FJsonObject> PreloadObj = MakeShared<FJsonObject>();
+	PreloadObj->SetStringField("state", IsFinished() ? TEXT("done") : TEXT("running"));
+	PreloadObj->SetNumberField("loaded", NumFinished - NumFailed);
+	PreloadObj->SetNumberField("failed", NumFailed);
+	
+	// Time from the server starting to the last import, the wait of a client that needs every module
+	PreloadObj->SetNumberField("total_ms", ((IsFinished() ? EndTime : FPlatformTime::Seconds()) - StartTime) * 1000.0);
+	
+	TArray<TSharedPtr<FJsonValue>> ModuleValues;
+	for (const FPythonPreloadedModule& Module : Modules)
+	{
+		TSharedPtr<FJsonObject> ModuleObj = MakeShared<FJsonObject>();
+		ModuleObj->SetStringField("name", Module.Name);
+		ModuleObj->SetStringField("state", LexToString(Module.State));
+		ModuleObj->SetNumberField("ms", Module.Seconds * 1000.0);
+		if (!Module.Error.IsEmpty())
+		{
+			ModuleObj->SetStringField("error", Module.Error);
+		}
+		ModuleValues.Add(MakeShared<FJsonValueObject>(ModuleObj));
+	}
+	PreloadObj->SetArrayField("modules", ModuleValues);
+	return PreloadObj;
+}
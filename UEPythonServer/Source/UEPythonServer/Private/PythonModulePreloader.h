@@ -0,0 +1,76 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PythonJobQueue.h"
+#include "Dom/JsonObject.h"
+
+/** Import of one module of the preload list */
+struct FPythonPreloadedModule
+{
+	/** Module name, or module.attribute to warm a lazily created unreal type */
+	FString Name;
+	
+	/** Pending until its job runs, then succeeded or failed */
+	EPythonJobState State = EPythonJobState::Pending;
+	
+	/** Time the import took, in seconds */
+	double Seconds = 0.0;
+	
+	/** Error of a failed import */
+	FString Error;
+};
+
+/**
+ * Progress of the module imports queued when the server starts.
+ * Importing unreal submodules and helper libraries from the first request scripts makes those
+ * requests slow, so the server imports a configured list in batch-lane jobs as soon as it starts,
+ * between the requests that are already arriving. Only used on the game thread.
+ */
+class FPythonModulePreloader
+{
+public:
+	/**
+	 * @param InModuleNames The modules to import, in order
+	 * @param InStartTime Time the server started, in FPlatformTime::Seconds()
+	 */
+	FPythonModulePreloader(const TArray<FString>& InModuleNames, double InStartTime);
+	
+	/**
+	 * Imports a module with the GIL held. A dotted name that is not a module is looked up as an
+	 * attribute of its parent, which creates the unreal types that are only generated on first use.
+	 * @return False with the Python error set if the import failed
+	 */
+	static bool ImportModule(const FString& Name);
+	
+	/** Parses a comma or whitespace separated list of module names */
+	static TArray<FString> ParseModuleList(const FString& List);
+	
+	/** Gets the modules to import */
+	const TArray<FPythonPreloadedModule>& GetModules() const { return Modules; }
+	
+	/** Records the outcome of the job importing a module */
+	void OnModuleFinished(int32 Index, const FPythonJob& Job);
+	
+	/** Records a module whose job could not be queued */
+	void OnModuleFailed(int32 Index, const FString& Error);
+	
+	/** Whether every module has been imported or has failed */
+	bool IsFinished() const { return NumFinished == Modules.Num(); }
+	
+	/** Builds the "preload" object of /status */
+	TSharedRef<FJsonObject> ToJson() const;
+	
+private:
+	TArray<FPythonPreloadedModule> Modules;
+	
+	/** Time the server started, in FPlatformTime::Seconds() */
+	double StartTime = 0.0;
+	
+	/** Time the last module finished, in FPlatformTime::Seconds() */
+	double EndTime = 0.0;
+	
+	int32 NumFinished = 0;
+	int32 NumFailed = 0;
+};
@@ -0,0 +1,71 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PythonOutputCapture.h"
+
+FPythonOutputCapture::FPythonOutputCapture(int32 InMaxChars)
+	: MaxHeadChars(FMath::Max(InMaxChars, 2) / 2)
+	, MaxTailChars(FMath::Max(InMaxChars, 2) - FMath::Max(InMaxChars, 2) / 2)
+{
+}
+
+void FPythonOutputCapture::Append(const FString& Output)
+{
+	NumAppended += Output.Len();
+	
+	const TCHAR* Data = *Output;
+	int32 Length = Output.Len();
+	
+	// Fill the head first
+	const int32 NumToHead = FMath::Min(MaxHeadChars - Head.Len(), Length);
+	if (NumToHead > 0)
+	{
+		Head.AppendChars(Data, NumToHead);
+		Data += NumToHead;
+		Length -= NumToHead;
+	}
+	
+	if (Length == 0)
+	{
+		return;
+	}
+	
+	// Trim the tail only once it has doubled, so a stream of small prints is not copied on every call
+	if (Length >= MaxTailChars)
+	{
+		Tail = FString(MaxTailChars, Data + Length - MaxTailChars);
+	}
+	else
+	{
+		Tail.AppendChars(Data, Length);
+		if (Tail.Len() > 2 * MaxTailChars)
+		{
+			Tail.RightInline(MaxTailChars);
+		}
+	}
+}
+
+int64 FPythonOutputCapture::GetNumDropped() const
+{
+	return NumAppended - Head.Len() - FMath::Min(Tail.Len(), MaxTailChars);
+}
+
+FString FPythonOutputCapture::Finish()
+{
+	if (Tail.Len() > MaxTailChars)
+	{
+		Tail.RightInline(MaxTailChars);
+	}
+	
+	const int64 NumDropped = GetNumDropped();
+	FString Output = MoveTemp(Head);
+	if (NumDropped > 0)
+	{
+		Output += FString::Printf(TEXT("\n[... %lld characters of output dropped ...]\n"), NumDropped);
+	}
+	Output += Tail;
+	
+	Head.Reset();
+	Tail.Reset();
+	NumAppended = 0;
+	return Output;
+}
@@ -0,0 +1,46 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Captures the output of a Python run up to a cap, keeping the head and the tail of the output.
+ * The start of the output usually says what a script was doing and the end how it finished, so
+ * a runaway print loop loses its middle instead of growing the editor's memory without bound.
+ */
+class FPythonOutputCapture
+{
+public:
+	/**
+	 * @param InMaxChars Characters to retain, split evenly between the head and the tail
+	 */
+	explicit FPythonOutputCapture(int32 InMaxChars);
+	
+	/** Appends output, dropping what falls between the head and the tail */
+	void Append(const FString& Output);
+	
+	/** Characters appended so far */
+	int64 GetNumAppended() const { return NumAppended; }
+	
+	/** Characters dropped so far */
+	int64 GetNumDropped() const;
+	
+	/**
+	 * Gets the retained output. If anything was dropped, a line in its place says how much
+	 * @return The output, the capture is empty afterwards
+	 */
+	FString Finish();
+	
+private:
+	int32 MaxHeadChars;
+	int32 MaxTailChars;
+	
+	/** The first characters of the output, up to MaxHeadChars */
+	FString Head;
+	
+	/** The last characters of the output, trimmed back to MaxTailChars once it holds twice that */
+	FString Tail;
+	
+	int64 NumAppended = 0;
+};
@@ -0,0 +1,132 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PythonResultCache.h"
+#include "Hash/CityHash.h"
+#include "HAL/PlatformTime.h"
+
+const TCHAR* LexToString(EPythonCacheOutcome Outcome)
+{
+	switch (Outcome)
+	{
+	case EPythonCacheOutcome::Miss:
+		return TEXT("miss");
+	case EPythonCacheOutcome::Coalesced:
+		return TEXT("coalesced");
+	case EPythonCacheOutcome::Hit:
+		return TEXT("hit");
+	default:
+		return TEXT("unknown");
+	}
+}
+
+FPythonResultCache::FPythonResultCache(int32 InMaxEntries)
+	: MaxEntries(FMath::Max(InMaxEntries, 16))
+{
+}
+
+FString FPythonResultCache::MakeKey(const FString& CacheKey, const FGuid& SessionId, const FString& Code, bool bEval)
+{
+	const uint64 CodeHash = CityHash64(reinterpret_cast<const char*>(*Code), Code.Len() * sizeof(TCHAR));
+	return FString::Printf(TEXT("%s|%s|%016llx%s"), *CacheKey, *SessionId.ToString(), CodeHash, bEval ? TEXT("|eval") : TEXT(""));
+}
+
+bool FPythonResultCache::FindOrWait(const FString& Key, FWaiter Waiter)
+{
+	FEntry* Entry = Entries.Find(Key);
+	if (Entry == nullptr)
+	{
+		++NumMisses;
+		return false;
+	}
+	
+	if (Entry->bInFlight)
+	{
+		++NumCoalesced;
+		Entry->Waiters.Add(MoveTemp(Waiter));
+		return true;
+	}
+	
+	if (FPlatformTime::Seconds() < Entry->ExpireTime)
+	{
+		++NumHits;
+		Waiter(Entry->Result, EPythonCacheOutcome::Hit);
+		return true;
+	}
+	
+	Entries.Remove(Key);
+	++NumMisses;
+	return false;
+}
+
+void FPythonResultCache::Begin(const FString& Key, FWaiter Waiter)
+{
+	if (Entries.Num() >= MaxEntries)
+	{
+		EvictExpired(FPlatformTime::Seconds());
+	}
+	
+	// Runs in flight are always tracked, a full cache only stops results from being kept
+	FEntry& Entry = Entries.FindOrAdd(Key);
+	Entry.bInFlight = true;
+	Entry.Waiters.Reset();
+	Entry.Waiters.Add(MoveTemp(Waiter));
+}
+
+void FPythonResultCache::Complete(const FString& Key, const FPythonCachedResult& Result, double TtlSeconds)
+{
+	FEntry* Entry = Entries.Find(Key);
+	if (Entry == nullptr || !Entry->bInFlight)
+	{
+		return;
+	}
+	
+	TArray<FWaiter> Waiters = MoveTemp(Entry->Waiters);
+	if (Result.bSuccess && TtlSeconds > 0.0 && Entries.Num() <= MaxEntries)
+	{
+		Entry->bInFlight = false;
+		Entry->Result = Result;
+		Entry->ExpireTime = FPlatformTime::Seconds() + TtlSeconds;
+	}
+	else
+	{
+		Entries.Remove(Key);
+	}
+	
+	// The first waiter is the request that ran the code
+	for (int32 Index = 0; Index < Waiters.Num(); ++Index)
+	{
+		Waiters[Index](Result, Index == 0 ? EPythonCacheOutcome::Miss : EPythonCacheOutcome::Coalesced);
+	}
+}
+
+void FPythonResultCache::Abort(const FString& Key)
+{
+	Entries.Remove(Key);
+}
+
+FPythonResultCacheStats FPythonResultCache::GetStats() const
+{
+	FPythonResultCacheStats Stats;
+	Stats.NumEntries = Entries.Num();
+	Stats.MaxEntries = MaxEntries;
+	Stats.NumHits = NumHits;
+	Stats.NumCoalesced = NumCoalesced;
+	Stats.NumMisses = NumMisses;
+	return Stats;
+}
+
+void FPythonResultCache::Empty()
+{
+	Entries.Empty();
+}
+
+void FPythonResultCache::EvictExpired(double Now)
+{
+	for (auto It = Entries.CreateIterator(); It; ++It)
+	{
+		if (!It.Value().bInFlight && It.Value().ExpireTime <= Now)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
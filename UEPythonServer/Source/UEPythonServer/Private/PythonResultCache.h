@@ -0,0 +1,117 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FPythonResultValue;
+
+/** How a cache-keyed request was answered */
+enum class EPythonCacheOutcome : uint8
+{
+	/** The request ran the code */
+	Miss,
+	/** The request waited for an identical run that was already in flight */
+	Coalesced,
+	/** The request was answered with the result of an earlier run */
+	Hit
+};
+
+/** Returns the lowercase name used for an outcome in responses */
+const TCHAR* LexToString(EPythonCacheOutcome Outcome);
+
+/** Result of a cache-keyed run, shared by every request it answers */
+struct FPythonCachedResult
+{
+	FString Result;
+	bool bSuccess = false;
+	int64 NumDropped = 0;
+	bool bTimedOut = false;
+	
+	/** Value of a run in evaluation mode */
+	TSharedPtr<const FPythonResultValue> Value;
+};
+
+/** Counters of the result cache */
+struct FPythonResultCacheStats
+{
+	int32 NumEntries = 0;
+	int32 MaxEntries = 0;
+	uint64 NumHits = 0;
+	uint64 NumCoalesced = 0;
+	uint64 NumMisses = 0;
+};
+
+/**
+ * Coalesces and caches the results of requests marked idempotent with a cache key.
+ * While a keyed run is queued or running, identical requests wait for it instead of running
+ * again. Successful results are then reused until their TTL expires, failures are only shared
+ * with the requests that waited. Entries are keyed by the client's key, the session and a hash
+ * of the code, so one key sent with different code does not share results.
+ * Every method must be called on the game thread, where requests are handled and jobs complete.
+ */
+class FPythonResultCache
+{
+public:
+	/** Called with the result once the run a request waits on has finished */
+	using FWaiter = TFunction<void(const FPythonCachedResult& /*Result*/, EPythonCacheOutcome /*Outcome*/)>;
+	
+	explicit FPythonResultCache(int32 InMaxEntries = 1024);
+	
+	/**
+	 * Builds the key of a request
+	 * @param bEval Whether the request returns the code's value, such runs are not shared with plain ones
+	 */
+	static FString MakeKey(const FString& CacheKey, const FGuid& SessionId, const FString& Code, bool bEval);
+	
+	/**
+	 * Answers a request from the cache or from a run in flight
+	 * @param Key Key from MakeKey
+	 * @param Waiter Called right away with a cached result, or later with the result of the run in flight
+	 * @return False if the caller must run the code itself, and call Begin then Complete
+	 */
+	bool FindOrWait(const FString& Key, FWaiter Waiter);
+	
+	/** Marks a run as in flight, so identical requests wait for it. Waiter is answered as the miss */
+	void Begin(const FString& Key, FWaiter Waiter);
+	
+	/**
+	 * Finishes a run, answers every request that waited for it and keeps the result if it succeeded
+	 * @param TtlSeconds Time to reuse the result for, 0 to not keep it
+	 */
+	void Complete(const FString& Key, const FPythonCachedResult& Result, double TtlSeconds);
+	
+	/** Drops a run that could not be queued, Begin's waiter is not called */
+	void Abort(const FString& Key);
+	
+	/** Gets a snapshot of the cache counters */
+	FPythonResultCacheStats GetStats() const;
+	
+	/** Drops every result and every run in flight, their waiters are never called */
+	void Empty();
+	
+private:
+	struct FEntry
+	{
+		FPythonCachedResult Result;
+		
+		/** Time the result expires, in FPlatformTime::Seconds() */
+		double ExpireTime = 0.0;
+		
+		/** Requests waiting on the run in flight, empty once the result is known */
+		TArray<FWaiter> Waiters;
+		
+		bool bInFlight = false;
+	};
+	
+	/** Drops expired results, once the cache is full */
+	void EvictExpired(double Now);
+	
+	TMap<FString, FEntry> Entries;
+	
+	int32 MaxEntries;
+	
+	uint64 NumHits = 0;
+	uint64 NumCoalesced = 0;
+	uint64 NumMisses = 0;
+};
@@ -0,0 +1,60 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PythonScriptRegistry.h"
+#include "IncludePython.h"
+
+FPythonScriptRegistry::~FPythonScriptRegistry()
+{
+	// Owners empty the registry with the GIL held, this only catches misuse
+	check(Scripts.Num() == 0);
+}
+
+bool FPythonScriptRegistry::IsValidName(const FString& Name)
+{
+	if (Name.IsEmpty() || Name.Len() > 128)
+	{
+		return false;
+	}
+	
+	for (const TCHAR Char : Name)
+	{
+		if (!FChar::IsAlnum(Char) && Char != TEXT('_') && Char != TEXT('-') && Char != TEXT('.'))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool FPythonScriptRegistry::Register(const FString& Name, const FString& Code)
+{
+	// Compile under the script name so tracebacks point at it
+	const FString FileName = FString::Printf(TEXT("<script:%s>"), *Name);
+	FPyObjectPtr CodeObject = FPyObjectPtr::StealReference(Py_CompileString(TCHAR_TO_UTF8(*Code), TCHAR_TO_UTF8(*FileName), Py_file_input));
+	if (!CodeObject)
+	{
+		return false;
+	}
+	
+	Scripts.Add(Name, MoveTemp(CodeObject));
+	return true;
+}
+
+FPyObjectPtr FPythonScriptRegistry::Find(const FString& Name) const
+{
+	const FPyObjectPtr* CodeObject = Scripts.Find(Name);
+	return CodeObject ? *CodeObject : FPyObjectPtr();
+}
+
+TArray<FString> FPythonScriptRegistry::GetNames() const
+{
+	TArray<FString> Names;
+	Scripts.GetKeys(Names);
+	Names.Sort();
+	return Names;
+}
+
+void FPythonScriptRegistry::Empty()
+{
+	Scripts.Empty();
+}
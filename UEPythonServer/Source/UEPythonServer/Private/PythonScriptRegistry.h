@@ -0,0 +1,43 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PyPtr.h"
+
+/**
+ * Named scripts uploaded once through /scripts/register and invoked by name afterwards.
+ * Scripts are compiled at registration and stay resident until replaced or the module shuts down.
+ * Every method must be called with the GIL held.
+ */
+class FPythonScriptRegistry
+{
+public:
+	~FPythonScriptRegistry();
+	
+	/** Whether the name can be used for a script (letters, digits, '_', '-' and '.') */
+	static bool IsValidName(const FString& Name);
+	
+	/**
+	 * Compiles and registers a script, replacing any script with the same name
+	 * @param Name The name to invoke the script by
+	 * @param Code The Python source
+	 * @return False with the Python error set if compilation failed
+	 */
+	bool Register(const FString& Name, const FString& Code);
+	
+	/**
+	 * Gets the compiled code object of a registered script
+	 * @return The code object, or null if no script has that name
+	 */
+	FPyObjectPtr Find(const FString& Name) const;
+	
+	/** Gets the names of every registered script */
+	TArray<FString> GetNames() const;
+	
+	/** Drops every registered script */
+	void Empty();
+	
+private:
+	TMap<FString, FPyObjectPtr> Scripts;
+};
@@ -0,0 +1,61 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PythonServerCommandlet.h"
+#include "UEPythonServer.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Containers/Ticker.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/ThreadManager.h"
+#include "Misc/CoreMisc.h"
+#include "Misc/Parse.h"
+#include "Modules/ModuleManager.h"
+
+namespace UEPythonServer
+{
+	/** Time slept between two iterations of the commandlet loop, bounds request latency when idle */
+	static constexpr float CommandletSleepSeconds = 0.001f;
+}
+
+UPythonServerCommandlet::UPythonServerCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UPythonServerCommandlet::Main(const FString& Params)
+{
+	uint32 Port = 8500;
+	FParse::Value(*Params, TEXT("PythonServerPort="), Port);
+	
+	// -PythonServerPort= may already have started it after engine init
+	FUEPythonServerModule& ServerModule = FModuleManager::LoadModuleChecked<FUEPythonServerModule>("UEPythonServer");
+	if (!ServerModule.IsServerRunning() && !ServerModule.StartServer(Port))
+	{
+		UE_LOG(LogTemp, Error, TEXT("PythonServer commandlet could not start the server on port %u"), Port);
+		return 1;
+	}
+	UE_LOG(LogTemp, Display, TEXT("PythonServer commandlet serving on port %u, stop it with Ctrl+C"), ServerModule.GetServerPort());
+	
+	// The HTTP listeners, the dispatcher and the WebSocket server all run from the core ticker,
+	// and responses are completed with game-thread tasks
+	double LastTime = FPlatformTime::Seconds();
+	while (!IsEngineExitRequested())
+	{
+		const double Now = FPlatformTime::Seconds();
+		const float DeltaTime = static_cast<float>(Now - LastTime);
+		LastTime = Now;
+		
+		FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+		FTSTicker::GetCoreTicker().Tick(DeltaTime);
+		FThreadManager::Get().Tick();
+		GFrameCounter++;
+		
+		FPlatformProcess::Sleep(UEPythonServer::CommandletSleepSeconds);
+	}
+	
+	ServerModule.StopServer();
+	return 0;
+}
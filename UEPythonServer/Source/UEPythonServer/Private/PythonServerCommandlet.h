@@ -0,0 +1,25 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "PythonServerCommandlet.generated.h"
+
+/**
+ * Runs the Python server without the editor UI, for automation workers.
+ * Run with: UnrealEditor-Cmd <Project> -run=PythonServer -PythonServerPort=8500 -unattended -nullrhi
+ * A commandlet has no engine loop, so this one pumps the core ticker and the game thread's task
+ * queue itself until the engine is asked to exit, for example with Ctrl+C.
+ */
+UCLASS()
+class UPythonServerCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+	
+public:
+	UPythonServerCommandlet();
+	
+	/** UCommandlet implementation */
+	virtual int32 Main(const FString& Params) override;
+};
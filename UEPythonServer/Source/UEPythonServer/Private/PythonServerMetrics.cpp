@@ -0,0 +1,151 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PythonServerMetrics.h"
+
+const TCHAR* LexToString(EPythonServerStage Stage)
+{
+	switch (Stage)
+	{
+	case EPythonServerStage::Parse:
+		return TEXT("parse");
+	case EPythonServerStage::QueueWait:
+		return TEXT("queue_wait");
+	case EPythonServerStage::Compile:
+		return TEXT("compile");
+	case EPythonServerStage::Execute:
+		return TEXT("execute");
+	case EPythonServerStage::OutputCapture:
+		return TEXT("output_capture");
+	case EPythonServerStage::Serialize:
+		return TEXT("serialize");
+	case EPythonServerStage::Total:
+		return TEXT("total");
+	default:
+		return TEXT("unknown");
+	}
+}
+
+const double FLatencyHistogram::BucketBounds[FLatencyHistogram::NumBounds] =
+{
+	0.00005, 0.0001, 0.00025, 0.0005,
+	0.001, 0.0025, 0.005, 0.01,
+	0.025, 0.05, 0.1, 0.25,
+	0.5, 1.0, 2.5, 5.0,
+	10.0
+};
+
+FLatencyHistogram::FLatencyHistogram()
+	: Count(0)
+	, SumNanoseconds(0)
+{
+	for (std::atomic<uint64>& Bucket : Buckets)
+	{
+		Bucket.store(0, std::memory_order_relaxed);
+	}
+}
+
+void FLatencyHistogram::Record(double Seconds)
+{
+	int32 Index = 0;
+	while (Index < NumBounds && Seconds > BucketBounds[Index])
+	{
+		++Index;
+	}
+	
+	Buckets[Index].fetch_add(1, std::memory_order_relaxed);
+	Count.fetch_add(1, std::memory_order_relaxed);
+	SumNanoseconds.fetch_add(static_cast<uint64>(FMath::Max(Seconds, 0.0) * 1e9), std::memory_order_relaxed);
+}
+
+double FLatencyHistogram::GetQuantile(double Quantile) const
+{
+	const uint64 NumSamples = GetCount();
+	if (NumSamples == 0)
+	{
+		return 0.0;
+	}
+	
+	const double Rank = Quantile * NumSamples;
+	uint64 NumBelow = 0;
+	for (int32 Index = 0; Index <= NumBounds; ++Index)
+	{
+		const uint64 NumInBucket = GetBucketCount(Index);
+		if (NumInBucket > 0 && NumBelow + NumInBucket >= Rank)
+		{
+			// Samples past the last bound are reported at the last bound
+			if (Index == NumBounds)
+			{
+				return BucketBounds[NumBounds - 1];
+			}
+			
+			const double LowerBound = Index > 0 ? BucketBounds[Index - 1] : 0.0;
+			const double Fraction = (Rank - NumBelow) / NumInBucket;
+			return LowerBound + (BucketBounds[Index] - LowerBound) * FMath::Clamp(Fraction, 0.0, 1.0);
+		}
+		NumBelow += NumInBucket;
+	}
+	return BucketBounds[NumBounds - 1];
+}
+
+FPythonServerMetrics::FPythonServerMetrics()
+	: NumExecuteRequests(0)
+	, NumExecuteErrors(0)
+{
+}
+
+void FPythonServerMetrics::RecordStage(EPythonServerStage Stage, double Seconds)
+{
+	StageHistograms[static_cast<int32>(Stage)].Record(Seconds);
+}
+
+void FPythonServerMetrics::CountExecuteRequest(bool bSuccess)
+{
+	NumExecuteRequests.fetch_add(1, std::memory_order_relaxed);
+	if (!bSuccess)
+	{
+		NumExecuteErrors.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+/** Writes the cumulative buckets, sum and count of a histogram, Labels being the labels before le */
+static void WritePrometheusHistogram(FString& Out, const TCHAR* Name, const TCHAR* Labels, const FLatencyHistogram& Histogram)
+{
+	const TCHAR* Separator = Labels[0] != TEXT('\0') ? TEXT(",") : TEXT("");
+	
+	// Prometheus buckets are cumulative
+	uint64 Cumulative = 0;
+	for (int32 Index = 0; Index < FLatencyHistogram::NumBounds; ++Index)
+	{
+		Cumulative += Histogram.GetBucketCount(Index);
+		Out += FString::Printf(TEXT("%s_bucket{%s%sle=\"%g\"} %llu\n"), Name, Labels, Separator, FLatencyHistogram::BucketBounds[Index], Cumulative);
+	}
+	Cumulative += Histogram.GetBucketCount(FLatencyHistogram::NumBounds);
+	Out += FString::Printf(TEXT("%s_bucket{%s%sle=\"+Inf\"} %llu\n"), Name, Labels, Separator, Cumulative);
+	
+	const FString LabelSet = Labels[0] != TEXT('\0') ? FString::Printf(TEXT("{%s}"), Labels) : FString();
+	Out += FString::Printf(TEXT("%s_sum%s %.9f\n"), Name, *LabelSet, Histogram.GetSumSeconds());
+	Out += FString::Printf(TEXT("%s_count%s %llu\n"), Name, *LabelSet, Cumulative);
+}
+
+void FPythonServerMetrics::WritePrometheusText(FString& Out) const
+{
+	Out += TEXT("# HELP uepython_execute_requests_total Requests received by /execute\n");
+	Out += TEXT("# TYPE uepython_execute_requests_total counter\n");
+	Out += FString::Printf(TEXT("uepython_execute_requests_total %llu\n"), GetNumExecuteRequests());
+	
+	Out += TEXT("# HELP uepython_execute_errors_total Requests to /execute that failed to parse, queue or run\n");
+	Out += TEXT("# TYPE uepython_execute_errors_total counter\n");
+	Out += FString::Printf(TEXT("uepython_execute_errors_total %llu\n"), GetNumExecuteErrors());
+	
+	Out += TEXT("# HELP uepython_stage_seconds Time spent in each stage of the /execute request path\n");
+	Out += TEXT("# TYPE uepython_stage_seconds histogram\n");
+	for (int32 StageIndex = 0; StageIndex < static_cast<int32>(EPythonServerStage::Count); ++StageIndex)
+	{
+		const FString Labels = FString::Printf(TEXT("stage=\"%s\""), LexToString(static_cast<EPythonServerStage>(StageIndex)));
+		WritePrometheusHistogram(Out, TEXT("uepython_stage_seconds"), *Labels, StageHistograms[StageIndex]);
+	}
+	
+	Out += TEXT("# HELP uepython_frame_seconds Duration of the editor frames while the server is running\n");
+	Out += TEXT("# TYPE uepython_frame_seconds histogram\n");
+	WritePrometheusHistogram(Out, TEXT("uepython_frame_seconds"), TEXT(""), FrameHistogram);
+}
@@ -0,0 +1,98 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+/** Stages of the /execute request path that are timed */
+enum class EPythonServerStage : uint8
+{
+	/** Decoding the request body */
+	Parse,
+	/** Waiting in the dispatcher queue */
+	QueueWait,
+	/** Looking up or compiling the code object */
+	Compile,
+	/** Running the code object */
+	Execute,
+	/** Handling captured output, included in Execute */
+	OutputCapture,
+	/** Encoding the response body */
+	Serialize,
+	/** From the request being received to the response being sent */
+	Total,
+	
+	Count
+};
+
+/** Returns the lowercase name used for a stage in metrics */
+const TCHAR* LexToString(EPythonServerStage Stage);
+
+/**
+ * Latency histogram with fixed buckets from 50us to 10s.
+ * Every field is a relaxed atomic, so any thread can record or read without taking a lock. A reader
+ * may see a count that is one sample ahead of the buckets, which is fine for monitoring.
+ */
+class FLatencyHistogram
+{
+public:
+	static constexpr int32 NumBounds = 17;
+	
+	/** Upper bounds of the buckets in seconds, a last implicit bucket holds everything slower */
+	static const double BucketBounds[NumBounds];
+	
+	FLatencyHistogram();
+	
+	void Record(double Seconds);
+	
+	uint64 GetCount() const { return Count.load(std::memory_order_relaxed); }
+	double GetSumSeconds() const { return SumNanoseconds.load(std::memory_order_relaxed) * 1e-9; }
+	
+	/** Gets the number of samples of a bucket, NumBounds being the overflow bucket */
+	uint64 GetBucketCount(int32 Index) const { return Buckets[Index].load(std::memory_order_relaxed); }
+	
+	/** Estimates a quantile by interpolating within the bucket it falls in, in seconds */
+	double GetQuantile(double Quantile) const;
+	
+private:
+	std::atomic<uint64> Buckets[NumBounds + 1];
+	std::atomic<uint64> Count;
+	std::atomic<uint64> SumNanoseconds;
+};
+
+/** Counters and per-stage latency histograms of the server, exported at /metrics */
+class FPythonServerMetrics
+{
+public:
+	FPythonServerMetrics();
+	
+	/** Records the time a request spent in a stage */
+	void RecordStage(EPythonServerStage Stage, double Seconds);
+	
+	const FLatencyHistogram& GetStageHistogram(EPythonServerStage Stage) const { return StageHistograms[static_cast<int32>(Stage)]; }
+	
+	/** Records the duration of an editor frame, to measure how much the server's work costs the editor */
+	void RecordFrame(double Seconds) { FrameHistogram.Record(Seconds); }
+	
+	const FLatencyHistogram& GetFrameHistogram() const { return FrameHistogram; }
+	
+	/** Counts an /execute request, and whether it failed */
+	void CountExecuteRequest(bool bSuccess);
+	
+	uint64 GetNumExecuteRequests() const { return NumExecuteRequests.load(std::memory_order_relaxed); }
+	uint64 GetNumExecuteErrors() const { return NumExecuteErrors.load(std::memory_order_relaxed); }
+	
+	/**
+	 * Writes the counters and histograms in the Prometheus text exposition format
+	 * @param Out Text to append to, so the caller can add gauges it owns
+	 */
+	void WritePrometheusText(FString& Out) const;
+	
+private:
+	FLatencyHistogram StageHistograms[static_cast<int32>(EPythonServerStage::Count)];
+	FLatencyHistogram FrameHistogram;
+	
+	std::atomic<uint64> NumExecuteRequests;
+	std::atomic<uint64> NumExecuteErrors;
+};
@@ -0,0 +1,733 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PythonServerProtocol.h"
+#include "CborReader.h"
+#include "CborWriter.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/JsonReader.h"
+#include "Misc/Compression.h"
+#include "Misc/Base64.h"
+#include "Serialization/JsonSerializer.h"
+#include <atomic>
+
+THIRD_PARTY_INCLUDES_START
+#include "zlib.h"
+THIRD_PARTY_INCLUDES_END
+
+namespace PythonServerProtocol
+{
+	const TCHAR* CborContentType = TEXT("application/cbor");
+	const TCHAR* RequestIdHeader = TEXT("X-Request-Id");
+	
+	EPythonServerPayloadFormat GetRequestFormat(const FHttpServerRequest& Request)
+	{
+		// Header names are looked up case-insensitively by the FString keyed map
+		if (const TArray<FString>* ContentTypes = Request.Headers.Find(TEXT("Content-Type")))
+		{
+			for (const FString& ContentType : *ContentTypes)
+			{
+				if (ContentType.StartsWith(CborContentType))
+				{
+					return EPythonServerPayloadFormat::Cbor;
+				}
+			}
+		}
+		return EPythonServerPayloadFormat::Json;
+	}
+	
+	FString GetRequestId(const FHttpServerRequest& Request)
+	{
+		const TArray<FString>* RequestIds = Request.Headers.Find(RequestIdHeader);
+		if (RequestIds != nullptr && RequestIds->Num() > 0 && !(*RequestIds)[0].IsEmpty())
+		{
+			return (*RequestIds)[0];
+		}
+		
+		static std::atomic<uint64> NextRequestId(1);
+		return FString::Printf(TEXT("#%llu"), NextRequestId.fetch_add(1, std::memory_order_relaxed));
+	}
+	
+	/** Gets an unsigned integer or floating point CBOR value as a double, 0 for any other type */
+	static double GetCborNumber(const FCborContext& Context)
+	{
+		if (Context.MajorType() == ECborCode::Uint)
+		{
+			return static_cast<double>(Context.AsUInt());
+		}
+		if (Context.MajorType() == ECborCode::Prim && Context.AdditionalValue() == ECborCode::Value_8Bytes)
+		{
+			return Context.AsDouble();
+		}
+		if (Context.MajorType() == ECborCode::Prim && Context.AdditionalValue() == ECborCode::Value_4Bytes)
+		{
+			return Context.AsFloat();
+		}
+		return 0.0;
+	}
+	
+	/**
+	 * Gets a CBOR boolean, AsBool checks on the null, undefined and float values that share its major type
+	 * @return False if the value is not true or false
+	 */
+	static bool GetCborBool(const FCborContext& Context, bool& OutValue)
+	{
+		if (Context.MajorType() != ECborCode::Prim || (Context.AdditionalValue() != ECborCode::True && Context.AdditionalValue() != ECborCode::False))
+		{
+			return false;
+		}
+		OutValue = Context.AsBool();
+		return true;
+	}
+	
+	static bool ParseCborExecuteRequest(const TArray<uint8>& Body, FExecuteRequest& OutRequest, FString& OutError)
+	{
+		FMemoryReader Archive(Body);
+		FCborReader Reader(&Archive);
+		
+		FCborContext Context;
+		if (!Reader.ReadNext(Context) || Context.MajorType() != ECborCode::Map)
+		{
+			OutError = TEXT("Invalid CBOR request, expected a map");
+			return false;
+		}
+		
+		bool bHasCode = false;
+		FCborContext KeyContext;
+		while (Reader.ReadNext(KeyContext) && !KeyContext.IsBreak())
+		{
+			FCborContext ValueContext;
+			if (KeyContext.MajorType() != ECborCode::TextString || !Reader.ReadNext(ValueContext))
+			{
+				OutError = TEXT("Invalid CBOR request, expected text keys");
+				return false;
+			}
+			
+			// Keys are compared as UTF-8, only the code value is converted
+			const char* Key = KeyContext.AsCString();
+			if (FCStringAnsi::Strcmp(Key, "code") == 0 && ValueContext.MajorType() == ECborCode::TextString)
+			{
+				OutRequest.Code = ValueContext.AsString();
+				bHasCode = true;
+			}
+			else if (FCStringAnsi::Strcmp(Key, "async") == 0)
+			{
+				if (!GetCborBool(ValueContext, OutRequest.bAsync))
+				{
+					OutError = TEXT("Invalid CBOR request, 'async' must be a boolean");
+					return false;
+				}
+			}
+			else if (FCStringAnsi::Strcmp(Key, "stream") == 0)
+			{
+				if (!GetCborBool(ValueContext, OutRequest.bStream))
+				{
+					OutError = TEXT("Invalid CBOR request, 'stream' must be a boolean");
+					return false;
+				}
+			}
+			else if (FCStringAnsi::Strcmp(Key, "eval") == 0)
+			{
+				if (!GetCborBool(ValueContext, OutRequest.bEval))
+				{
+					OutError = TEXT("Invalid CBOR request, 'eval' must be a boolean");
+					return false;
+				}
+			}
+			else if (FCStringAnsi::Strcmp(Key, "session") == 0 && ValueContext.MajorType() == ECborCode::TextString)
+			{
+				OutRequest.Session = ValueContext.AsString();
+			}
+			else if (FCStringAnsi::Strcmp(Key, "cache_key") == 0 && ValueContext.MajorType() == ECborCode::TextString)
+			{
+				OutRequest.CacheKey = ValueContext.AsString();
+			}
+			else if (FCStringAnsi::Strcmp(Key, "priority") == 0 && ValueContext.MajorType() == ECborCode::TextString)
+			{
+				OutRequest.Priority = ValueContext.AsString();
+			}
+			else if (FCStringAnsi::Strcmp(Key, "cache_ttl") == 0 && !ValueContext.IsContainer())
+			{
+				OutRequest.CacheTtlSeconds = GetCborNumber(ValueContext);
+			}
+			else if (FCStringAnsi::Strcmp(Key, "timeout") == 0 && !ValueContext.IsContainer())
+			{
+				OutRequest.TimeoutSeconds = GetCborNumber(ValueContext);
+			}
+			else if (ValueContext.IsContainer())
+			{
+				Reader.SkipContainer(ValueContext.MajorType());
+			}
+		}
+		
+		if (!bHasCode)
+		{
+			OutError = TEXT("Missing 'code' parameter");
+			return false;
+		}
+		return true;
+	}
+	
+	static bool ParseJsonExecuteRequest(const TArray<uint8>& Body, FExecuteRequest& OutRequest, FString& OutError)
+	{
+		// Read tokens straight from the UTF-8 body instead of widening it and building a DOM
+		FMemoryReader Archive(Body);
+		TSharedRef<TJsonReader<UTF8CHAR>> Reader = TJsonReaderFactory<UTF8CHAR>::Create(&Archive);
+		
+		EJsonNotation Notation;
+		if (!Reader->ReadNext(Notation) || Notation != EJsonNotation::ObjectStart)
+		{
+			OutError = TEXT("Invalid JSON request");
+			return false;
+		}
+		
+		bool bHasCode = false;
+		while (Reader->ReadNext(Notation) && Notation != EJsonNotation::ObjectEnd)
+		{
+			const FString& Identifier = Reader->GetIdentifier();
+			switch (Notation)
+			{
+			case EJsonNotation::String:
+				if (Identifier == TEXT("code"))
+				{
+					OutRequest.Code = Reader->GetValueAsString();
+					bHasCode = true;
+				}
+				else if (Identifier == TEXT("session"))
+				{
+					OutRequest.Session = Reader->GetValueAsString();
+				}
+				else if (Identifier == TEXT("cache_key"))
+				{
+					OutRequest.CacheKey = Reader->GetValueAsString();
+				}
+				else if (Identifier == TEXT("priority"))
+				{
+					OutRequest.Priority = Reader->GetValueAsString();
+				}
+				break;
+			case EJsonNotation::Number:
+				if (Identifier == TEXT("cache_ttl"))
+				{
+					OutRequest.CacheTtlSeconds = Reader->GetValueAsNumber();
+				}
+				else if (Identifier == TEXT("timeout"))
+				{
+					OutRequest.TimeoutSeconds = Reader->GetValueAsNumber();
+				}
+				break;
+			case EJsonNotation::Boolean:
+				if (Identifier == TEXT("async"))
+				{
+					OutRequest.bAsync = Reader->GetValueAsBoolean();
+				}
+				else if (Identifier == TEXT("stream"))
+				{
+					OutRequest.bStream = Reader->GetValueAsBoolean();
+				}
+				else if (Identifier == TEXT("eval"))
+				{
+					OutRequest.bEval = Reader->GetValueAsBoolean();
+				}
+				break;
+			case EJsonNotation::ObjectStart:
+				Reader->SkipObject();
+				break;
+			case EJsonNotation::ArrayStart:
+				Reader->SkipArray();
+				break;
+			case EJsonNotation::Error:
+				OutError = TEXT("Invalid JSON request");
+				return false;
+			default:
+				break;
+			}
+		}
+		
+		if (Notation != EJsonNotation::ObjectEnd)
+		{
+			OutError = TEXT("Invalid JSON request");
+			return false;
+		}
+		
+		if (!bHasCode)
+		{
+			OutError = TEXT("Missing 'code' parameter");
+			return false;
+		}
+		return true;
+	}
+	
+	/** Gets the Content-Encoding of a request, empty when the body is not encoded */
+	static FString GetContentEncoding(const FHttpServerRequest& Request)
+	{
+		const TArray<FString>* Encodings = Request.Headers.Find(TEXT("Content-Encoding"));
+		if (Encodings == nullptr || Encodings->Num() == 0 || (*Encodings)[0].TrimStartAndEnd().Equals(TEXT("identity"), ESearchCase::IgnoreCase))
+		{
+			return FString();
+		}
+		return (*Encodings)[0].TrimStartAndEnd().ToLower();
+	}
+	
+	bool ParseExecuteRequest(const FHttpServerRequest& Request, EPythonServerPayloadFormat Format, FExecuteRequest& OutRequest, FString& OutError)
+	{
+		// Compressed bodies are inflated into a buffer of their own, plain bodies are read in place
+		const TArray<uint8>* Body = &Request.Body;
+		TArray<uint8> InflatedBody;
+		const FString ContentEncoding = GetContentEncoding(Request);
+		if (ContentEncoding == TEXT("gzip"))
+		{
+			if (!GunzipBody(Request.Body, InflatedBody, OutError))
+			{
+				return false;
+			}
+			Body = &InflatedBody;
+		}
+		else if (!ContentEncoding.IsEmpty())
+		{
+			OutError = FString::Printf(TEXT("Unsupported Content-Encoding '%s', only gzip is supported"), *ContentEncoding);
+			return false;
+		}
+		
+		return Format == EPythonServerPayloadFormat::Cbor
+			? ParseCborExecuteRequest(*Body, OutRequest, OutError)
+			: ParseJsonExecuteRequest(*Body, OutRequest, OutError);
+	}
+	
+	bool GetMultipartBoundary(const FHttpServerRequest& Request, FString& OutBoundary)
+	{
+		const TArray<FString>* ContentTypes = Request.Headers.Find(TEXT("Content-Type"));
+		if (ContentTypes == nullptr)
+		{
+			return false;
+		}
+		
+		for (const FString& ContentType : *ContentTypes)
+		{
+			if (!ContentType.StartsWith(TEXT("multipart/form-data")))
+			{
+				continue;
+			}
+			
+			const int32 BoundaryIndex = ContentType.Find(TEXT("boundary="));
+			if (BoundaryIndex == INDEX_NONE)
+			{
+				return false;
+			}
+			
+			// The boundary runs to the next parameter and may be quoted
+			OutBoundary = ContentType.Mid(BoundaryIndex + 9);
+			int32 SeparatorIndex = INDEX_NONE;
+			if (OutBoundary.FindChar(TEXT(';'), SeparatorIndex))
+			{
+				OutBoundary.LeftInline(SeparatorIndex);
+			}
+			OutBoundary.TrimStartAndEndInline();
+			OutBoundary.TrimQuotesInline();
+			return !OutBoundary.IsEmpty();
+		}
+		return false;
+	}
+	
+	/** Finds Needle in Body at or after StartIndex */
+	static int32 FindBytes(const TArray<uint8>& Body, int32 StartIndex, const ANSICHAR* Needle, int32 NeedleLength)
+	{
+		const int32 LastIndex = Body.Num() - NeedleLength;
+		for (int32 Index = StartIndex; Index <= LastIndex; ++Index)
+		{
+			if (Body[Index] == static_cast<uint8>(Needle[0]) && FMemory::Memcmp(Body.GetData() + Index, Needle, NeedleLength) == 0)
+			{
+				return Index;
+			}
+		}
+		return INDEX_NONE;
+	}
+	
+	bool FindMultipartFile(const TArray<uint8>& Body, const FString& Boundary, FString& OutFileName, int32& OutDataOffset, int32& OutDataLength)
+	{
+		// Parts are separated by CRLF "--" boundary, the first delimiter has no leading CRLF
+		const FTCHARToUTF8 Delimiter(*(TEXT("\r\n--") + Boundary));
+		const ANSICHAR* HeaderEndMarker = "\r\n\r\n";
+		
+		int32 PartIndex = FindBytes(Body, 0, Delimiter.Get() + 2, Delimiter.Length() - 2);
+		if (PartIndex == INDEX_NONE)
+		{
+			return false;
+		}
+		PartIndex += Delimiter.Length() - 2;
+		
+		while (PartIndex + 2 <= Body.Num())
+		{
+			// A delimiter followed by "--" closes the body
+			if (Body[PartIndex] == '-' && Body[PartIndex + 1] == '-')
+			{
+				break;
+			}
+			
+			const int32 HeaderStart = PartIndex + 2;
+			const int32 HeaderEnd = FindBytes(Body, HeaderStart, HeaderEndMarker, 4);
+			if (HeaderEnd == INDEX_NONE)
+			{
+				return false;
+			}
+			
+			const int32 DataStart = HeaderEnd + 4;
+			const int32 DataEnd = FindBytes(Body, DataStart, Delimiter.Get(), Delimiter.Length());
+			if (DataEnd == INDEX_NONE)
+			{
+				return false;
+			}
+			
+			// Only the small header block is converted, the file bytes are left where they are
+			FUTF8ToTCHAR HeaderConverter(reinterpret_cast<const ANSICHAR*>(Body.GetData() + HeaderStart), HeaderEnd - HeaderStart);
+			const FString Headers(HeaderConverter.Length(), HeaderConverter.Get());
+			
+			const int32 FileNameIndex = Headers.Find(TEXT("filename=\""));
+			if (FileNameIndex != INDEX_NONE)
+			{
+				const int32 FileNameStart = FileNameIndex + 10;
+				const int32 FileNameEnd = Headers.Find(TEXT("\""), ESearchCase::CaseSensitive, ESearchDir::FromStart, FileNameStart);
+				if (FileNameEnd == INDEX_NONE)
+				{
+					return false;
+				}
+				
+				OutFileName = Headers.Mid(FileNameStart, FileNameEnd - FileNameStart);
+				OutDataOffset = DataStart;
+				OutDataLength = DataEnd - DataStart;
+				return true;
+			}
+			
+			PartIndex = DataEnd + Delimiter.Length();
+		}
+		return false;
+	}
+	
+	bool AcceptsMultipart(const FHttpServerRequest& Request)
+	{
+		const TArray<FString>* Accepts = Request.Headers.Find(TEXT("Accept"));
+		if (Accepts == nullptr)
+		{
+			return false;
+		}
+		
+		for (const FString& Value : *Accepts)
+		{
+			if (Value.Contains(TEXT("multipart/mixed")))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+	
+	/** Appends the UTF-8 bytes of an ASCII string */
+	static void AppendAscii(TArray<uint8>& Body, const FString& Text)
+	{
+		const FTCHARToUTF8 Converter(*Text);
+		Body.Append(reinterpret_cast<const uint8*>(Converter.Get()), Converter.Length());
+	}
+	
+	TUniquePtr<FHttpServerResponse> MakeMultipartResponse(TUniquePtr<FHttpServerResponse> Response, const TArray<TArray<uint8>>& Attachments)
+	{
+		const FString Boundary = FString::Printf(TEXT("uepython-%s"), *FGuid::NewGuid().ToString(EGuidFormats::Digits));
+		
+		int32 NumBodyBytes = Response->Body.Num() + 256;
+		for (const TArray<uint8>& Attachment : Attachments)
+		{
+			NumBodyBytes += Attachment.Num() + 128;
+		}
+		
+		TArray<uint8> Body;
+		Body.Reserve(NumBodyBytes);
+		AppendAscii(Body, FString::Printf(TEXT("--%s\r\nContent-Type: application/json\r\n\r\n"), *Boundary));
+		Body.Append(Response->Body);
+		for (int32 Index = 0; Index < Attachments.Num(); ++Index)
+		{
+			AppendAscii(Body, FString::Printf(TEXT("\r\n--%s\r\nContent-Type: application/octet-stream\r\nContent-ID: <%d>\r\n\r\n"), *Boundary, Index));
+			Body.Append(Attachments[Index]);
+		}
+		AppendAscii(Body, FString::Printf(TEXT("\r\n--%s--\r\n"), *Boundary));
+		
+		return FHttpServerResponse::Create(MoveTemp(Body), FString::Printf(TEXT("multipart/mixed; boundary=%s"), *Boundary));
+	}
+	
+	const int32 MinCompressedResponseBytes = 8 * 1024;
+	
+	bool AcceptsGzip(const FHttpServerRequest& Request)
+	{
+		const TArray<FString>* Encodings = Request.Headers.Find(TEXT("Accept-Encoding"));
+		if (Encodings == nullptr)
+		{
+			return false;
+		}
+		
+		// Values look like "gzip, deflate, br" or "gzip;q=0.5, *;q=0", a gzip with q=0 is a refusal
+		for (const FString& Value : *Encodings)
+		{
+			TArray<FString> Codings;
+			Value.ParseIntoArray(Codings, TEXT(","));
+			for (const FString& Coding : Codings)
+			{
+				FString Name;
+				FString Params;
+				if (!Coding.Split(TEXT(";"), &Name, &Params))
+				{
+					Name = Coding;
+				}
+				
+				if (Name.TrimStartAndEnd().Equals(TEXT("gzip"), ESearchCase::IgnoreCase))
+				{
+					Params.TrimStartAndEndInline();
+					return !Params.StartsWith(TEXT("q="), ESearchCase::IgnoreCase) || FCString::Atof(*Params + 2) > 0.0f;
+				}
+			}
+		}
+		return false;
+	}
+	
+	bool GunzipBody(const TArray<uint8>& Compressed, TArray<uint8>& OutBody, FString& OutError)
+	{
+		static constexpr int32 MaxInflatedBytes = 256 * 1024 * 1024;
+		static constexpr int32 InflateChunkBytes = 256 * 1024;
+		if (Compressed.Num() < 18 || Compressed[0] != 0x1f || Compressed[1] != 0x8b)
+		{
+			OutError = TEXT("Invalid gzip request body");
+			return false;
+		}
+		
+		// The size in the gzip trailer is set by the client, so the body is inflated in chunks and
+		// only grows as output is produced, rather than being allocated up front from that size
+		z_stream Stream = {};
+		Stream.next_in = const_cast<Bytef*>(Compressed.GetData());
+		Stream.avail_in = Compressed.Num();
+		if (inflateInit2(&Stream, 16 + MAX_WBITS) != Z_OK)
+		{
+			OutError = TEXT("Invalid gzip request body");
+			return false;
+		}
+		
+		OutBody.Reset();
+		int Status = Z_OK;
+		while (Status == Z_OK)
+		{
+			if (OutBody.Num() >= MaxInflatedBytes)
+			{
+				inflateEnd(&Stream);
+				OutError = TEXT("Compressed request body is too large");
+				return false;
+			}
+			
+			const int32 NumChunkBytes = FMath::Min(InflateChunkBytes, MaxInflatedBytes - OutBody.Num());
+			const int32 ChunkStart = OutBody.AddUninitialized(NumChunkBytes);
+			Stream.next_out = OutBody.GetData() + ChunkStart;
+			Stream.avail_out = NumChunkBytes;
+			Status = inflate(&Stream, Z_NO_FLUSH);
+			OutBody.SetNum(ChunkStart + NumChunkBytes - Stream.avail_out, /* bAllowShrinking */ false);
+		}
+		inflateEnd(&Stream);
+		
+		// Anything but the end of the stream is corrupt or truncated input
+		if (Status != Z_STREAM_END)
+		{
+			OutError = TEXT("Invalid gzip request body");
+			return false;
+		}
+		return true;
+	}
+	
+	bool GzipResponse(FHttpServerResponse& Response)
+	{
+		const int32 UncompressedBytes = Response.Body.Num();
+		if (UncompressedBytes < MinCompressedResponseBytes)
+		{
+			return false;
+		}
+		
+		// Favour speed, the point is to cut transfer time, not to reach the smallest body
+		int32 CompressedBytes = FCompression::CompressMemoryBound(NAME_Gzip, UncompressedBytes);
+		TArray<uint8> Compressed;
+		Compressed.SetNumUninitialized(CompressedBytes);
+		if (!FCompression::CompressMemory(NAME_Gzip, Compressed.GetData(), CompressedBytes, Response.Body.GetData(), UncompressedBytes, COMPRESS_BiasSpeed)
+			|| CompressedBytes >= UncompressedBytes)
+		{
+			return false;
+		}
+		
+		Compressed.SetNum(CompressedBytes, /* bAllowShrinking */ false);
+		Response.Body = MoveTemp(Compressed);
+		Response.Headers.Add(TEXT("Content-Encoding"), { TEXT("gzip") });
+		Response.Headers.Add(TEXT("Vary"), { TEXT("Accept-Encoding") });
+		return true;
+	}
+}
+
+FPythonServerResponseWriter::FPythonServerResponseWriter(EPythonServerPayloadFormat InFormat, int32 ReserveBytes)
+	: Format(InFormat)
+	, BodyArchive(Body)
+{
+	Body.Reserve(ReserveBytes);
+	
+	if (Format == EPythonServerPayloadFormat::Cbor)
+	{
+		CborWriter = MakeUnique<FCborWriter>(&BodyArchive);
+		CborWriter->WriteContainerStart(ECborCode::Map, /* NbItem, indefinite */ -1);
+	}
+	else
+	{
+		JsonWriter = TJsonWriterFactory<UTF8CHAR, TCondensedJsonPrintPolicy<UTF8CHAR>>::Create(&BodyArchive);
+		JsonWriter->WriteObjectStart();
+	}
+}
+
+FPythonServerResponseWriter::~FPythonServerResponseWriter()
+{
+}
+
+void FPythonServerResponseWriter::WriteString(const TCHAR* Name, const FString& Value)
+{
+	if (CborWriter.IsValid())
+	{
+		CborWriter->WriteValue(FString(Name));
+		CborWriter->WriteValue(Value);
+	}
+	else
+	{
+		JsonWriter->WriteValue(Name, Value);
+	}
+}
+
+void FPythonServerResponseWriter::WriteBool(const TCHAR* Name, bool bValue)
+{
+	if (CborWriter.IsValid())
+	{
+		CborWriter->WriteValue(FString(Name));
+		CborWriter->WriteValue(bValue);
+	}
+	else
+	{
+		JsonWriter->WriteValue(Name, bValue);
+	}
+}
+
+void FPythonServerResponseWriter::WriteNumber(const TCHAR* Name, double Value)
+{
+	if (CborWriter.IsValid())
+	{
+		CborWriter->WriteValue(FString(Name));
+		CborWriter->WriteValue(Value);
+	}
+	else
+	{
+		JsonWriter->WriteValue(Name, Value);
+	}
+}
+
+/** Writes a JSON value as CBOR, integral numbers as integers */
+static void WriteCborValue(FCborWriter& Writer, const TSharedPtr<FJsonValue>& Value)
+{
+	switch (Value.IsValid() ? Value->Type : EJson::Null)
+	{
+	case EJson::String:
+		Writer.WriteValue(Value->AsString());
+		break;
+	case EJson::Number:
+	{
+		const double Number = Value->AsNumber();
+		if (FMath::RoundToDouble(Number) == Number && FMath::Abs(Number) < 9007199254740992.0)
+		{
+			Writer.WriteValue(static_cast<int64>(Number));
+		}
+		else
+		{
+			Writer.WriteValue(Number);
+		}
+		break;
+	}
+	case EJson::Boolean:
+		Writer.WriteValue(Value->AsBool());
+		break;
+	case EJson::Array:
+	{
+		const TArray<TSharedPtr<FJsonValue>>& Items = Value->AsArray();
+		Writer.WriteContainerStart(ECborCode::Array, Items.Num());
+		for (const TSharedPtr<FJsonValue>& Item : Items)
+		{
+			WriteCborValue(Writer, Item);
+		}
+		break;
+	}
+	case EJson::Object:
+	{
+		const TMap<FString, TSharedPtr<FJsonValue>>& Fields = Value->AsObject()->Values;
+		Writer.WriteContainerStart(ECborCode::Map, Fields.Num());
+		for (const TPair<FString, TSharedPtr<FJsonValue>>& Field : Fields)
+		{
+			Writer.WriteValue(Field.Key);
+			WriteCborValue(Writer, Field.Value);
+		}
+		break;
+	}
+	default:
+		Writer.WriteNull();
+		break;
+	}
+}
+
+void FPythonServerResponseWriter::WriteValue(const TCHAR* Name, const TSharedPtr<FJsonValue>& Value)
+{
+	if (CborWriter.IsValid())
+	{
+		CborWriter->WriteValue(FString(Name));
+		WriteCborValue(*CborWriter, Value);
+	}
+	else
+	{
+		TSharedPtr<FJsonValue> ValueOrNull = Value;
+		if (!ValueOrNull.IsValid())
+		{
+			ValueOrNull = MakeShared<FJsonValueNull>();
+		}
+		FJsonSerializer::Serialize(ValueOrNull, Name, JsonWriter.ToSharedRef(), /* bCloseWriter */ false);
+	}
+}
+
+void FPythonServerResponseWriter::WriteBinaryArray(const TCHAR* Name, const TArray<TArray<uint8>>& Values)
+{
+	if (CborWriter.IsValid())
+	{
+		CborWriter->WriteValue(FString(Name));
+		CborWriter->WriteContainerStart(ECborCode::Array, Values.Num());
+		for (const TArray<uint8>& Value : Values)
+		{
+			CborWriter->WriteValue(reinterpret_cast<const char*>(Value.GetData()), Value.Num());
+		}
+	}
+	else
+	{
+		JsonWriter->WriteArrayStart(Name);
+		for (const TArray<uint8>& Value : Values)
+		{
+			JsonWriter->WriteValue(FBase64::Encode(Value));
+		}
+		JsonWriter->WriteArrayEnd();
+	}
+}
+
+TUniquePtr<FHttpServerResponse> FPythonServerResponseWriter::Finish()
+{
+	if (CborWriter.IsValid())
+	{
+		CborWriter->WriteContainerEnd();
+		CborWriter.Reset();
+	}
+	else
+	{
+		JsonWriter->WriteObjectEnd();
+		JsonWriter->Close();
+		JsonWriter.Reset();
+	}
+	
+	// The body is moved into the response, never copied or re-encoded
+	const TCHAR* ContentType = Format == EPythonServerPayloadFormat::Cbor ? PythonServerProtocol::CborContentType : TEXT("application/json");
+	return FHttpServerResponse::Create(MoveTemp(Body), ContentType);
+}
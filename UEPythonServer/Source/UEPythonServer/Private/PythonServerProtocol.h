@@ -0,0 +1,164 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HttpServerRequest.h"
+#include "HttpServerResponse.h"
+#include "Serialization/MemoryWriter.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonWriter.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+
+class FCborWriter;
+
+/** Encoding of a request or response body */
+enum class EPythonServerPayloadFormat : uint8
+{
+	Json,
+	Cbor
+};
+
+namespace PythonServerProtocol
+{
+	/** Content type selecting CBOR payloads */
+	extern const TCHAR* CborContentType;
+	
+	/** Gets the format of the request body from its Content-Type, JSON unless CBOR is requested */
+	EPythonServerPayloadFormat GetRequestFormat(const FHttpServerRequest& Request);
+	
+	/** Header a client can set to tag its request, the WebSocket transport sets it to the message id */
+	extern const TCHAR* RequestIdHeader;
+	
+	/**
+	 * Gets the id that tags a request in traces and in the jobs it queues
+	 * @return The X-Request-Id header if the client set one, otherwise a sequence number unique to this process
+	 */
+	FString GetRequestId(const FHttpServerRequest& Request);
+	
+	/** Fields of an /execute request */
+	struct FExecuteRequest
+	{
+		FString Code;
+		bool bAsync = false;
+		bool bStream = false;
+		
+		/** Whether the response carries the value of the code's final expression or of __result__ */
+		bool bEval = false;
+		
+		/** Id of the session to run in, empty to run in __main__ */
+		FString Session;
+		
+		/** Marks the request idempotent, identical requests with the same key share one run. Empty to always run */
+		FString CacheKey;
+		
+		/** Time the result of a cache-keyed request is reused for, 0 to only share runs in flight */
+		double CacheTtlSeconds = 0.0;
+		
+		/** Lane to queue the code in, empty for normal */
+		FString Priority;
+		
+		/** Time the code may run for, 0 for the server's default */
+		double TimeoutSeconds = 0.0;
+	};
+	
+	/**
+	 * Parses an /execute request body. Both formats are decoded straight from the request bytes
+	 * with streaming readers, only the code string itself is converted. A body sent with
+	 * Content-Encoding: gzip is decompressed first.
+	 * @return False with OutError set if the body is invalid or has no code
+	 */
+	bool ParseExecuteRequest(const FHttpServerRequest& Request, EPythonServerPayloadFormat Format, FExecuteRequest& OutRequest, FString& OutError);
+	
+	/**
+	 * Gets the boundary of a multipart/form-data request
+	 * @return False if the request is not multipart
+	 */
+	bool GetMultipartBoundary(const FHttpServerRequest& Request, FString& OutBoundary);
+	
+	/**
+	 * Finds the first file part of a multipart/form-data body. The file is located in place,
+	 * so the caller copies its bytes once, straight from the request body.
+	 * @param Body The request body
+	 * @param Boundary The boundary from GetMultipartBoundary
+	 * @param OutFileName The filename of the part's Content-Disposition
+	 * @param OutDataOffset Offset of the file's first byte in Body
+	 * @param OutDataLength Length of the file in bytes
+	 * @return False if the body is malformed or has no file part
+	 */
+	bool FindMultipartFile(const TArray<uint8>& Body, const FString& Boundary, FString& OutFileName, int32& OutDataOffset, int32& OutDataLength);
+	
+	/** Whether the request's Accept header allows a multipart/mixed response */
+	bool AcceptsMultipart(const FHttpServerRequest& Request);
+	
+	/**
+	 * Wraps a JSON response in a multipart/mixed body, followed by one application/octet-stream
+	 * part per attachment, in order. Attachments are sent as they are, without base64.
+	 * @param Response The response to wrap, its body becomes the first part
+	 * @param Attachments The binary parts
+	 * @return The multipart response
+	 */
+	TUniquePtr<FHttpServerResponse> MakeMultipartResponse(TUniquePtr<FHttpServerResponse> Response, const TArray<TArray<uint8>>& Attachments);
+	
+	/** Responses smaller than this are sent uncompressed, compressing them saves less than it costs */
+	extern const int32 MinCompressedResponseBytes;
+	
+	/** Whether the request's Accept-Encoding allows a gzip response */
+	bool AcceptsGzip(const FHttpServerRequest& Request);
+	
+	/**
+	 * Decompresses a gzip body
+	 * @param Compressed The gzip stream
+	 * @param OutBody The decompressed bytes
+	 * @return False with OutError set if the stream is invalid or decompresses to more than 256 MB
+	 */
+	bool GunzipBody(const TArray<uint8>& Compressed, TArray<uint8>& OutBody, FString& OutError);
+	
+	/**
+	 * Compresses a response body with gzip and sets its Content-Encoding. The body is left as is
+	 * if it is under MinCompressedResponseBytes or does not get smaller.
+	 * @return Whether the body was compressed
+	 */
+	bool GzipResponse(FHttpServerResponse& Response);
+}
+
+/**
+ * Writes a flat response object field by field in JSON or CBOR, without building a DOM first.
+ * Both formats are encoded straight into the response body bytes, JSON as UTF-8.
+ */
+class FPythonServerResponseWriter
+{
+public:
+	/**
+	 * @param InFormat The encoding of the response
+	 * @param ReserveBytes Expected size of the body, so large results are written without reallocating
+	 */
+	explicit FPythonServerResponseWriter(EPythonServerPayloadFormat InFormat, int32 ReserveBytes = 256);
+	~FPythonServerResponseWriter();
+	
+	void WriteString(const TCHAR* Name, const FString& Value);
+	void WriteBool(const TCHAR* Name, bool bValue);
+	void WriteNumber(const TCHAR* Name, double Value);
+	
+	/** Writes a JSON value tree, in CBOR as the equivalent CBOR items */
+	void WriteValue(const TCHAR* Name, const TSharedPtr<FJsonValue>& Value);
+	
+	/** Writes binary data as an array of byte strings in CBOR, or of base64 strings in JSON */
+	void WriteBinaryArray(const TCHAR* Name, const TArray<TArray<uint8>>& Values);
+	
+	/** Closes the object and creates the response, the writer must not be used afterwards */
+	TUniquePtr<FHttpServerResponse> Finish();
+	
+private:
+	using FUtf8JsonWriter = TJsonWriter<UTF8CHAR, TCondensedJsonPrintPolicy<UTF8CHAR>>;
+	
+	EPythonServerPayloadFormat Format;
+	
+	/** The encoded body, moved into the response by Finish */
+	TArray<uint8> Body;
+	FMemoryWriter BodyArchive;
+	
+	/** Only the writer of the chosen format is created */
+	TUniquePtr<FCborWriter> CborWriter;
+	TSharedPtr<FUtf8JsonWriter> JsonWriter;
+};
@@ -0,0 +1,5 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PythonServerTrace.h"
+
+UE_TRACE_CHANNEL_DEFINE(PythonServerChannel)
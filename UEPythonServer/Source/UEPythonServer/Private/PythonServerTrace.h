@@ -0,0 +1,39 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/MiscTrace.h"
+
+/**
+ * Unreal Insights channel of the Python server's spans. Spans are recorded when both this channel and the
+ * cpu channel are enabled, for example with -trace=cpu,PythonServer or Trace.Enable PythonServer.
+ */
+UE_TRACE_CHANNEL_EXTERN(PythonServerChannel)
+
+/** Opens a span with a fixed name on the Python server channel */
+#define PYTHONSERVER_TRACE_SCOPE(Name) \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR(Name, PythonServerChannel)
+
+/**
+ * Opens a span with a formatted name. Insights registers a timer per distinct name, so only format in
+ * names from a small fixed set, such as operation names, and mark ids with PYTHONSERVER_TRACE_BOOKMARK.
+ * The name is only formatted while tracing
+ */
+#define PYTHONSERVER_TRACE_SCOPE_TEXT(Format, ...) \
+	TRACE_CPUPROFILER_EVENT_SCOPE_TEXT_ON_CHANNEL(UE_TRACE_CHANNELEXPR_IS_ENABLED(CpuChannel | PythonServerChannel) ? *FString::Printf(Format, ##__VA_ARGS__) : TEXT("PythonServer"), PythonServerChannel)
+
+/**
+ * Adds a bookmark on the Python server channel, such as a request id at the start of its span. Bookmarks
+ * share one spec per call site, so unlike span names, ids formatted into them do not grow the timer table
+ */
+#define PYTHONSERVER_TRACE_BOOKMARK(Format, ...) \
+	do \
+	{ \
+		if (UE_TRACE_CHANNELEXPR_IS_ENABLED(CpuChannel | PythonServerChannel)) \
+		{ \
+			TRACE_BOOKMARK(Format, ##__VA_ARGS__); \
+		} \
+	} while (0)
@@ -0,0 +1,102 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PythonSessionManager.h"
+#include "IncludePython.h"
+#include "HAL/PlatformTime.h"
+
+FPythonSessionManager::FPythonSessionManager(int32 InMaxSessions, double InIdleTimeoutSeconds)
+	: MaxSessions(FMath::Max(InMaxSessions, 1))
+	, IdleTimeoutSeconds(FMath::Max(InIdleTimeoutSeconds, 1.0))
+{
+}
+
+FPythonSessionManager::~FPythonSessionManager()
+{
+	// Owners empty the sessions with the GIL held, this only catches misuse
+	check(Sessions.Num() == 0);
+}
+
+FGuid FPythonSessionManager::Create(const FString& Name)
+{
+	// Make room by evicting idle sessions before refusing a new one
+	if (Sessions.Num() >= MaxSessions && EvictIdle() == 0)
+	{
+		return FGuid();
+	}
+	
+	FPyObjectPtr Globals = FPyObjectPtr::StealReference(PyDict_New());
+	if (!Globals)
+	{
+		return FGuid();
+	}
+	
+	// Run as __main__ so 'if __name__ == "__main__"' blocks behave as they do for unscoped code
+	PyDict_SetItemString(Globals.Get(), "__builtins__", PyEval_GetBuiltins());
+	PyDict_SetItemString(Globals.Get(), "__name__", FPyObjectPtr::StealReference(PyUnicode_FromString("__main__")).Get());
+	
+	const FGuid Id = FGuid::NewGuid();
+	FSession& Session = Sessions.Add(Id);
+	Session.Name = Name;
+	Session.Globals = MoveTemp(Globals);
+	Session.LastUsedTime = FPlatformTime::Seconds();
+	return Id;
+}
+
+PyObject* FPythonSessionManager::Use(const FGuid& Id)
+{
+	FSession* Session = Sessions.Find(Id);
+	if (Session == nullptr)
+	{
+		return nullptr;
+	}
+	
+	Session->LastUsedTime = FPlatformTime::Seconds();
+	++Session->NumRuns;
+	return Session->Globals.Get();
+}
+
+bool FPythonSessionManager::Remove(const FGuid& Id)
+{
+	return Sessions.Remove(Id) > 0;
+}
+
+TArray<FPythonSessionInfo> FPythonSessionManager::GetSessions() const
+{
+	const double Now = FPlatformTime::Seconds();
+	
+	TArray<FPythonSessionInfo> Infos;
+	Infos.Reserve(Sessions.Num());
+	for (const TPair<FGuid, FSession>& Pair : Sessions)
+	{
+		FPythonSessionInfo& Info = Infos.AddDefaulted_GetRef();
+		Info.Id = Pair.Key;
+		Info.Name = Pair.Value.Name;
+		Info.IdleSeconds = Now - Pair.Value.LastUsedTime;
+		Info.NumGlobals = static_cast<int32>(PyDict_Size(Pair.Value.Globals.Get()));
+		Info.NumRuns = Pair.Value.NumRuns;
+	}
+	
+	Infos.Sort([](const FPythonSessionInfo& A, const FPythonSessionInfo& B) { return A.IdleSeconds < B.IdleSeconds; });
+	return Infos;
+}
+
+int32 FPythonSessionManager::EvictIdle()
+{
+	const double Deadline = FPlatformTime::Seconds() - IdleTimeoutSeconds;
+	
+	int32 NumEvicted = 0;
+	for (TMap<FGuid, FSession>::TIterator It(Sessions); It; ++It)
+	{
+		if (It.Value().LastUsedTime < Deadline)
+		{
+			It.RemoveCurrent();
+			++NumEvicted;
+		}
+	}
+	return NumEvicted;
+}
+
+void FPythonSessionManager::Empty()
+{
+	Sessions.Empty();
+}
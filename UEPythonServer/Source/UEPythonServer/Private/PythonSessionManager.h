@@ -0,0 +1,92 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PyPtr.h"
+
+/** Description of a session for listings */
+struct FPythonSessionInfo
+{
+	FGuid Id;
+	
+	/** Name given by the client, for display only */
+	FString Name;
+	
+	/** Time since the session last ran code, in seconds */
+	double IdleSeconds = 0.0;
+	
+	/** Number of names defined in the session's globals */
+	int32 NumGlobals = 0;
+	
+	/** Number of runs in the session */
+	int32 NumRuns = 0;
+};
+
+/**
+ * Persistent execution contexts created through /sessions. Each session has its own globals dict,
+ * so clients keep imports and state across calls without seeing each other's names in __main__.
+ * Sessions unused for longer than the idle timeout are evicted.
+ * Every method must be called with the GIL held.
+ */
+class FPythonSessionManager
+{
+public:
+	/**
+	 * @param InMaxSessions Maximum number of sessions alive at once
+	 * @param InIdleTimeoutSeconds Time after which an unused session is evicted
+	 */
+	FPythonSessionManager(int32 InMaxSessions = 64, double InIdleTimeoutSeconds = 1800.0);
+	~FPythonSessionManager();
+	
+	/**
+	 * Creates a session with fresh globals
+	 * @param Name Name of the session for display
+	 * @return The id of the session, invalid if the maximum number of sessions is alive
+	 */
+	FGuid Create(const FString& Name);
+	
+	/**
+	 * Gets the globals of a session to run code in, and marks the session as used
+	 * @return A borrowed reference to the globals dict, or null if the session is unknown or was evicted
+	 */
+	PyObject* Use(const FGuid& Id);
+	
+	/**
+	 * Drops a session and its globals
+	 * @return False if the session is unknown
+	 */
+	bool Remove(const FGuid& Id);
+	
+	/** Gets a description of every session, most recently used first */
+	TArray<FPythonSessionInfo> GetSessions() const;
+	
+	/** Number of sessions alive */
+	int32 GetNum() const { return Sessions.Num(); }
+	
+	int32 GetMaxSessions() const { return MaxSessions; }
+	double GetIdleTimeoutSeconds() const { return IdleTimeoutSeconds; }
+	
+	/**
+	 * Evicts the sessions unused for longer than the idle timeout
+	 * @return Number of sessions evicted
+	 */
+	int32 EvictIdle();
+	
+	/** Drops every session */
+	void Empty();
+	
+private:
+	struct FSession
+	{
+		FString Name;
+		FPyObjectPtr Globals;
+		double LastUsedTime = 0.0;
+		int32 NumRuns = 0;
+	};
+	
+	int32 MaxSessions;
+	double IdleTimeoutSeconds;
+	
+	TMap<FGuid, FSession> Sessions;
+};
@@ -0,0 +1,396 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PythonStatusListener.h"
+#include "PythonServerTrace.h"
+#include "Common/TcpSocketBuilder.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "Misc/QueuedThreadPool.h"
+#include "Misc/ScopeLock.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace UEPythonServer
+{
+	/** Requests larger than this are refused, the listener only serves bodiless requests */
+	static constexpr int32 MaxStatusRequestBytes = 8 * 1024;
+	
+	/** Time a client has to send its request before the connection is dropped */
+	static constexpr double StatusRequestTimeoutSeconds = 2.0;
+	
+	static void CloseSocket(FSocket* Socket)
+	{
+		Socket->Close();
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+	}
+	
+	/** Sends the whole buffer, Send may write only part of it */
+	static bool SendAll(FSocket* Socket, const uint8* Data, int32 Size)
+	{
+		while (Size > 0)
+		{
+			int32 BytesSent = 0;
+			if (!Socket->Send(Data, Size, BytesSent) || BytesSent <= 0)
+			{
+				return false;
+			}
+			Data += BytesSent;
+			Size -= BytesSent;
+		}
+		return true;
+	}
+	
+	static void SendStatusResponse(FSocket* Socket, const TCHAR* Status, const FString& ContentType, const TArray<uint8>& Body, const FString& ExtraHeaders = FString())
+	{
+		const FString Header = FString::Printf(
+			TEXT("HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %d\r\nCache-Control: no-store\r\n%sConnection: close\r\n\r\n"),
+			Status, *ContentType, Body.Num(), *ExtraHeaders);
+		
+		FTCHARToUTF8 HeaderConverter(*Header);
+		if (SendAll(Socket, reinterpret_cast<const uint8*>(HeaderConverter.Get()), HeaderConverter.Length()))
+		{
+			SendAll(Socket, Body.GetData(), Body.Num());
+		}
+	}
+	
+	static void SendStatusError(FSocket* Socket, const TCHAR* Status, const TCHAR* Message)
+	{
+		const FString ErrorBody = FString::Printf(TEXT("{\"status\":\"error\",\"message\":\"%s\"}"), Message);
+		FTCHARToUTF8 Converter(*ErrorBody);
+		SendStatusResponse(Socket, Status, TEXT("application/json"), TArray<uint8>(reinterpret_cast<const uint8*>(Converter.Get()), Converter.Length()));
+	}
+}
+
+/** Serves one accepted connection on the worker pool, and closes it if the pool shuts down first */
+class FStatusConnectionWork : public IQueuedWork
+{
+public:
+	FStatusConnectionWork(FPythonStatusListener& InListener, FSocket* InSocket)
+		: Listener(InListener)
+		, Socket(InSocket)
+	{
+	}
+	
+	virtual void DoThreadedWork() override
+	{
+		Listener.ServeConnection(Socket);
+		delete this;
+	}
+	
+	virtual void Abandon() override
+	{
+		UEPythonServer::CloseSocket(Socket);
+		delete this;
+	}
+	
+private:
+	FPythonStatusListener& Listener;
+	FSocket* Socket;
+};
+
+/**
+ * Accepts connections and hands them to the worker pool. FTcpListener starts accepting in its
+ * constructor, before a delegate can be bound, this thread only starts once the listener is set up.
+ */
+class FStatusAcceptRunnable : public FRunnable
+{
+public:
+	explicit FStatusAcceptRunnable(FPythonStatusListener& InListener)
+		: Listener(InListener)
+		, bStopping(false)
+	{
+	}
+	
+	virtual uint32 Run() override
+	{
+		while (!bStopping.load())
+		{
+			bool bHasPendingConnection = false;
+			if (!Listener.ListenSocket->WaitForPendingConnection(bHasPendingConnection, FTimespan::FromMilliseconds(100)))
+			{
+				// Do not spin on a socket in an error state
+				FPlatformProcess::Sleep(0.1f);
+				continue;
+			}
+			if (!bHasPendingConnection)
+			{
+				continue;
+			}
+			
+			FSocket* Socket = Listener.ListenSocket->Accept(TEXT("PythonServerStatusConnection"));
+			if (Socket != nullptr && !Listener.OnConnectionAccepted(Socket))
+			{
+				UEPythonServer::CloseSocket(Socket);
+			}
+		}
+		return 0;
+	}
+	
+	virtual void Stop() override
+	{
+		bStopping.store(true);
+	}
+	
+private:
+	FPythonStatusListener& Listener;
+	std::atomic<bool> bStopping;
+};
+
+FPythonStatusListener::FPythonStatusListener(int32 InNumWorkers)
+	: NumWorkers(FMath::Max(InNumWorkers, 1))
+	, NumRequests(0)
+{
+}
+
+FPythonStatusListener::~FPythonStatusListener()
+{
+	Stop();
+}
+
+bool FPythonStatusListener::Start(uint32 Port, const FIPv4Address& BindAddress)
+{
+	// A pool of its own, so requests are not stuck behind engine work on the global thread pool
+	WorkerPool = FQueuedThreadPool::Allocate();
+	if (!WorkerPool->Create(NumWorkers, 64 * 1024, TPri_Normal, TEXT("PythonServerStatusPool")))
+	{
+		delete WorkerPool;
+		WorkerPool = nullptr;
+		return false;
+	}
+	
+	const FIPv4Endpoint Endpoint(BindAddress, Port);
+	ListenSocket = FTcpSocketBuilder(TEXT("PythonServerStatusListener")).AsReusable().BoundToEndpoint(Endpoint).Listening(64).Build();
+	if (ListenSocket == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to start status listener on %s"), *Endpoint.ToString());
+		Stop();
+		return false;
+	}
+	
+	// Everything a connection needs is in place, so connections can be accepted from here on
+	AcceptRunnable = MakeUnique<FStatusAcceptRunnable>(*this);
+	AcceptThread = FRunnableThread::Create(AcceptRunnable.Get(), TEXT("PythonServerStatusAccept"), 64 * 1024, TPri_Normal);
+	if (AcceptThread == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to start the status listener thread"));
+		Stop();
+		return false;
+	}
+	
+	UE_LOG(LogTemp, Log, TEXT("UEPythonServer status listener on %s with %d workers"), *Endpoint.ToString(), NumWorkers);
+	return true;
+}
+
+void FPythonStatusListener::Stop()
+{
+	// Stop accepting first, then let the workers finish the connections they have
+	if (AcceptThread != nullptr)
+	{
+		AcceptThread->Kill(/* bShouldWait */ true);
+		delete AcceptThread;
+		AcceptThread = nullptr;
+	}
+	AcceptRunnable.Reset();
+	if (ListenSocket != nullptr)
+	{
+		UEPythonServer::CloseSocket(ListenSocket);
+		ListenSocket = nullptr;
+	}
+	if (WorkerPool != nullptr)
+	{
+		WorkerPool->Destroy();
+		delete WorkerPool;
+		WorkerPool = nullptr;
+	}
+}
+
+void FPythonStatusListener::SetSnapshot(const FString& Path, const FString& ContentType, const FString& Body)
+{
+	TSharedPtr<FSnapshot> Snapshot = MakeShared<FSnapshot>();
+	Snapshot->ContentType = ContentType;
+	FTCHARToUTF8 Converter(*Body);
+	Snapshot->Body.Append(reinterpret_cast<const uint8*>(Converter.Get()), Converter.Length());
+	Snapshot->Time = FPlatformTime::Seconds();
+	
+	FScopeLock Lock(&SnapshotLock);
+	Snapshots.Add(Path, MoveTemp(Snapshot));
+}
+
+void FPythonStatusListener::SetCancelFunction(TFunction<TSharedPtr<FJsonObject>(const FString&)> InCancelFunction)
+{
+	CancelFunction = MoveTemp(InCancelFunction);
+}
+
+void FPythonStatusListener::SetJobOutputFunction(TFunction<TSharedPtr<FJsonObject>(const FString&, int64)> InJobOutputFunction)
+{
+	JobOutputFunction = MoveTemp(InJobOutputFunction);
+}
+
+void FPythonStatusListener::AddPath(const FString& Path)
+{
+	FScopeLock Lock(&SnapshotLock);
+	LastRequestTimes.FindOrAdd(Path, 0.0);
+}
+
+double FPythonStatusListener::GetLastRequestTime(const FString& Path) const
+{
+	FScopeLock Lock(&SnapshotLock);
+	const double* Time = LastRequestTimes.Find(Path);
+	return Time ? *Time : 0.0;
+}
+
+bool FPythonStatusListener::OnConnectionAccepted(FSocket* Socket)
+{
+	if (WorkerPool == nullptr)
+	{
+		return false;
+	}
+	
+	WorkerPool->AddQueuedWork(new FStatusConnectionWork(*this, Socket));
+	return true;
+}
+
+void FPythonStatusListener::ServeConnection(FSocket* Socket)
+{
+	PYTHONSERVER_TRACE_SCOPE("PythonServer.Status");
+	
+	// Read up to the end of the headers, the request line is all that is used
+	TArray<uint8> Request;
+	Request.Reserve(1024);
+	const double Deadline = FPlatformTime::Seconds() + UEPythonServer::StatusRequestTimeoutSeconds;
+	int32 HeaderEnd = INDEX_NONE;
+	while (HeaderEnd == INDEX_NONE && Request.Num() < UEPythonServer::MaxStatusRequestBytes)
+	{
+		const double Remaining = Deadline - FPlatformTime::Seconds();
+		if (Remaining <= 0.0 || !Socket->Wait(ESocketWaitConditions::WaitForRead, FTimespan::FromSeconds(Remaining)))
+		{
+			break;
+		}
+		
+		uint8 Buffer[1024];
+		int32 BytesRead = 0;
+		if (!Socket->Recv(Buffer, sizeof(Buffer), BytesRead) || BytesRead <= 0)
+		{
+			break;
+		}
+		
+		const int32 SearchStart = FMath::Max(Request.Num() - 3, 0);
+		Request.Append(Buffer, BytesRead);
+		for (int32 Index = SearchStart; Index + 3 < Request.Num(); ++Index)
+		{
+			if (Request[Index] == '\r' && Request[Index + 1] == '\n' && Request[Index + 2] == '\r' && Request[Index + 3] == '\n')
+			{
+				HeaderEnd = Index;
+				break;
+			}
+		}
+	}
+	
+	if (HeaderEnd == INDEX_NONE)
+	{
+		UEPythonServer::CloseSocket(Socket);
+		return;
+	}
+	
+	// "GET /status?x=1 HTTP/1.1", the query is ignored since snapshots do not depend on it, only job output reads it
+	FUTF8ToTCHAR Converter(reinterpret_cast<const ANSICHAR*>(Request.GetData()), HeaderEnd);
+	const FString Headers(Converter.Length(), Converter.Get());
+	FString RequestLine;
+	if (!Headers.Split(TEXT("\r\n"), &RequestLine, nullptr))
+	{
+		RequestLine = Headers;
+	}
+	
+	TArray<FString> Parts;
+	RequestLine.ParseIntoArray(Parts, TEXT(" "));
+	FString Path = Parts.Num() >= 2 ? Parts[1] : FString();
+	FString Query;
+	int32 QueryStart = INDEX_NONE;
+	if (Path.FindChar(TEXT('?'), QueryStart))
+	{
+		Query = Path.Mid(QueryStart + 1);
+		Path.LeftInline(QueryStart);
+	}
+	
+	NumRequests.fetch_add(1, std::memory_order_relaxed);
+	
+	// POST /jobs/{id}/cancel
+	if (Parts.Num() >= 3 && Parts[0] == TEXT("POST") && CancelFunction && Path.StartsWith(TEXT("/jobs/")) && Path.EndsWith(TEXT("/cancel")))
+	{
+		const FString JobId = Path.Mid(6, Path.Len() - 6 - 7);
+		FString ResponseBody;
+		TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ResponseBody);
+		FJsonSerializer::Serialize(CancelFunction(JobId).ToSharedRef(), Writer);
+		
+		FTCHARToUTF8 ResponseConverter(*ResponseBody);
+		UEPythonServer::SendStatusResponse(Socket, TEXT("200 OK"), TEXT("application/json"), TArray<uint8>(reinterpret_cast<const uint8*>(ResponseConverter.Get()), ResponseConverter.Length()));
+		UEPythonServer::CloseSocket(Socket);
+		return;
+	}
+	
+	// GET /jobs/{id}/output?offset=N
+	if (Parts.Num() >= 3 && Parts[0] == TEXT("GET") && JobOutputFunction && Path.StartsWith(TEXT("/jobs/")) && Path.EndsWith(TEXT("/output")))
+	{
+		const FString JobId = Path.Mid(6, Path.Len() - 6 - 7);
+		int64 Offset = 0;
+		TArray<FString> Params;
+		Query.ParseIntoArray(Params, TEXT("&"));
+		for (const FString& Param : Params)
+		{
+			if (Param.StartsWith(TEXT("offset=")))
+			{
+				LexFromString(Offset, *Param.Mid(7));
+			}
+		}
+		
+		FString ResponseBody;
+		TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ResponseBody);
+		FJsonSerializer::Serialize(JobOutputFunction(JobId, Offset).ToSharedRef(), Writer);
+		
+		FTCHARToUTF8 ResponseConverter(*ResponseBody);
+		UEPythonServer::SendStatusResponse(Socket, TEXT("200 OK"), TEXT("application/json"), TArray<uint8>(reinterpret_cast<const uint8*>(ResponseConverter.Get()), ResponseConverter.Length()));
+		UEPythonServer::CloseSocket(Socket);
+		return;
+	}
+	
+	if (Parts.Num() < 3 || Parts[0] != TEXT("GET"))
+	{
+		UEPythonServer::SendStatusError(Socket, TEXT("405 Method Not Allowed"), TEXT("The status listener only serves GET requests and job cancellation"));
+		UEPythonServer::CloseSocket(Socket);
+		return;
+	}
+	
+	// Only served paths are tracked, so scanners cannot grow the map
+	TSharedPtr<const FSnapshot> Snapshot;
+	bool bIsServedPath = false;
+	const double Now = FPlatformTime::Seconds();
+	{
+		FScopeLock Lock(&SnapshotLock);
+		if (double* LastRequestTime = LastRequestTimes.Find(Path))
+		{
+			*LastRequestTime = Now;
+			Snapshot = Snapshots.FindRef(Path);
+			bIsServedPath = true;
+		}
+	}
+	
+	if (!bIsServedPath)
+	{
+		UEPythonServer::SendStatusError(Socket, TEXT("404 Not Found"), TEXT("The status listener does not serve this path"));
+	}
+	else if (!Snapshot.IsValid())
+	{
+		UEPythonServer::SendStatusError(Socket, TEXT("503 Service Unavailable"), TEXT("No snapshot of this path yet"));
+	}
+	else
+	{
+		// Tell clients how stale the answer is, the body itself is the game thread's last snapshot
+		const FString AgeHeader = FString::Printf(TEXT("X-Snapshot-Age-Ms: %.1f\r\n"), (Now - Snapshot->Time) * 1000.0);
+		UEPythonServer::SendStatusResponse(Socket, TEXT("200 OK"), Snapshot->ContentType, Snapshot->Body, AgeHeader);
+	}
+	UEPythonServer::CloseSocket(Socket);
+}
@@ -0,0 +1,112 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "Dom/JsonObject.h"
+#include "Interfaces/IPv4/IPv4Address.h"
+#include <atomic>
+
+class FSocket;
+class FRunnableThread;
+class FQueuedThreadPool;
+class FStatusAcceptRunnable;
+
+/**
+ * Read-only HTTP listener that answers GET requests from snapshots, on a worker pool instead of the
+ * game thread. Health checks and metric scrapes then stay fast while the game thread is busy
+ * running Python work, at the cost of the answer being as old as the last snapshot.
+ *
+ * The game thread publishes a snapshot per served path with SetSnapshot. Workers only read snapshots, so
+ * nothing served here touches UObjects or Python. Two requests are not served from snapshots, job
+ * cancellation and streamed job output, see SetCancelFunction and SetJobOutputFunction. Every
+ * request gets its own connection, which is closed after the response. Cancellation is not
+ * authenticated, so the listener only accepts local connections unless told otherwise.
+ */
+class FPythonStatusListener
+{
+public:
+	/**
+	 * @param InNumWorkers Number of worker threads serving connections
+	 */
+	explicit FPythonStatusListener(int32 InNumWorkers = 2);
+	~FPythonStatusListener();
+	
+	/**
+	 * Starts accepting connections, once every function and path has been set
+	 * @param Port The port to listen on
+	 * @param BindAddress The address to listen on, 0.0.0.0 to accept connections from the network
+	 * @return True if the listener started successfully
+	 */
+	bool Start(uint32 Port, const FIPv4Address& BindAddress = FIPv4Address::InternalLoopback);
+	
+	/** Stops accepting connections and waits for the workers to finish the ones in flight */
+	void Stop();
+	
+	/** Adds a path to serve, requests for other paths get a 404. Requests before its first snapshot get a 503 */
+	void AddPath(const FString& Path);
+	
+	/**
+	 * Replaces the response served for a path, from any thread
+	 * @param Path The request path, such as "/status"
+	 * @param ContentType The Content-Type of the response
+	 * @param Body The response body
+	 */
+	void SetSnapshot(const FString& Path, const FString& ContentType, const FString& Body);
+	
+	/**
+	 * Serves POST /jobs/{id}/cancel with the given function, on a worker thread. Cancelling must
+	 * work while the game thread is busy with the very script being cancelled.
+	 */
+	void SetCancelFunction(TFunction<TSharedPtr<FJsonObject>(const FString& /*JobId*/)> InCancelFunction);
+	
+	/**
+	 * Serves GET /jobs/{id}/output?offset= with the given function, on a worker thread. The HTTP
+	 * router is only served between game-thread ticks, so it cannot answer while the script runs.
+	 */
+	void SetJobOutputFunction(TFunction<TSharedPtr<FJsonObject>(const FString& /*JobId*/, int64 /*Offset*/)> InJobOutputFunction);
+	
+	/** Gets the time of the last request for a path, in FPlatformTime::Seconds(), 0 if there was none */
+	double GetLastRequestTime(const FString& Path) const;
+	
+	/** Number of requests served since the listener started */
+	uint64 GetNumRequests() const { return NumRequests.load(std::memory_order_relaxed); }
+	
+private:
+	struct FSnapshot
+	{
+		FString ContentType;
+		TArray<uint8> Body;
+		double Time = 0.0;
+	};
+	
+	friend class FStatusConnectionWork;
+	friend class FStatusAcceptRunnable;
+	
+	/** Called on the accept thread, hands the connection to a worker */
+	bool OnConnectionAccepted(FSocket* Socket);
+	
+	/** Reads one request from a connection and answers it, on a worker thread */
+	void ServeConnection(FSocket* Socket);
+	
+	int32 NumWorkers;
+	
+	/** Set before Start, only read by the workers afterwards */
+	TFunction<TSharedPtr<FJsonObject>(const FString&)> CancelFunction;
+	TFunction<TSharedPtr<FJsonObject>(const FString&, int64)> JobOutputFunction;
+	
+	/** Listening socket, accepted from by AcceptThread */
+	FSocket* ListenSocket = nullptr;
+	TUniquePtr<FStatusAcceptRunnable> AcceptRunnable;
+	FRunnableThread* AcceptThread = nullptr;
+	
+	FQueuedThreadPool* WorkerPool = nullptr;
+	
+	/** Snapshots and request times by path, a path is served once it has a request time. Guarded by SnapshotLock */
+	TMap<FString, TSharedPtr<const FSnapshot>> Snapshots;
+	TMap<FString, double> LastRequestTimes;
+	mutable FCriticalSection SnapshotLock;
+	
+	std::atomic<uint64> NumRequests;
+};
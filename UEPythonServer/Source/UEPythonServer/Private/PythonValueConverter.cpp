@@ -0,0 +1,216 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PythonValueConverter.h"
+#include "IncludePython.h"
+#include "Dom/JsonObject.h"
+
+namespace PythonValueConverter
+{
+	const TCHAR* AttachmentField = TEXT("__attachment__");
+	
+	/** Containers nested deeper than this are refused, which also stops reference cycles */
+	static constexpr int32 MaxDepth = 64;
+	
+	/** Integers past this lose precision as doubles and are returned as strings */
+	static constexpr long long MaxExactInteger = 1LL << 53;
+	
+	static TSharedPtr<FJsonValue> MakeStringValue(PyObject* Unicode)
+	{
+		Py_ssize_t Size = 0;
+		const char* Utf8 = PyUnicode_AsUTF8AndSize(Unicode, &Size);
+		if (Utf8 == nullptr)
+		{
+			return nullptr;
+		}
+		FUTF8ToTCHAR Converter(Utf8, static_cast<int32>(Size));
+		return MakeShared<FJsonValueString>(FString(Converter.Length(), Converter.Get()));
+	}
+	
+	/** Converts the str() of an object */
+	static TSharedPtr<FJsonValue> MakeStrValue(PyObject* Object)
+	{
+		FPyObjectPtr String = FPyObjectPtr::StealReference(PyObject_Str(Object));
+		return String ? MakeStringValue(String.Get()) : nullptr;
+	}
+	
+	static TSharedPtr<FJsonValue> ConvertObject(PyObject* Object, int32 Depth, FPythonResultValue& OutValue);
+	
+	/** Converts every item of an iterable into an array */
+	static TSharedPtr<FJsonValue> ConvertIterable(PyObject* Iterator, int32 Depth, FPythonResultValue& OutValue)
+	{
+		TArray<TSharedPtr<FJsonValue>> Items;
+		while (FPyObjectPtr Item = FPyObjectPtr::StealReference(PyIter_Next(Iterator)))
+		{
+			TSharedPtr<FJsonValue> ItemValue = ConvertObject(Item.Get(), Depth + 1, OutValue);
+			if (!ItemValue.IsValid())
+			{
+				return nullptr;
+			}
+			Items.Add(MoveTemp(ItemValue));
+		}
+		if (PyErr_Occurred())
+		{
+			return nullptr;
+		}
+		return MakeShared<FJsonValueArray>(MoveTemp(Items));
+	}
+	
+	/** Converts the (key, value) pairs of a mapping into an object, keys that are not strings by their str() */
+	static TSharedPtr<FJsonValue> ConvertItems(PyObject* Items, int32 Depth, FPythonResultValue& OutValue)
+	{
+		FPyObjectPtr Iterator = FPyObjectPtr::StealReference(PyObject_GetIter(Items));
+		if (!Iterator)
+		{
+			return nullptr;
+		}
+		
+		TSharedPtr<FJsonObject> Object = MakeShared<FJsonObject>();
+		while (FPyObjectPtr Pair = FPyObjectPtr::StealReference(PyIter_Next(Iterator.Get())))
+		{
+			if (!PyTuple_Check(Pair.Get()) || PyTuple_Size(Pair.Get()) != 2)
+			{
+				PyErr_SetString(PyExc_TypeError, "items() of a mapping result must return (key, value) pairs");
+				return nullptr;
+			}
+			
+			PyObject* Key = PyTuple_GetItem(Pair.Get(), 0);
+			TSharedPtr<FJsonValue> KeyValue = PyUnicode_Check(Key) ? MakeStringValue(Key) : MakeStrValue(Key);
+			TSharedPtr<FJsonValue> ItemValue = KeyValue.IsValid() ? ConvertObject(PyTuple_GetItem(Pair.Get(), 1), Depth + 1, OutValue) : nullptr;
+			if (!ItemValue.IsValid())
+			{
+				return nullptr;
+			}
+			Object->SetField(KeyValue->AsString(), MoveTemp(ItemValue));
+		}
+		if (PyErr_Occurred())
+		{
+			return nullptr;
+		}
+		return MakeShared<FJsonValueObject>(Object);
+	}
+	
+	/** Copies the bytes of a bytes-like object into an attachment and returns the object standing in for it */
+	static TSharedPtr<FJsonValue> ConvertBuffer(PyObject* Object, FPythonResultValue& OutValue)
+	{
+		Py_buffer Buffer;
+		if (PyObject_GetBuffer(Object, &Buffer, PyBUF_CONTIG_RO) != 0)
+		{
+			return nullptr;
+		}
+		
+		const int32 Index = OutValue.Attachments.Emplace(static_cast<const uint8*>(Buffer.buf), static_cast<int32>(Buffer.len));
+		PyBuffer_Release(&Buffer);
+		
+		TSharedPtr<FJsonObject> Placeholder = MakeShared<FJsonObject>();
+		Placeholder->SetNumberField(AttachmentField, Index);
+		Placeholder->SetNumberField(TEXT("size"), OutValue.Attachments[Index].Num());
+		return MakeShared<FJsonValueObject>(Placeholder);
+	}
+	
+	/** Calls a method taking no arguments and converts what it returns */
+	static TSharedPtr<FJsonValue> ConvertMethodResult(PyObject* Object, const char* MethodName, int32 Depth, FPythonResultValue& OutValue)
+	{
+		FPyObjectPtr Result = FPyObjectPtr::StealReference(PyObject_CallMethod(Object, MethodName, nullptr));
+		return Result ? ConvertObject(Result.Get(), Depth + 1, OutValue) : nullptr;
+	}
+	
+	static TSharedPtr<FJsonValue> ConvertObject(PyObject* Object, int32 Depth, FPythonResultValue& OutValue)
+	{
+		if (Depth > MaxDepth)
+		{
+			PyErr_Format(PyExc_ValueError, "Result is nested more than %d levels deep, or refers to itself", MaxDepth);
+			return nullptr;
+		}
+		
+		if (Object == Py_None)
+		{
+			return MakeShared<FJsonValueNull>();
+		}
+		if (PyBool_Check(Object))
+		{
+			return MakeShared<FJsonValueBoolean>(Object == Py_True);
+		}
+		if (PyLong_Check(Object))
+		{
+			int bOverflow = 0;
+			const long long Integer = PyLong_AsLongLongAndOverflow(Object, &bOverflow);
+			if (Integer == -1 && PyErr_Occurred())
+			{
+				return nullptr;
+			}
+			if (bOverflow != 0 || Integer > MaxExactInteger || Integer < -MaxExactInteger)
+			{
+				return MakeStrValue(Object);
+			}
+			return MakeShared<FJsonValueNumber>(static_cast<double>(Integer));
+		}
+		if (PyFloat_Check(Object))
+		{
+			// JSON has no NaN or infinity
+			const double Number = PyFloat_AsDouble(Object);
+			if (!FMath::IsFinite(Number))
+			{
+				return MakeShared<FJsonValueNull>();
+			}
+			return MakeShared<FJsonValueNumber>(Number);
+		}
+		if (PyUnicode_Check(Object))
+		{
+			return MakeStringValue(Object);
+		}
+		if (PyBytes_Check(Object) || PyByteArray_Check(Object) || PyMemoryView_Check(Object))
+		{
+			return ConvertBuffer(Object, OutValue);
+		}
+		if (PyDict_Check(Object))
+		{
+			FPyObjectPtr Items = FPyObjectPtr::StealReference(PyDict_Items(Object));
+			return Items ? ConvertItems(Items.Get(), Depth, OutValue) : nullptr;
+		}
+		if (PyList_Check(Object) || PyTuple_Check(Object) || PyAnySet_Check(Object))
+		{
+			FPyObjectPtr Iterator = FPyObjectPtr::StealReference(PyObject_GetIter(Object));
+			return Iterator ? ConvertIterable(Iterator.Get(), Depth, OutValue) : nullptr;
+		}
+		
+		// unreal.Vector, unreal.Rotator, unreal.LinearColor and the other math structs
+		if (PyObject_HasAttrString(Object, "to_tuple"))
+		{
+			return ConvertMethodResult(Object, "to_tuple", Depth, OutValue);
+		}
+		
+		// unreal.Object and its subclasses are referred to by path
+		if (PyObject_HasAttrString(Object, "get_path_name"))
+		{
+			return ConvertMethodResult(Object, "get_path_name", Depth, OutValue);
+		}
+		
+		// unreal.Map and other mappings
+		if (PyMapping_Check(Object) && PyObject_HasAttrString(Object, "items"))
+		{
+			FPyObjectPtr Items = FPyObjectPtr::StealReference(PyObject_CallMethod(Object, "items", nullptr));
+			return Items ? ConvertItems(Items.Get(), Depth, OutValue) : nullptr;
+		}
+		
+		// unreal.Array, unreal.Set, generators and other iterables
+		if (FPyObjectPtr Iterator = FPyObjectPtr::StealReference(PyObject_GetIter(Object)))
+		{
+			return ConvertIterable(Iterator.Get(), Depth, OutValue);
+		}
+		PyErr_Clear();
+		
+		return MakeStrValue(Object);
+	}
+	
+	bool Convert(PyObject* Object, FPythonResultValue& OutValue)
+	{
+		FPythonResultValue Converted;
+		Converted.Value = ConvertObject(Object, 0, Converted);
+		if (!Converted.Value.IsValid())
+		{
+			return false;
+		}
+		OutValue = MoveTemp(Converted);
+		return true;
+	}
+}
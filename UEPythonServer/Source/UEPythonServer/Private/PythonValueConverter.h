@@ -0,0 +1,39 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonValue.h"
+#include "PyPtr.h"
+
+/** Value returned by a script run in evaluation mode */
+struct FPythonResultValue
+{
+	/** The value as a JSON tree */
+	TSharedPtr<FJsonValue> Value;
+	
+	/** Contents of the bytes-like objects of the value, which holds {"__attachment__": index} objects in their place */
+	TArray<TArray<uint8>> Attachments;
+};
+
+/**
+ * Converts the value of a script to JSON for the response, so scripts return data without
+ * printing it as a JSON string that the client then decodes a second time.
+ * None, bools, numbers, strings, dicts, lists, tuples and sets convert to their JSON
+ * equivalent. bytes, bytearray and memoryview become attachments. unreal math structs convert
+ * through to_tuple(), unreal objects to their path name, other iterables such as unreal.Array
+ * to arrays, and anything else to its str().
+ */
+namespace PythonValueConverter
+{
+	/** Field of the object standing in for an attachment */
+	extern const TCHAR* AttachmentField;
+	
+	/**
+	 * Converts a Python object, with the GIL held
+	 * @param Object The value
+	 * @param OutValue Set to the converted value, untouched on failure
+	 * @return False with the Python error set if the value could not be converted
+	 */
+	bool Convert(PyObject* Object, FPythonResultValue& OutValue);
+}
@@ -0,0 +1,94 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PythonWatchdog.h"
+#include "PythonInterrupt.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/ScopeLock.h"
+
+namespace UEPythonServer
+{
+	/** Time between interrupts of a run that is still going past its deadline */
+	static constexpr double WatchdogRetrySeconds = 1.0;
+}
+
+FPythonWatchdog::FPythonWatchdog()
+	: bStopping(false)
+{
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool();
+	Thread = FRunnableThread::Create(this, TEXT("PythonServerWatchdog"), 64 * 1024, TPri_AboveNormal);
+}
+
+FPythonWatchdog::~FPythonWatchdog()
+{
+	if (Thread != nullptr)
+	{
+		Thread->Kill(/* bShouldWait */ true);
+		delete Thread;
+		Thread = nullptr;
+	}
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	WakeEvent = nullptr;
+}
+
+void FPythonWatchdog::Arm(uint64 Serial, double Deadline)
+{
+	{
+		FScopeLock ScopeLock(&Lock);
+		ArmedSerial = Serial;
+		NextInterruptTime = Deadline;
+		bFired = false;
+	}
+	WakeEvent->Trigger();
+}
+
+bool FPythonWatchdog::Disarm()
+{
+	// No need to wake the thread, it finds nothing armed at the deadline and goes back to sleep
+	FScopeLock ScopeLock(&Lock);
+	ArmedSerial = 0;
+	return bFired;
+}
+
+uint32 FPythonWatchdog::Run()
+{
+	while (!bStopping.load())
+	{
+		double WaitSeconds = -1.0;
+		{
+			FScopeLock ScopeLock(&Lock);
+			if (ArmedSerial != 0)
+			{
+				const double Now = FPlatformTime::Seconds();
+				if (Now >= NextInterruptTime)
+				{
+					if (PythonInterrupt::RequestInterrupt(ArmedSerial) && !bFired)
+					{
+						UE_LOG(LogTemp, Warning, TEXT("UEPythonServer interrupted job %llu, it ran past its timeout"), ArmedSerial);
+						bFired = true;
+					}
+					NextInterruptTime = Now + UEPythonServer::WatchdogRetrySeconds;
+				}
+				WaitSeconds = NextInterruptTime - Now;
+			}
+		}
+		
+		if (WaitSeconds < 0.0)
+		{
+			WakeEvent->Wait();
+		}
+		else
+		{
+			WakeEvent->Wait(FTimespan::FromSeconds(WaitSeconds));
+		}
+	}
+	return 0;
+}
+
+void FPythonWatchdog::Stop()
+{
+	bStopping.store(true);
+	WakeEvent->Trigger();
+}
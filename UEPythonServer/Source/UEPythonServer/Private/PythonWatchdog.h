@@ -0,0 +1,62 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/CriticalSection.h"
+#include <atomic>
+
+class FEvent;
+class FRunnableThread;
+
+/**
+ * Thread that interrupts the Python of a job once it runs past its deadline.
+ * The game thread arms the watchdog around each run with a deadline, and the watchdog thread
+ * sleeps until then. A run still going at its deadline gets a KeyboardInterrupt through
+ * PythonInterrupt, and again every second after that in case the script swallowed it.
+ * Only one run is watched at a time, since the dispatcher runs one job at a time.
+ */
+class FPythonWatchdog : public FRunnable
+{
+public:
+	FPythonWatchdog();
+	virtual ~FPythonWatchdog();
+	
+	/**
+	 * Starts watching a run, on the game thread
+	 * @param Serial The serial of the running job
+	 * @param Deadline Time the run must finish by, in FPlatformTime::Seconds()
+	 */
+	void Arm(uint64 Serial, double Deadline);
+	
+	/**
+	 * Stops watching the current run, on the game thread
+	 * @return True if the run was interrupted for passing its deadline
+	 */
+	bool Disarm();
+	
+	/** FRunnable implementation */
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	
+private:
+	/** Guards the fields of the run being watched */
+	FCriticalSection Lock;
+	
+	/** Serial of the job being watched, 0 if none */
+	uint64 ArmedSerial = 0;
+	
+	/** Time of the next interrupt, the deadline and then every retry */
+	double NextInterruptTime = 0.0;
+	
+	/** Whether the run being watched was interrupted */
+	bool bFired = false;
+	
+	/** Wakes the thread when a run is armed or the watchdog stops */
+	FEvent* WakeEvent = nullptr;
+	
+	FRunnableThread* Thread = nullptr;
+	
+	std::atomic<bool> bStopping;
+};
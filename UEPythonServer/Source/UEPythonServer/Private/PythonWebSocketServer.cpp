@@ -0,0 +1,243 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PythonWebSocketServer.h"
+#include "PythonServerProtocol.h"
+#include "HttpServerResponse.h"
+#include "IWebSocketNetworkingModule.h"
+#include "IWebSocketServer.h"
+#include "INetworkingWebSocket.h"
+#include "WebSocketNetworkingDelegates.h"
+#include "Json.h"
+#include "Modules/ModuleManager.h"
+
+namespace UEPythonServer
+{
+	/** Quotes a request id for embedding in the reply, ids are short so a manual escape is enough */
+	static FString QuoteJsonString(const FString& Value)
+	{
+		FString Quoted;
+		Quoted.Reserve(Value.Len() + 2);
+		Quoted.AppendChar(TEXT('"'));
+		for (const TCHAR Char : Value)
+		{
+			if (Char == TEXT('"') || Char == TEXT('\\'))
+			{
+				Quoted.AppendChar(TEXT('\\'));
+				Quoted.AppendChar(Char);
+			}
+			else if (Char >= 0x20)
+			{
+				Quoted.AppendChar(Char);
+			}
+		}
+		Quoted.AppendChar(TEXT('"'));
+		return Quoted;
+	}
+	
+	/** Builds the body of an error reply */
+	static TArray<uint8> MakeErrorBody(const FString& Message)
+	{
+		TSharedPtr<FJsonObject> ErrorObj = MakeShared<FJsonObject>();
+		ErrorObj->SetStringField("status", "error");
+		ErrorObj->SetStringField("message", Message);
+		
+		FString ErrorString;
+		TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ErrorString);
+		FJsonSerializer::Serialize(ErrorObj.ToSharedRef(), Writer);
+		
+		FTCHARToUTF8 Converter(*ErrorString);
+		return TArray<uint8>(reinterpret_cast<const uint8*>(Converter.Get()), Converter.Length());
+	}
+}
+
+FPythonWebSocketServer::FPythonWebSocketServer(FDispatchFunction InDispatchFunction)
+	: DispatchFunction(MoveTemp(InDispatchFunction))
+{
+}
+
+FPythonWebSocketServer::~FPythonWebSocketServer()
+{
+	Stop();
+}
+
+bool FPythonWebSocketServer::Start(uint32 Port)
+{
+	IWebSocketNetworkingModule& WebSocketModule = FModuleManager::LoadModuleChecked<IWebSocketNetworkingModule>(TEXT("WebSocketNetworking"));
+	
+	Server = WebSocketModule.CreateServer();
+	
+	FWebSocketClientConnectedCallBack ConnectedCallback;
+	ConnectedCallback.BindRaw(this, &FPythonWebSocketServer::OnClientConnected);
+	
+	if (!Server.IsValid() || !Server->Init(Port, ConnectedCallback))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to start WebSocket server on port %d"), Port);
+		Server.Reset();
+		return false;
+	}
+	
+	UE_LOG(LogTemp, Log, TEXT("UEPythonServer WebSocket listening on port %d"), Port);
+	return true;
+}
+
+void FPythonWebSocketServer::Stop()
+{
+	// Sockets must go before the server that services them
+	Connections.Reset();
+	Server.Reset();
+}
+
+void FPythonWebSocketServer::Tick()
+{
+	if (!Server.IsValid())
+	{
+		return;
+	}
+	
+	Server->Tick();
+	
+	// Sockets are destroyed here rather than from within their own close callback
+	for (auto It = Connections.CreateIterator(); It; ++It)
+	{
+		if (It->Value.bClosed)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void FPythonWebSocketServer::OnClientConnected(INetworkingWebSocket* Socket)
+{
+	const uint32 ConnectionId = NextConnectionId++;
+	
+	FWebSocketPacketReceivedCallBack ReceiveCallback;
+	ReceiveCallback.BindRaw(this, &FPythonWebSocketServer::OnPacketReceived, ConnectionId);
+	Socket->SetReceiveCallBack(ReceiveCallback);
+	
+	FWebSocketInfoCallBack ClosedCallback;
+	ClosedCallback.BindRaw(this, &FPythonWebSocketServer::OnSocketClosed, ConnectionId);
+	Socket->SetSocketClosedCallBack(ClosedCallback);
+	
+	FConnection& Connection = Connections.Add(ConnectionId);
+	Connection.Socket.Reset(Socket);
+	
+	UE_LOG(LogTemp, Log, TEXT("UEPythonServer WebSocket client %u connected"), ConnectionId);
+}
+
+void FPythonWebSocketServer::OnPacketReceived(void* Data, int32 Size, uint32 ConnectionId)
+{
+	FUTF8ToTCHAR MessageConverter(static_cast<const ANSICHAR*>(Data), Size);
+	FString Message(MessageConverter.Length(), MessageConverter.Get());
+	
+	TSharedPtr<FJsonObject> MessageObj;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Message);
+	if (!FJsonSerializer::Deserialize(Reader, MessageObj) || !MessageObj.IsValid())
+	{
+		Send(ConnectionId, FString(), UEPythonServer::MakeErrorBody(TEXT("Invalid JSON message")));
+		return;
+	}
+	
+	FString RequestId;
+	FString Type;
+	MessageObj->TryGetStringField("id", RequestId);
+	if (!MessageObj->TryGetStringField("type", Type))
+	{
+		Send(ConnectionId, RequestId, UEPythonServer::MakeErrorBody(TEXT("Missing 'type' parameter")));
+		return;
+	}
+	
+	// The message itself is the request body, the handlers ignore the fields they do not use
+	FHttpServerRequest Request;
+	Request.Body.Append(static_cast<const uint8*>(Data), Size);
+	if (!RequestId.IsEmpty())
+	{
+		Request.Headers.Add(PythonServerProtocol::RequestIdHeader, { RequestId });
+	}
+	
+	bool bFlag = false;
+	if (MessageObj->TryGetBoolField("async", bFlag) && bFlag)
+	{
+		Request.QueryParams.Add(TEXT("async"), TEXT("1"));
+	}
+	if (MessageObj->TryGetBoolField("stream", bFlag) && bFlag)
+	{
+		Request.QueryParams.Add(TEXT("stream"), TEXT("1"));
+	}
+	
+	FString QueryParam;
+	if (MessageObj->TryGetStringField("class", QueryParam))
+	{
+		Request.QueryParams.Add(TEXT("class"), QueryParam);
+	}
+	if (MessageObj->TryGetStringField("priority", QueryParam))
+	{
+		Request.QueryParams.Add(TEXT("priority"), QueryParam);
+	}
+	int64 Since = 0;
+	if (MessageObj->TryGetNumberField("since", Since))
+	{
+		Request.QueryParams.Add(TEXT("since"), LexToString(Since));
+	}
+	int32 Limit = 0;
+	if (MessageObj->TryGetNumberField("limit", Limit))
+	{
+		Request.QueryParams.Add(TEXT("limit"), FString::FromInt(Limit));
+	}
+	
+	FString PathParam;
+	if (MessageObj->TryGetStringField("job_id", PathParam))
+	{
+		Request.PathParams.Add(TEXT("id"), PathParam);
+	}
+	if (MessageObj->TryGetStringField("batch_id", PathParam))
+	{
+		Request.PathParams.Add(TEXT("id"), PathParam);
+	}
+	if (MessageObj->TryGetStringField("session_id", PathParam))
+	{
+		Request.PathParams.Add(TEXT("id"), PathParam);
+	}
+	if (MessageObj->TryGetStringField("name", PathParam))
+	{
+		Request.PathParams.Add(TEXT("name"), PathParam);
+	}
+	
+	FHttpResultCallback OnComplete = [this, ConnectionId, RequestId](TUniquePtr<FHttpServerResponse> Response)
+	{
+		Send(ConnectionId, RequestId, Response->Body);
+	};
+	
+	if (!DispatchFunction(Type, Request, OnComplete))
+	{
+		Send(ConnectionId, RequestId, UEPythonServer::MakeErrorBody(FString::Printf(TEXT("Unknown request type '%s'"), *Type)));
+	}
+}
+
+void FPythonWebSocketServer::OnSocketClosed(uint32 ConnectionId)
+{
+	if (FConnection* Connection = Connections.Find(ConnectionId))
+	{
+		Connection->bClosed = true;
+		UE_LOG(LogTemp, Log, TEXT("UEPythonServer WebSocket client %u disconnected"), ConnectionId);
+	}
+}
+
+void FPythonWebSocketServer::Send(uint32 ConnectionId, const FString& RequestId, const TArray<uint8>& ResponseBody)
+{
+	FConnection* Connection = Connections.Find(ConnectionId);
+	if (Connection == nullptr || Connection->bClosed)
+	{
+		return;
+	}
+	
+	// Splice the response body into the envelope as-is instead of parsing it again
+	FTCHARToUTF8 PrefixConverter(*FString::Printf(TEXT("{\"id\":%s,\"response\":"), *UEPythonServer::QuoteJsonString(RequestId)));
+	
+	TArray<uint8> Packet;
+	Packet.Reserve(PrefixConverter.Length() + ResponseBody.Num() + 1);
+	Packet.Append(reinterpret_cast<const uint8*>(PrefixConverter.Get()), PrefixConverter.Length());
+	Packet.Append(ResponseBody);
+	Packet.Add('}');
+	
+	Connection->Socket->Send(Packet.GetData(), Packet.Num(), /* bPrependSize */ false);
+}
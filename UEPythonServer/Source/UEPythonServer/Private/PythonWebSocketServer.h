@@ -0,0 +1,71 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HttpServerRequest.h"
+#include "HttpResultCallback.h"
+
+class IWebSocketServer;
+class INetworkingWebSocket;
+
+/**
+ * WebSocket transport for the Python server, for clients that keep one long-lived connection.
+ *
+ * Each text message is a JSON object carrying the same fields as the HTTP request body plus
+ * an "id" chosen by the client and a "type" selecting the endpoint:
+ *   {"id": "42", "type": "execute", "code": "print(1)"}
+ * The reply is sent once the request completes, so many requests can be in flight at once:
+ *   {"id": "42", "response": {"status": "success", "result": "1\n"}}
+ */
+class FPythonWebSocketServer
+{
+public:
+	/**
+	 * Routes a request to the HTTP handler for the given type
+	 * @return False if the type is unknown
+	 */
+	using FDispatchFunction = TFunction<bool(const FString& /*Type*/, const FHttpServerRequest& /*Request*/, const FHttpResultCallback& /*OnComplete*/)>;
+	
+	explicit FPythonWebSocketServer(FDispatchFunction InDispatchFunction);
+	~FPythonWebSocketServer();
+	
+	/**
+	 * Starts listening for WebSocket connections
+	 * @param Port The port to listen on
+	 * @return True if the server started successfully
+	 */
+	bool Start(uint32 Port);
+	
+	/** Closes every connection and stops listening */
+	void Stop();
+	
+	/** Services the sockets, must be called every tick on the game thread */
+	void Tick();
+	
+	/** Number of open connections */
+	int32 GetNumConnections() const { return Connections.Num(); }
+	
+private:
+	struct FConnection
+	{
+		TUniquePtr<INetworkingWebSocket> Socket;
+		bool bClosed = false;
+	};
+	
+	void OnClientConnected(INetworkingWebSocket* Socket);
+	void OnPacketReceived(void* Data, int32 Size, uint32 ConnectionId);
+	void OnSocketClosed(uint32 ConnectionId);
+	
+	/** Sends a reply to a connection, dropping it if the connection has closed since */
+	void Send(uint32 ConnectionId, const FString& RequestId, const TArray<uint8>& ResponseBody);
+	
+	FDispatchFunction DispatchFunction;
+	
+	TUniquePtr<IWebSocketServer> Server;
+	
+	/** Open connections by id. Ids are never reused, so late replies cannot reach a new client */
+	TMap<uint32, FConnection> Connections;
+	
+	uint32 NextConnectionId = 1;
+};
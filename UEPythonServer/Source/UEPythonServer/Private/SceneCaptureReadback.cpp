@@ -0,0 +1,361 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "SceneCaptureReadback.h"
+#include "SceneFastPath.h"
+#include "PythonServerTrace.h"
+#include "HttpServerResponse.h"
+#include "Async/Async.h"
+#include "Components/SceneCaptureComponent2D.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "HAL/PlatformTime.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "Misc/App.h"
+#include "Modules/ModuleManager.h"
+#include "RHIGPUReadback.h"
+#include "RenderingThread.h"
+#include "TextureResource.h"
+#include "UObject/Package.h"
+
+#if WITH_EDITOR
+#include "Editor.h"
+#include "LevelEditorViewport.h"
+#endif
+
+namespace UEPythonServer
+{
+	/** Largest capture on either side, an 8K image is 128 MB of pixels before encoding */
+	static constexpr int32 MaxCaptureSize = 8192;
+	
+	/** Time a readback may take before the capture fails, the renderer may be suspended */
+	static constexpr double CaptureTimeoutSeconds = 10.0;
+	
+	/** Makes a {"status": "error", "message": ...} response, the shape of the server's other errors */
+	static TUniquePtr<FHttpServerResponse> MakeCaptureError(const FString& Message)
+	{
+		return FHttpServerResponse::Create(FString::Printf(TEXT("{\"status\":\"error\",\"message\":\"%s\"}"), *Message.ReplaceCharWithEscapedChar()), TEXT("application/json"));
+	}
+	
+	/** Parses "x,y,z" */
+	static bool ParseVector(const FString& Text, FVector& OutVector)
+	{
+		TArray<FString> Components;
+		if (Text.ParseIntoArray(Components, TEXT(","), /* InCullEmpty */ true) != 3)
+		{
+			return false;
+		}
+		
+		for (int32 Index = 0; Index < 3; ++Index)
+		{
+			if (!LexTryParseString(OutVector[Index], *Components[Index].TrimStartAndEnd()))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+	
+	/** Gets the camera of the active perspective level viewport, or of the first local player outside the editor */
+	static bool GetViewportCamera(UWorld* World, FVector& OutLocation, FRotator& OutRotation, float& OutFieldOfView)
+	{
+#if WITH_EDITOR
+		if (GIsEditor && GEditor)
+		{
+			FLevelEditorViewportClient* ViewportClient = GCurrentLevelEditingViewportClient;
+			if (ViewportClient == nullptr || !ViewportClient->IsPerspective())
+			{
+				ViewportClient = nullptr;
+				for (FLevelEditorViewportClient* LevelViewportClient : GEditor->GetLevelViewportClients())
+				{
+					if (LevelViewportClient != nullptr && LevelViewportClient->IsPerspective())
+					{
+						ViewportClient = LevelViewportClient;
+						break;
+					}
+				}
+			}
+			
+			if (ViewportClient != nullptr)
+			{
+				OutLocation = ViewportClient->GetViewLocation();
+				OutRotation = ViewportClient->GetViewRotation();
+				OutFieldOfView = ViewportClient->ViewFOV;
+				return true;
+			}
+		}
+#endif
+		APlayerController* PlayerController = World->GetFirstPlayerController();
+		if (PlayerController != nullptr && PlayerController->PlayerCameraManager != nullptr)
+		{
+			OutLocation = PlayerController->PlayerCameraManager->GetCameraLocation();
+			OutRotation = PlayerController->PlayerCameraManager->GetCameraRotation();
+			OutFieldOfView = PlayerController->PlayerCameraManager->GetFOVAngle();
+			return true;
+		}
+		return false;
+	}
+}
+
+FSceneCaptureReadback::FSceneCaptureReadback()
+	: Counters(MakeShared<FCounters, ESPMode::ThreadSafe>())
+{
+}
+
+FSceneCaptureReadback::~FSceneCaptureReadback()
+{
+	Reset();
+}
+
+bool FSceneCaptureReadback::ParseSettings(const FHttpServerRequest& Request, FSceneCaptureSettings& OutSettings, FString& OutError)
+{
+	if (const FString* WidthParam = Request.QueryParams.Find(TEXT("width")))
+	{
+		LexFromString(OutSettings.Width, **WidthParam);
+	}
+	if (const FString* HeightParam = Request.QueryParams.Find(TEXT("height")))
+	{
+		LexFromString(OutSettings.Height, **HeightParam);
+	}
+	if (OutSettings.Width < 16 || OutSettings.Height < 16 || OutSettings.Width > UEPythonServer::MaxCaptureSize || OutSettings.Height > UEPythonServer::MaxCaptureSize)
+	{
+		OutError = FString::Printf(TEXT("Capture size must be between 16 and %d pixels"), UEPythonServer::MaxCaptureSize);
+		return false;
+	}
+	
+	if (const FString* FormatParam = Request.QueryParams.Find(TEXT("format")))
+	{
+		if (*FormatParam == TEXT("png"))
+		{
+			OutSettings.bPng = true;
+		}
+		else if (*FormatParam != TEXT("jpeg") && *FormatParam != TEXT("jpg"))
+		{
+			OutError = TEXT("Invalid format, expected jpeg or png");
+			return false;
+		}
+	}
+	if (const FString* QualityParam = Request.QueryParams.Find(TEXT("quality")))
+	{
+		LexFromString(OutSettings.Quality, **QualityParam);
+		OutSettings.Quality = FMath::Clamp(OutSettings.Quality, 1, 100);
+	}
+	
+	if (const FString* LocationParam = Request.QueryParams.Find(TEXT("location")))
+	{
+		FVector Location;
+		if (!UEPythonServer::ParseVector(*LocationParam, Location))
+		{
+			OutError = TEXT("Invalid location, expected x,y,z");
+			return false;
+		}
+		OutSettings.Location = Location;
+	}
+	if (const FString* RotationParam = Request.QueryParams.Find(TEXT("rotation")))
+	{
+		FVector Rotation;
+		if (!UEPythonServer::ParseVector(*RotationParam, Rotation))
+		{
+			OutError = TEXT("Invalid rotation, expected pitch,yaw,roll");
+			return false;
+		}
+		OutSettings.Rotation = FRotator(Rotation.X, Rotation.Y, Rotation.Z);
+	}
+	if (const FString* FieldOfViewParam = Request.QueryParams.Find(TEXT("fov")))
+	{
+		LexFromString(OutSettings.FieldOfView, **FieldOfViewParam);
+		OutSettings.FieldOfView = FMath::Clamp(OutSettings.FieldOfView, 0.0f, 170.0f);
+	}
+	return true;
+}
+
+bool FSceneCaptureReadback::Begin(const FSceneCaptureSettings& Settings, const FHttpResultCallback& OnComplete, FString& OutError)
+{
+	PYTHONSERVER_TRACE_SCOPE("PythonServer.Capture");
+	
+	if (!FApp::CanEverRender())
+	{
+		OutError = TEXT("Rendering is not available in this instance, it runs with -nullrhi");
+		return false;
+	}
+	
+	UWorld* World = SceneFastPath::GetWorld();
+	if (World == nullptr || World->Scene == nullptr)
+	{
+		OutError = TEXT("No world to capture");
+		return false;
+	}
+	
+	// The viewport's camera fills in whatever the request did not set
+	FVector Location = FVector::ZeroVector;
+	FRotator Rotation = FRotator::ZeroRotator;
+	float FieldOfView = 90.0f;
+	if (!UEPythonServer::GetViewportCamera(World, Location, Rotation, FieldOfView) && !Settings.Location.IsSet())
+	{
+		OutError = TEXT("No viewport to capture, pass a location");
+		return false;
+	}
+	Location = Settings.Location.Get(Location);
+	Rotation = Settings.Rotation.Get(Rotation);
+	FieldOfView = Settings.FieldOfView > 0.0f ? Settings.FieldOfView : FieldOfView;
+	
+	if (!RenderTarget.IsValid())
+	{
+		RenderTarget.Reset(NewObject<UTextureRenderTarget2D>(GetTransientPackage(), NAME_None, RF_Transient));
+		RenderTarget->ClearColor = FLinearColor::Black;
+	}
+	if (RenderTarget->SizeX != Settings.Width || RenderTarget->SizeY != Settings.Height || RenderTarget->GetFormat() != PF_B8G8R8A8)
+	{
+		RenderTarget->InitCustomFormat(Settings.Width, Settings.Height, PF_B8G8R8A8, /* bInForceLinearGamma */ false);
+	}
+	
+	if (!CaptureComponent.IsValid())
+	{
+		CaptureComponent.Reset(NewObject<USceneCaptureComponent2D>(GetTransientPackage(), NAME_None, RF_Transient));
+		CaptureComponent->bCaptureEveryFrame = false;
+		CaptureComponent->bCaptureOnMovement = false;
+		CaptureComponent->CaptureSource = ESceneCaptureSource::SCS_FinalColorLDR;
+	}
+	CaptureComponent->TextureTarget = RenderTarget.Get();
+	CaptureComponent->FOVAngle = FieldOfView;
+	CaptureComponent->SetWorldLocationAndRotation(Location, Rotation);
+	
+	// Registered only while the render is queued, so the component never outlives a world that is unloaded
+	CaptureComponent->RegisterComponentWithWorld(World);
+	CaptureComponent->CaptureScene();
+	CaptureComponent->UnregisterComponent();
+	
+	// The copy is queued after the render, the readback's fence tells when both are done
+	TSharedPtr<FRHIGPUTextureReadback, ESPMode::ThreadSafe> Readback = MakeShared<FRHIGPUTextureReadback, ESPMode::ThreadSafe>(TEXT("PythonServerCapture"));
+	FTextureRenderTargetResource* Resource = RenderTarget->GameThread_GetRenderTargetResource();
+	ENQUEUE_RENDER_COMMAND(PythonServerCaptureReadback)([Readback, Resource](FRHICommandListImmediate& RHICmdList)
+	{
+		Readback->EnqueueCopy(RHICmdList, Resource->GetRenderTargetTexture());
+	});
+	
+	FInFlightCapture& Capture = InFlight.AddDefaulted_GetRef();
+	Capture.Readback = MoveTemp(Readback);
+	Capture.Settings = Settings;
+	Capture.OnComplete = OnComplete;
+	Capture.StartTime = FPlatformTime::Seconds();
+	return true;
+}
+
+void FSceneCaptureReadback::Tick(double Now)
+{
+	for (int32 Index = 0; Index < InFlight.Num(); ++Index)
+	{
+		FInFlightCapture& Capture = InFlight[Index];
+		if (Capture.Readback->IsReady())
+		{
+			FInFlightCapture ReadyCapture = MoveTemp(Capture);
+			InFlight.RemoveAt(Index--, 1, /* bAllowShrinking */ false);
+			Encode(MoveTemp(ReadyCapture));
+		}
+		else if (Now - Capture.StartTime > UEPythonServer::CaptureTimeoutSeconds)
+		{
+			++Counters->NumFailed;
+			Capture.OnComplete(UEPythonServer::MakeCaptureError(TEXT("The capture readback did not finish, the renderer may be suspended")));
+			
+			// The render thread may still copy into the readback, it lives on in the lambda
+			ENQUEUE_RENDER_COMMAND(PythonServerReleaseCapture)([Readback = MoveTemp(Capture.Readback)](FRHICommandListImmediate&) {});
+			InFlight.RemoveAt(Index--, 1, /* bAllowShrinking */ false);
+		}
+	}
+}
+
+void FSceneCaptureReadback::Encode(FInFlightCapture&& Capture)
+{
+	// Counted as completed or failed by the final game-thread callback, once the outcome is known
+	++Counters->NumEncoding;
+	
+	// Image wrappers are created on the thread pool, the module is loaded here on the game thread
+	IImageWrapperModule* ImageWrapperModule = &FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+	const double RenderSeconds = FPlatformTime::Seconds() - Capture.StartTime;
+	
+	// Locking is a render thread operation, so the rows are copied there and encoded on the thread pool
+	ENQUEUE_RENDER_COMMAND(PythonServerCaptureCopy)([Capture = MoveTemp(Capture), Counters = Counters, ImageWrapperModule, RenderSeconds](FRHICommandListImmediate& RHICmdList) mutable
+	{
+		PYTHONSERVER_TRACE_SCOPE("PythonServer.CaptureCopy");
+		const int32 Width = Capture.Settings.Width;
+		const int32 Height = Capture.Settings.Height;
+		
+		TArray<FColor> Pixels;
+		Pixels.SetNumUninitialized(Width * Height);
+		
+		void* Data = nullptr;
+		int32 RowPitchInPixels = 0;
+		Capture.Readback->LockTexture(RHICmdList, Data, RowPitchInPixels);
+		if (Data != nullptr)
+		{
+			for (int32 Row = 0; Row < Height; ++Row)
+			{
+				FMemory::Memcpy(&Pixels[Row * Width], static_cast<const FColor*>(Data) + Row * RowPitchInPixels, Width * sizeof(FColor));
+			}
+		}
+		Capture.Readback->Unlock();
+		Capture.Readback.Reset();
+		
+		Async(EAsyncExecution::ThreadPool, [Capture = MoveTemp(Capture), Counters = MoveTemp(Counters), Pixels = MoveTemp(Pixels), ImageWrapperModule, RenderSeconds, bLocked = Data != nullptr]() mutable
+		{
+			PYTHONSERVER_TRACE_SCOPE("PythonServer.CaptureEncode");
+			const double EncodeStartTime = FPlatformTime::Seconds();
+			
+			// Scene captures leave alpha undefined, an opaque image is expected
+			for (FColor& Pixel : Pixels)
+			{
+				Pixel.A = 255;
+			}
+			
+			TArray64<uint8> Image;
+			TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule->CreateImageWrapper(Capture.Settings.bPng ? EImageFormat::PNG : EImageFormat::JPEG);
+			if (bLocked && ImageWrapper.IsValid() && ImageWrapper->SetRaw(Pixels.GetData(), Pixels.Num() * sizeof(FColor), Capture.Settings.Width, Capture.Settings.Height, ERGBFormat::BGRA, 8))
+			{
+				Image = ImageWrapper->GetCompressed(Capture.Settings.bPng ? 0 : Capture.Settings.Quality);
+			}
+			const double EncodeSeconds = FPlatformTime::Seconds() - EncodeStartTime;
+			
+			AsyncTask(ENamedThreads::GameThread, [Capture = MoveTemp(Capture), Counters = MoveTemp(Counters), Image = MoveTemp(Image), RenderSeconds, EncodeSeconds]() mutable
+			{
+				--Counters->NumEncoding;
+				if (Image.Num() == 0)
+				{
+					++Counters->NumFailed;
+					Capture.OnComplete(UEPythonServer::MakeCaptureError(TEXT("The capture could not be read back or encoded")));
+					return;
+				}
+				
+				// The image is the body, with the time spent rendering and encoding it in Server-Timing
+				TArray<uint8> Body(Image.GetData(), static_cast<int32>(Image.Num()));
+				TUniquePtr<FHttpServerResponse> Response = FHttpServerResponse::Create(MoveTemp(Body), Capture.Settings.bPng ? TEXT("image/png") : TEXT("image/jpeg"));
+				++Counters->NumCompleted;
+				Response->Headers.Add(TEXT("Server-Timing"), { FString::Printf(TEXT("render;dur=%.2f, encode;dur=%.2f"), RenderSeconds * 1000.0, EncodeSeconds * 1000.0) });
+				Capture.OnComplete(MoveTemp(Response));
+			});
+		});
+	});
+}
+
+void FSceneCaptureReadback::Reset()
+{
+	for (FInFlightCapture& Capture : InFlight)
+	{
+		++Counters->NumFailed;
+		Capture.OnComplete(UEPythonServer::MakeCaptureError(TEXT("The server stopped before the capture finished")));
+		ENQUEUE_RENDER_COMMAND(PythonServerReleaseCapture)([Readback = MoveTemp(Capture.Readback)](FRHICommandListImmediate&) {});
+	}
+	InFlight.Reset();
+	RenderTarget.Reset();
+	CaptureComponent.Reset();
+}
+
+FSceneCaptureStats FSceneCaptureReadback::GetStats() const
+{
+	FSceneCaptureStats Stats;
+	Stats.NumInFlight = InFlight.Num() + Counters->NumEncoding;
+	Stats.NumCompleted = Counters->NumCompleted;
+	Stats.NumFailed = Counters->NumFailed;
+	return Stats;
+}
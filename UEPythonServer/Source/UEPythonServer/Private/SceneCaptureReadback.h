@@ -0,0 +1,115 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HttpResultCallback.h"
+#include "HttpServerRequest.h"
+#include "UObject/StrongObjectPtr.h"
+
+class FRHIGPUTextureReadback;
+class UTextureRenderTarget2D;
+class USceneCaptureComponent2D;
+
+/** Settings of a /capture request */
+struct FSceneCaptureSettings
+{
+	int32 Width = 1280;
+	int32 Height = 720;
+	
+	/** PNG instead of JPEG */
+	bool bPng = false;
+	
+	/** JPEG quality, 1 to 100 */
+	int32 Quality = 85;
+	
+	/** Camera of the capture, the active viewport's when not set */
+	TOptional<FVector> Location;
+	TOptional<FRotator> Rotation;
+	
+	/** Horizontal field of view in degrees, 0 for the viewport's */
+	float FieldOfView = 0.0f;
+};
+
+/** Counters of the capture endpoint */
+struct FSceneCaptureStats
+{
+	/** Captures rendering, being read back or being encoded */
+	int32 NumInFlight = 0;
+	
+	/** Captures answered with an image */
+	uint64 NumCompleted = 0;
+	
+	/** Captures that timed out, were reset or could not be read back or encoded */
+	uint64 NumFailed = 0;
+};
+
+/**
+ * Renders images of the scene for /capture without stalling the game thread.
+ * The scene is rendered by a transient scene capture into a render target, from the camera of
+ * the active level viewport or from one given by the request. The pixels are copied back with a
+ * GPU readback whose fence is polled once per tick, and are then encoded to JPEG or PNG on the
+ * thread pool, so the game thread only pays for queuing the render.
+ * Every method must be called on the game thread.
+ */
+class FSceneCaptureReadback
+{
+public:
+	FSceneCaptureReadback();
+	~FSceneCaptureReadback();
+	
+	/**
+	 * Reads the settings of a request from ?width=, ?height=, ?format=jpeg|png, ?quality=,
+	 * ?location=x,y,z, ?rotation=pitch,yaw,roll and ?fov=
+	 * @return False with OutError set if a setting is invalid
+	 */
+	static bool ParseSettings(const FHttpServerRequest& Request, FSceneCaptureSettings& OutSettings, FString& OutError);
+	
+	/**
+	 * Renders a capture and queues its readback
+	 * @param Settings What to capture
+	 * @param OnComplete Called with the encoded image once it is ready, or with an error
+	 * @return False with OutError set if the capture could not be rendered, OnComplete is then not called
+	 */
+	bool Begin(const FSceneCaptureSettings& Settings, const FHttpResultCallback& OnComplete, FString& OutError);
+	
+	/** Starts the encoding of the captures whose readback has finished */
+	void Tick(double Now);
+	
+	/** Fails every capture in flight */
+	void Reset();
+	
+	/** Gets a snapshot of the counters */
+	FSceneCaptureStats GetStats() const;
+	
+private:
+	struct FInFlightCapture
+	{
+		TSharedPtr<FRHIGPUTextureReadback, ESPMode::ThreadSafe> Readback;
+		FSceneCaptureSettings Settings;
+		FHttpResultCallback OnComplete;
+		
+		/** Time the capture was rendered, in FPlatformTime::Seconds() */
+		double StartTime = 0.0;
+	};
+	
+	/** Copies the pixels of a finished readback and encodes them on the thread pool */
+	void Encode(FInFlightCapture&& Capture);
+	
+	TArray<FInFlightCapture> InFlight;
+	
+	/** Reused across captures, resized when a request asks for another resolution */
+	TStrongObjectPtr<UTextureRenderTarget2D> RenderTarget;
+	TStrongObjectPtr<USceneCaptureComponent2D> CaptureComponent;
+	
+	/** Counters, shared with the encode callbacks so they can count their outcome once they finish */
+	struct FCounters
+	{
+		int32 NumEncoding = 0;
+		uint64 NumCompleted = 0;
+		uint64 NumFailed = 0;
+	};
+	
+	/** Only changed on the game thread, the encode callbacks carry a reference across threads */
+	TSharedRef<FCounters, ESPMode::ThreadSafe> Counters;
+};
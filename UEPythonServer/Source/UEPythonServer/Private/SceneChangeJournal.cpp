@@ -0,0 +1,221 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "SceneChangeJournal.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Components/SceneComponent.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/TransactionObjectEvent.h"
+#include "UObject/UObjectGlobals.h"
+#include "Algo/BinarySearch.h"
+
+#if WITH_EDITOR
+#include "Editor.h"
+#endif
+
+const TCHAR* LexToString(ESceneChangeType Type)
+{
+	switch (Type)
+	{
+	case ESceneChangeType::Added:
+		return TEXT("added");
+	case ESceneChangeType::Removed:
+		return TEXT("removed");
+	case ESceneChangeType::Moved:
+		return TEXT("moved");
+	case ESceneChangeType::Renamed:
+		return TEXT("renamed");
+	default:
+		return TEXT("unknown");
+	}
+}
+
+FSceneChangeJournal::FSceneChangeJournal(int32 InMaxChanges)
+	: MaxChanges(FMath::Max(InMaxChanges, 16))
+{
+}
+
+FSceneChangeJournal::~FSceneChangeJournal()
+{
+	Stop();
+}
+
+void FSceneChangeJournal::Start()
+{
+#if WITH_EDITOR
+	if (GEngine && !ActorAddedHandle.IsValid())
+	{
+		ActorAddedHandle = GEngine->OnLevelActorAdded().AddRaw(this, &FSceneChangeJournal::OnLevelActorAdded);
+		ActorDeletedHandle = GEngine->OnLevelActorDeleted().AddRaw(this, &FSceneChangeJournal::OnLevelActorDeleted);
+		ActorMovedHandle = GEngine->OnActorMoved().AddRaw(this, &FSceneChangeJournal::OnActorMoved);
+		ActorLabelChangedHandle = FCoreDelegates::OnActorLabelChanged.AddRaw(this, &FSceneChangeJournal::OnActorLabelChanged);
+		ObjectPropertyChangedHandle = FCoreUObjectDelegates::OnObjectPropertyChanged.AddRaw(this, &FSceneChangeJournal::OnObjectPropertyChanged);
+		ObjectTransactedHandle = FCoreUObjectDelegates::OnObjectTransacted.AddRaw(this, &FSceneChangeJournal::OnObjectTransacted);
+		WorldCleanupHandle = FWorldDelegates::OnWorldCleanup.AddRaw(this, &FSceneChangeJournal::OnWorldCleanup);
+	}
+#endif
+}
+
+void FSceneChangeJournal::Stop()
+{
+#if WITH_EDITOR
+	if (GEngine && ActorAddedHandle.IsValid())
+	{
+		GEngine->OnLevelActorAdded().Remove(ActorAddedHandle);
+		GEngine->OnLevelActorDeleted().Remove(ActorDeletedHandle);
+		GEngine->OnActorMoved().Remove(ActorMovedHandle);
+	}
+	FCoreDelegates::OnActorLabelChanged.Remove(ActorLabelChangedHandle);
+	FCoreUObjectDelegates::OnObjectPropertyChanged.Remove(ObjectPropertyChangedHandle);
+	FCoreUObjectDelegates::OnObjectTransacted.Remove(ObjectTransactedHandle);
+	FWorldDelegates::OnWorldCleanup.Remove(WorldCleanupHandle);
+#endif
+	ActorAddedHandle.Reset();
+	ActorDeletedHandle.Reset();
+	ActorMovedHandle.Reset();
+	ActorLabelChangedHandle.Reset();
+	ObjectPropertyChangedHandle.Reset();
+	ObjectTransactedHandle.Reset();
+	WorldCleanupHandle.Reset();
+	
+	// Changes made while not recording are unknown, so make every reader take a new snapshot
+	Reset();
+}
+
+bool FSceneChangeJournal::GetChangesSince(uint64 Since, int32 InMaxChanges, TArray<FSceneChange>& OutChanges) const
+{
+	if (Since < DroppedSequence || Since > Sequence)
+	{
+		return false;
+	}
+	
+	// Sequence numbers are strictly increasing, so find the first change after Since with a binary search
+	const int32 FirstIndex = Algo::UpperBoundBy(Changes, Since, [](const FSceneChange& Change) { return Change.Sequence; });
+	
+	// Keep only the latest change per actor, an actor dragged around for a while is reported once
+	TMap<FString, int32> LatestByName;
+	LatestByName.Reserve(Changes.Num() - FirstIndex);
+	for (int32 Index = FirstIndex; Index < Changes.Num(); ++Index)
+	{
+		LatestByName.Add(Changes[Index].Name, Index);
+	}
+	
+	OutChanges.Reset();
+	for (int32 Index = FirstIndex; Index < Changes.Num() && OutChanges.Num() < InMaxChanges; ++Index)
+	{
+		if (LatestByName.FindChecked(Changes[Index].Name) == Index)
+		{
+			OutChanges.Add(Changes[Index]);
+		}
+	}
+	return true;
+}
+
+void FSceneChangeJournal::OnLevelActorAdded(AActor* Actor)
+{
+	Record(ESceneChangeType::Added, Actor);
+}
+
+void FSceneChangeJournal::OnLevelActorDeleted(AActor* Actor)
+{
+	Record(ESceneChangeType::Removed, Actor);
+}
+
+void FSceneChangeJournal::OnActorMoved(AActor* Actor)
+{
+	Record(ESceneChangeType::Moved, Actor);
+}
+
+void FSceneChangeJournal::OnActorLabelChanged(AActor* Actor)
+{
+	Record(ESceneChangeType::Renamed, Actor);
+}
+
+#if WITH_EDITOR
+namespace SceneChangeJournal
+{
+	/** Whether a property is one of the relative transform properties of a scene component */
+	static bool IsTransformProperty(FName PropertyName)
+	{
+		return PropertyName == USceneComponent::GetRelativeLocationPropertyName()
+			|| PropertyName == USceneComponent::GetRelativeRotationPropertyName()
+			|| PropertyName == USceneComponent::GetRelativeScale3DPropertyName();
+	}
+	
+	/** Gets the actor whose transform a changed object holds, the owner of a root component */
+	static AActor* GetMovedActor(UObject* Object)
+	{
+		const USceneComponent* Component = Cast<USceneComponent>(Object);
+		AActor* Owner = Component ? Component->GetOwner() : nullptr;
+		return Owner && Owner->GetRootComponent() == Component ? Owner : nullptr;
+	}
+}
+
+void FSceneChangeJournal::OnObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& Event)
+{
+	// Catches edits that bypass the editor's move paths, such as the details panel or a script
+	// setting relative_location with set_editor_property
+	if (SceneChangeJournal::IsTransformProperty(Event.GetMemberPropertyName()))
+	{
+		Record(ESceneChangeType::Moved, SceneChangeJournal::GetMovedActor(Object));
+	}
+}
+
+void FSceneChangeJournal::OnObjectTransacted(UObject* Object, const FTransactionObjectEvent& Event)
+{
+	// Undo and redo restore transforms without any move notification, and so do script moves
+	// inside a transaction that modified the root component
+	if (Event.GetEventType() == ETransactionObjectEventType::UndoRedo || Event.GetChangedProperties().ContainsByPredicate(&SceneChangeJournal::IsTransformProperty))
+	{
+		Record(ESceneChangeType::Moved, SceneChangeJournal::GetMovedActor(Object));
+	}
+}
+#endif
+
+void FSceneChangeJournal::OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+#if WITH_EDITOR
+	// Loading another map replaces every actor, a mirror of the old one is of no use
+	if (GEditor && World == GEditor->GetEditorWorldContext().World())
+	{
+		Reset();
+	}
+#endif
+}
+
+void FSceneChangeJournal::Record(ESceneChangeType Type, AActor* Actor)
+{
+#if WITH_EDITOR
+	// Only the level being edited is mirrored, not PIE worlds or editor preview scenes
+	if (Actor == nullptr || GEditor == nullptr || Actor->GetWorld() != GEditor->GetEditorWorldContext().World())
+	{
+		return;
+	}
+	
+	FSceneChange& Change = Changes.AddDefaulted_GetRef();
+	Change.Sequence = ++Sequence;
+	Change.Type = Type;
+	Change.Name = Actor->GetName();
+	if (Type != ESceneChangeType::Removed)
+	{
+		Change.Label = Actor->GetActorLabel();
+		Change.ClassName = Actor->GetClass()->GetName();
+		Change.Transform = Actor->GetActorTransform();
+	}
+	
+	// Drop the oldest quarter at once, so trimming is not paid on every change
+	if (Changes.Num() > MaxChanges)
+	{
+		const int32 NumToDrop = MaxChanges / 4;
+		DroppedSequence = Changes[NumToDrop - 1].Sequence;
+		Changes.RemoveAt(0, NumToDrop, /* bAllowShrinking */ false);
+	}
+#endif
+}
+
+void FSceneChangeJournal::Reset()
+{
+	Changes.Reset();
+	DroppedSequence = Sequence;
+}
@@ -0,0 +1,112 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Delegates/IDelegateInstance.h"
+
+class AActor;
+class UObject;
+class UWorld;
+class FTransactionObjectEvent;
+struct FPropertyChangedEvent;
+
+/** Kind of change recorded for an actor */
+enum class ESceneChangeType : uint8
+{
+	Added,
+	Removed,
+	Moved,
+	Renamed
+};
+
+/** Returns the lowercase name used for a change type in responses */
+const TCHAR* LexToString(ESceneChangeType Type);
+
+/** One journal entry, with the state of the actor when the change happened */
+struct FSceneChange
+{
+	/** Position of the change in the journal, strictly increasing */
+	uint64 Sequence = 0;
+	
+	ESceneChangeType Type = ESceneChangeType::Added;
+	
+	/** Object name of the actor, stable for the actor's lifetime */
+	FString Name;
+	
+	/** Label and class, empty for removals */
+	FString Label;
+	FString ClassName;
+	
+	/** Transform of the actor, identity for removals */
+	FTransform Transform;
+};
+
+/**
+ * Journal of actor changes in the editor world, fed by the editor's actor delegates and by property
+ * and transaction changes of root components, so clients can keep a mirror of the level by reading
+ * only what changed since the last sequence number they saw.
+ * The most recent changes are retained, a client further behind than that must take a new snapshot.
+ * Must only be used on the game thread.
+ */
+class FSceneChangeJournal
+{
+public:
+	explicit FSceneChangeJournal(int32 InMaxChanges = 65536);
+	~FSceneChangeJournal();
+	
+	/** Starts recording changes from the editor delegates */
+	void Start();
+	
+	/** Stops recording changes */
+	void Stop();
+	
+	/** Sequence number of the latest change */
+	uint64 GetSequence() const { return Sequence; }
+	
+	/**
+	 * Gets the changes after a sequence number, keeping only the latest change per actor
+	 * @param Since The last sequence number the client has seen
+	 * @param MaxChanges Maximum number of changes to return, the oldest first
+	 * @param OutChanges The changes, in sequence order
+	 * @return False if changes after Since are no longer retained, or Since is from before the journal
+	 *         was reset, in which case the client has to take a new snapshot
+	 */
+	bool GetChangesSince(uint64 Since, int32 MaxChanges, TArray<FSceneChange>& OutChanges) const;
+	
+private:
+	void OnLevelActorAdded(AActor* Actor);
+	void OnLevelActorDeleted(AActor* Actor);
+	void OnActorMoved(AActor* Actor);
+	void OnActorLabelChanged(AActor* Actor);
+#if WITH_EDITOR
+	void OnObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& Event);
+	void OnObjectTransacted(UObject* Object, const FTransactionObjectEvent& Event);
+#endif
+	void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources);
+	
+	/** Records a change of an actor of the editor world */
+	void Record(ESceneChangeType Type, AActor* Actor);
+	
+	/** Forgets every change, readers behind the current sequence must take a new snapshot */
+	void Reset();
+	
+	int32 MaxChanges;
+	
+	/** Retained changes, oldest first */
+	TArray<FSceneChange> Changes;
+	
+	/** Sequence number of the latest change */
+	uint64 Sequence = 0;
+	
+	/** Changes up to this sequence number have been dropped */
+	uint64 DroppedSequence = 0;
+	
+	FDelegateHandle ActorAddedHandle;
+	FDelegateHandle ActorDeletedHandle;
+	FDelegateHandle ActorMovedHandle;
+	FDelegateHandle ActorLabelChangedHandle;
+	FDelegateHandle ObjectPropertyChangedHandle;
+	FDelegateHandle ObjectTransactedHandle;
+	FDelegateHandle WorldCleanupHandle;
+};
@@ -0,0 +1,421 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "SceneFastPath.h"
+#include "EditorBatchScope.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/Texture.h"
+#include "Components/PrimitiveComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "EngineUtils.h"
+
+#if WITH_EDITOR
+#include "Editor.h"
+#endif
+
+namespace SceneFastPath
+{
+	UWorld* GetWorld()
+	{
+#if WITH_EDITOR
+		if (GIsEditor && GEditor)
+		{
+			return GEditor->GetEditorWorldContext().World();
+		}
+#endif
+		for (const FWorldContext& Context : GEngine->GetWorldContexts())
+		{
+			if (Context.WorldType == EWorldType::Game || Context.WorldType == EWorldType::PIE)
+			{
+				return Context.World();
+			}
+		}
+		return nullptr;
+	}
+	
+	/** Reads a [x, y, z] array field */
+	static bool TryGetVectorField(const FJsonObject& Object, const TCHAR* Name, FVector& OutVector)
+	{
+		const TArray<TSharedPtr<FJsonValue>>* Values = nullptr;
+		if (!Object.TryGetArrayField(Name, Values) || Values->Num() != 3)
+		{
+			return false;
+		}
+		
+		OutVector = FVector((*Values)[0]->AsNumber(), (*Values)[1]->AsNumber(), (*Values)[2]->AsNumber());
+		return true;
+	}
+	
+	/** Reads a [pitch, yaw, roll] array field */
+	static bool TryGetRotatorField(const FJsonObject& Object, const TCHAR* Name, FRotator& OutRotator)
+	{
+		FVector Values;
+		if (!TryGetVectorField(Object, Name, Values))
+		{
+			return false;
+		}
+		
+		OutRotator = FRotator(Values.X, Values.Y, Values.Z);
+		return true;
+	}
+	
+	static TArray<TSharedPtr<FJsonValue>> MakeNumberArray(std::initializer_list<double> Values)
+	{
+		TArray<TSharedPtr<FJsonValue>> Array;
+		for (double Value : Values)
+		{
+			Array.Add(MakeShared<FJsonValueNumber>(Value));
+		}
+		return Array;
+	}
+	
+	static FString GetActorLabel(const AActor* Actor)
+	{
+#if WITH_EDITOR
+		return Actor->GetActorLabel();
+#else
+		return Actor->GetName();
+#endif
+	}
+	
+	/** Finds an actor by object name, which is a hash lookup, falling back to a scan for a matching label */
+	static AActor* FindActor(UWorld* World, const FString& NameOrLabel)
+	{
+		if (AActor* Actor = FindObject<AActor>(World->PersistentLevel, *NameOrLabel))
+		{
+			return Actor;
+		}
+		
+		for (TActorIterator<AActor> It(World); It; ++It)
+		{
+			if (GetActorLabel(*It) == NameOrLabel)
+			{
+				return *It;
+			}
+		}
+		return nullptr;
+	}
+	
+	/** Finds a class by path ("/Script/Engine.StaticMeshActor", "/Game/BP_Tree.BP_Tree_C") or by short name */
+	static UClass* FindClass(const FString& ClassName)
+	{
+		if (ClassName.Contains(TEXT("/")))
+		{
+			return LoadObject<UClass>(nullptr, *ClassName);
+		}
+		return FindFirstObject<UClass>(*ClassName, EFindFirstObjectOptions::None);
+	}
+	
+	/** Tells the editor an actor was moved, as a move in the viewport would */
+	static void NotifyActorMoved(AActor* Actor)
+	{
+#if WITH_EDITOR
+		if (GIsEditor)
+		{
+			Actor->PostEditMove(/* bFinished */ true);
+		}
+#endif
+	}
+	
+	bool SpawnActor(const FJsonObject& Request, FJsonObject& OutResponse, FString& OutError)
+	{
+		UWorld* World = GetWorld();
+		if (World == nullptr)
+		{
+			OutError = TEXT("No world to spawn into");
+			return false;
+		}
+		
+		FString ClassName = TEXT("StaticMeshActor");
+		Request.TryGetStringField(TEXT("class"), ClassName);
+		UClass* ActorClass = FindClass(ClassName);
+		if (ActorClass == nullptr || !ActorClass->IsChildOf(AActor::StaticClass()))
+		{
+			OutError = FString::Printf(TEXT("Unknown actor class '%s'"), *ClassName);
+			return false;
+		}
+		
+		UStaticMesh* Mesh = nullptr;
+		FString MeshPath;
+		if (Request.TryGetStringField(TEXT("mesh"), MeshPath))
+		{
+			Mesh = LoadObject<UStaticMesh>(nullptr, *MeshPath);
+			if (Mesh == nullptr)
+			{
+				OutError = FString::Printf(TEXT("Unknown static mesh '%s'"), *MeshPath);
+				return false;
+			}
+		}
+		
+		FVector Location = FVector::ZeroVector;
+		FRotator Rotation = FRotator::ZeroRotator;
+		FVector Scale = FVector::OneVector;
+		TryGetVectorField(Request, TEXT("location"), Location);
+		TryGetRotatorField(Request, TEXT("rotation"), Rotation);
+		TryGetVectorField(Request, TEXT("scale"), Scale);
+		
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		SpawnParams.ObjectFlags |= RF_Transactional;
+		
+		AActor* Actor = World->SpawnActor<AActor>(ActorClass, FTransform(Rotation, Location, Scale), SpawnParams);
+		if (Actor == nullptr)
+		{
+			OutError = FString::Printf(TEXT("Failed to spawn '%s'"), *ClassName);
+			return false;
+		}
+		
+		if (Mesh)
+		{
+			if (AStaticMeshActor* MeshActor = Cast<AStaticMeshActor>(Actor))
+			{
+				MeshActor->GetStaticMeshComponent()->SetStaticMesh(Mesh);
+			}
+			else if (UStaticMeshComponent* MeshComponent = Actor->FindComponentByClass<UStaticMeshComponent>())
+			{
+				MeshComponent->SetStaticMesh(Mesh);
+			}
+		}
+		
+#if WITH_EDITOR
+		FString Label;
+		if (Request.TryGetStringField(TEXT("label"), Label))
+		{
+			Actor->SetActorLabel(Label);
+		}
+#endif
+
+		OutResponse.SetStringField(TEXT("name"), Actor->GetName());
+		OutResponse.SetStringField(TEXT("label"), GetActorLabel(Actor));
+		OutResponse.SetStringField(TEXT("path"), Actor->GetPathName());
+		return true;
+	}
+	
+	/** Applies the transform fields present in Entry, leaving the others as they are */
+	static bool SetActorTransform(UWorld* World, const FJsonObject& Entry, FString& OutError)
+	{
+		FString ActorName;
+		if (!Entry.TryGetStringField(TEXT("actor"), ActorName))
+		{
+			OutError = TEXT("Missing 'actor' parameter");
+			return false;
+		}
+		
+		AActor* Actor = FindActor(World, ActorName);
+		if (Actor == nullptr)
+		{
+			OutError = FString::Printf(TEXT("Unknown actor '%s'"), *ActorName);
+			return false;
+		}
+		
+		FTransform Transform = Actor->GetActorTransform();
+		FVector Vector;
+		FRotator Rotator;
+		if (TryGetVectorField(Entry, TEXT("location"), Vector))
+		{
+			Transform.SetLocation(Vector);
+		}
+		if (TryGetRotatorField(Entry, TEXT("rotation"), Rotator))
+		{
+			Transform.SetRotation(Rotator.Quaternion());
+		}
+		if (TryGetVectorField(Entry, TEXT("scale"), Vector))
+		{
+			Transform.SetScale3D(Vector);
+		}
+		
+		// Recorded in the caller's transaction, for undo and for the scene change journal
+		Actor->Modify();
+		if (USceneComponent* RootComponent = Actor->GetRootComponent())
+		{
+			RootComponent->Modify();
+		}
+		
+		Actor->SetActorTransform(Transform, /* bSweep */ false, nullptr, ETeleportType::TeleportPhysics);
+		NotifyActorMoved(Actor);
+		return true;
+	}
+	
+	bool SetActorTransforms(const FJsonObject& Request, FJsonObject& OutResponse, FString& OutError)
+	{
+		UWorld* World = GetWorld();
+		if (World == nullptr)
+		{
+			OutError = TEXT("No world to update");
+			return false;
+		}
+		
+		// Undone as one step like the Python path, navigation and selection updates are flushed once at the end
+		FEditorBatchScope BatchScope(FText::FromString(TEXT("Set Actor Transforms")));
+		
+		// Live layout tools move many actors at once, so a whole array can be applied in one request
+		int32 NumUpdated = 0;
+		bool bSuccess = true;
+		const TArray<TSharedPtr<FJsonValue>>* Entries = nullptr;
+		if (Request.TryGetArrayField(TEXT("actors"), Entries))
+		{
+			for (const TSharedPtr<FJsonValue>& EntryValue : *Entries)
+			{
+				const TSharedPtr<FJsonObject>* Entry = nullptr;
+				FString EntryError;
+				if (!EntryValue->TryGetObject(Entry))
+				{
+					EntryError = TEXT("Entries of 'actors' must be objects");
+				}
+				else if (SetActorTransform(World, **Entry, EntryError))
+				{
+					++NumUpdated;
+					continue;
+				}
+				
+				// Report the first failure, keep applying the rest
+				if (bSuccess)
+				{
+					OutError = EntryError;
+					bSuccess = false;
+				}
+			}
+		}
+		else if (SetActorTransform(World, Request, OutError))
+		{
+			++NumUpdated;
+		}
+		else
+		{
+			bSuccess = false;
+		}
+		
+		OutResponse.SetNumberField(TEXT("updated"), NumUpdated);
+		return bSuccess;
+	}
+	
+	bool SetMaterialParameter(const FJsonObject& Request, FJsonObject& OutResponse, FString& OutError)
+	{
+		UWorld* World = GetWorld();
+		if (World == nullptr)
+		{
+			OutError = TEXT("No world to update");
+			return false;
+		}
+		
+		FString ActorName;
+		FString ParameterName;
+		if (!Request.TryGetStringField(TEXT("actor"), ActorName) || !Request.TryGetStringField(TEXT("parameter"), ParameterName))
+		{
+			OutError = TEXT("Missing 'actor' or 'parameter' parameter");
+			return false;
+		}
+		
+		AActor* Actor = FindActor(World, ActorName);
+		if (Actor == nullptr)
+		{
+			OutError = FString::Printf(TEXT("Unknown actor '%s'"), *ActorName);
+			return false;
+		}
+		
+		UPrimitiveComponent* Component = Actor->FindComponentByClass<UPrimitiveComponent>();
+		int32 Slot = 0;
+		Request.TryGetNumberField(TEXT("slot"), Slot);
+		if (Component == nullptr || Slot < 0 || Slot >= Component->GetNumMaterials())
+		{
+			OutError = FString::Printf(TEXT("Actor '%s' has no material slot %d"), *ActorName, Slot);
+			return false;
+		}
+		
+		// Reuse the dynamic instance made by an earlier call instead of stacking a new one each time
+		UMaterialInstanceDynamic* Material = Cast<UMaterialInstanceDynamic>(Component->GetMaterial(Slot));
+		if (Material == nullptr)
+		{
+			Material = Component->CreateAndSetMaterialInstanceDynamic(Slot);
+		}
+		if (Material == nullptr)
+		{
+			OutError = FString::Printf(TEXT("Actor '%s' has no material in slot %d"), *ActorName, Slot);
+			return false;
+		}
+		
+		double Scalar = 0.0;
+		const TArray<TSharedPtr<FJsonValue>>* VectorValues = nullptr;
+		FString TexturePath;
+		if (Request.TryGetNumberField(TEXT("scalar"), Scalar))
+		{
+			Material->SetScalarParameterValue(*ParameterName, static_cast<float>(Scalar));
+		}
+		else if (Request.TryGetArrayField(TEXT("vector"), VectorValues) && VectorValues->Num() >= 3)
+		{
+			const double Alpha = VectorValues->Num() > 3 ? (*VectorValues)[3]->AsNumber() : 1.0;
+			Material->SetVectorParameterValue(*ParameterName, FLinearColor((*VectorValues)[0]->AsNumber(), (*VectorValues)[1]->AsNumber(), (*VectorValues)[2]->AsNumber(), Alpha));
+		}
+		else if (Request.TryGetStringField(TEXT("texture"), TexturePath))
+		{
+			UTexture* Texture = LoadObject<UTexture>(nullptr, *TexturePath);
+			if (Texture == nullptr)
+			{
+				OutError = FString::Printf(TEXT("Unknown texture '%s'"), *TexturePath);
+				return false;
+			}
+			Material->SetTextureParameterValue(*ParameterName, Texture);
+		}
+		else
+		{
+			OutError = TEXT("Missing 'scalar', 'vector' or 'texture' value");
+			return false;
+		}
+		
+		OutResponse.SetStringField(TEXT("material"), Material->GetPathName());
+		return true;
+	}
+	
+	bool ListActors(const FString& ClassName, int32 MaxActors, FJsonObject& OutResponse, FString& OutError)
+	{
+		UWorld* World = GetWorld();
+		if (World == nullptr)
+		{
+			OutError = TEXT("No world to list");
+			return false;
+		}
+		
+		UClass* FilterClass = AActor::StaticClass();
+		if (!ClassName.IsEmpty())
+		{
+			FilterClass = FindClass(ClassName);
+			if (FilterClass == nullptr || !FilterClass->IsChildOf(AActor::StaticClass()))
+			{
+				OutError = FString::Printf(TEXT("Unknown actor class '%s'"), *ClassName);
+				return false;
+			}
+		}
+		
+		int32 NumMatching = 0;
+		TArray<TSharedPtr<FJsonValue>> Actors;
+		for (TActorIterator<AActor> It(World, FilterClass); It; ++It)
+		{
+			++NumMatching;
+			if (Actors.Num() >= MaxActors)
+			{
+				continue;
+			}
+			
+			const AActor* Actor = *It;
+			const FVector Location = Actor->GetActorLocation();
+			const FRotator Rotation = Actor->GetActorRotation();
+			const FVector Scale = Actor->GetActorScale3D();
+			
+			TSharedPtr<FJsonObject> ActorObj = MakeShared<FJsonObject>();
+			ActorObj->SetStringField(TEXT("name"), Actor->GetName());
+			ActorObj->SetStringField(TEXT("label"), GetActorLabel(Actor));
+			ActorObj->SetStringField(TEXT("class"), Actor->GetClass()->GetName());
+			ActorObj->SetArrayField(TEXT("location"), MakeNumberArray({ Location.X, Location.Y, Location.Z }));
+			ActorObj->SetArrayField(TEXT("rotation"), MakeNumberArray({ Rotation.Pitch, Rotation.Yaw, Rotation.Roll }));
+			ActorObj->SetArrayField(TEXT("scale"), MakeNumberArray({ Scale.X, Scale.Y, Scale.Z }));
+			Actors.Add(MakeShared<FJsonValueObject>(ActorObj));
+		}
+		
+		OutResponse.SetArrayField(TEXT("actors"), Actors);
+		OutResponse.SetNumberField(TEXT("total"), NumMatching);
+		return true;
+	}
+}
@@ -0,0 +1,53 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonObject.h"
+
+class UWorld;
+
+/**
+ * Native implementations of the scene operations agents call most, served by the /actors routes
+ * without going through Python. Every function must be called on the game thread and works on the
+ * editor world, or the game world outside the editor.
+ * Actors are referred to by object name, or by their label in the editor.
+ */
+namespace SceneFastPath
+{
+	/** Gets the world the operations run on, the editor world or else the game world */
+	UWorld* GetWorld();
+	
+	/**
+	 * Spawns an actor
+	 * @param Request {"class": "StaticMeshActor", "mesh": "/Engine/BasicShapes/Cube.Cube", "location": [x, y, z], "rotation": [pitch, yaw, roll], "scale": [x, y, z], "label": "..."}
+	 * @param OutResponse Filled in with the new actor's name, label and path
+	 * @return False with OutError set on failure
+	 */
+	bool SpawnActor(const FJsonObject& Request, FJsonObject& OutResponse, FString& OutError);
+	
+	/**
+	 * Sets the location, rotation and/or scale of one actor, or of every entry of an "actors" array
+	 * @param Request {"actor": "Cube_1", "location": [x, y, z]}, or {"actors": [{"actor": ..., ...}, ...]}
+	 * @param OutResponse Filled in with the number of actors updated
+	 * @return False with OutError set if any actor is unknown, the known ones are still updated
+	 */
+	bool SetActorTransforms(const FJsonObject& Request, FJsonObject& OutResponse, FString& OutError);
+	
+	/**
+	 * Sets a scalar, vector or texture parameter on a dynamic material instance of an actor's primitive component
+	 * @param Request {"actor": "Cube_1", "slot": 0, "parameter": "Color", "vector": [r, g, b, a]}, "scalar": v or "texture": path instead of "vector"
+	 * @param OutResponse Filled in with the material instance path
+	 * @return False with OutError set on failure
+	 */
+	bool SetMaterialParameter(const FJsonObject& Request, FJsonObject& OutResponse, FString& OutError);
+	
+	/**
+	 * Lists the actors of the world with their transforms
+	 * @param ClassName Only list actors of this class or a subclass, every actor when empty
+	 * @param MaxActors Maximum number of actors to list
+	 * @param OutResponse Filled in with the "actors" array and the "total" number of matching actors
+	 * @return False with OutError set on failure
+	 */
+	bool ListActors(const FString& ClassName, int32 MaxActors, FJsonObject& OutResponse, FString& OutError);
+}
@@ -1,6 +1,29 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "UEPythonServer.h"
+#include "PythonJobQueue.h"
+#include "PythonCodeCache.h"
+#include "PythonScriptRegistry.h"
+#include "PythonWebSocketServer.h"
+#include "PythonServerProtocol.h"
+#include "AssetUploadStaging.h"
+#include "AssetImportBatch.h"
+#include "SceneFastPath.h"
+#include "SceneChangeJournal.h"
+#include "PythonServerMetrics.h"
+#include "PythonServerTrace.h"
+#include "PythonOutputCapture.h"
+#include "PythonSessionManager.h"
+#include "PythonStatusListener.h"
+#include "PythonResultCache.h"
+#include "PythonInterrupt.h"
+#include "PythonWatchdog.h"
+#include "PythonInstanceBeacon.h"
+#include "PythonModulePreloader.h"
+#include "PythonValueConverter.h"
+#include "SceneCaptureReadback.h"
+#include "EditorBatchScope.h"
+#include "MeshStreamRegistry.h"
 #include "HttpServerModule.h"
 #include "IHttpRouter.h"
 #include "HttpServerResponse.h"
@@ -8,28 +31,196 @@
 #include "HttpPath.h"
 #include "Json.h"
 #include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
 #include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
 #include "Misc/CString.h"
+#include "Async/Async.h"
+#include "Misc/CommandLine.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/Parse.h"
+#include "Misc/App.h"
+#include "Misc/EngineVersion.h"
+#include "Misc/ConfigCacheIni.h"
 
 // Add the Python script plugin includes
 #include "PythonScriptPlugin.h"
 #include "PyGenUtil.h"
 #include "PyCore.h"
+#include "PyGIL.h"
+#include "PyUtil.h"
 
 #define LOCTEXT_NAMESPACE "FUEPythonServerModule"
 
+namespace UEPythonServer
+{
+	/**
+	 * Sends a response, gzip compressed when the client accepts it and the body is large enough.
+	 * Compressing a multi-MB result takes milliseconds, so it runs on the thread pool and only the
+	 * completion is brought back to the game thread.
+	 */
+	static void CompleteResponse(TUniquePtr<FHttpServerResponse> Response, bool bCompress, const FHttpResultCallback& OnComplete)
+	{
+		if (!bCompress || Response->Body.Num() < PythonServerProtocol::MinCompressedResponseBytes)
+		{
+			OnComplete(MoveTemp(Response));
+			return;
+		}
+		
+		Async(EAsyncExecution::ThreadPool, [Response = MoveTemp(Response), OnComplete]() mutable
+		{
+			PYTHONSERVER_TRACE_SCOPE("PythonServer.Compress");
+			PythonServerProtocol::GzipResponse(*Response);
+			AsyncTask(ENamedThreads::GameThread, [Response = MoveTemp(Response), OnComplete]() mutable
+			{
+				OnComplete(MoveTemp(Response));
+			});
+		});
+	}
+	
+	/** Serializes a JSON object and sends it as the response */
+	static void SendJsonResponse(const TSharedPtr<FJsonObject>& ResponseObj, const FHttpResultCallback& OnComplete, bool bCompress = false)
+	{
+		FString ResponseBody;
+		TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ResponseBody);
+		FJsonSerializer::Serialize(ResponseObj.ToSharedRef(), Writer);
+		
+		CompleteResponse(FHttpServerResponse::Create(ResponseBody, TEXT("application/json")), bCompress, OnComplete);
+	}
+	
+	/** Parses the request body as a JSON object. The body is not null-terminated, so convert with an explicit length */
+	static bool ParseJsonBody(const FHttpServerRequest& Request, TSharedPtr<FJsonObject>& OutObj)
+	{
+		FUTF8ToTCHAR BodyConverter(reinterpret_cast<const ANSICHAR*>(Request.Body.GetData()), Request.Body.Num());
+		FString RequestBody(BodyConverter.Length(), BodyConverter.Get());
+		TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(RequestBody);
+		
+		return FJsonSerializer::Deserialize(Reader, OutObj) && OutObj.IsValid();
+	}
+	
+	/** Whether a query parameter is set to "1" or "true" */
+	static bool IsQueryFlagSet(const FHttpServerRequest& Request, const TCHAR* Name)
+	{
+		const FString* Value = Request.QueryParams.Find(Name);
+		return Value && (*Value == TEXT("1") || *Value == TEXT("true"));
+	}
+	
+	/** Reads a "1"/"true" or "0"/"false" query parameter, falling back to the default when it is missing */
+	static bool GetQueryFlag(const FHttpServerRequest& Request, const TCHAR* Name, bool bDefault)
+	{
+		const FString* Value = Request.QueryParams.Find(Name);
+		if (Value == nullptr)
+		{
+			return bDefault;
+		}
+		return *Value == TEXT("1") || *Value == TEXT("true");
+	}
+	
+	/**
+	 * Gets the lane to queue a request's work in, from ?priority= or else the body's priority field
+	 * @return False if the priority is not one of interactive, normal or batch
+	 */
+	static bool GetRequestPriority(const FHttpServerRequest& Request, const FString& BodyPriority, EPythonJobPriority& OutPriority)
+	{
+		const FString* QueryPriority = Request.QueryParams.Find(TEXT("priority"));
+		const FString& Name = QueryPriority ? *QueryPriority : BodyPriority;
+		if (Name.IsEmpty())
+		{
+			OutPriority = EPythonJobPriority::Normal;
+			return true;
+		}
+		return LexTryParseString(OutPriority, *Name);
+	}
+	
+	/**
+	 * Gets the time a request's job may run for, from ?timeout= or else the body's timeout field
+	 * @param BodyTimeout The body's timeout in seconds, 0 if it has none
+	 * @param DefaultTimeout The server's timeout for requests that do not set one
+	 * @return The timeout in seconds, 0 for no limit
+	 */
+	static double GetRequestTimeout(const FHttpServerRequest& Request, double BodyTimeout, double DefaultTimeout)
+	{
+		double Timeout = BodyTimeout;
+		if (const FString* QueryTimeout = Request.QueryParams.Find(TEXT("timeout")))
+		{
+			LexFromString(Timeout, **QueryTimeout);
+		}
+		return FMath::Clamp(Timeout > 0.0 ? Timeout : DefaultTimeout, 0.0, FUEPythonServerModule::MaxTimeoutSeconds);
+	}
+	
+	/** Sends a {"status": "error", "message": ...} response */
+	static void SendErrorResponse(const FString& Message, const FHttpResultCallback& OnComplete)
+	{
+		TSharedPtr<FJsonObject> ResponseObj = MakeShared<FJsonObject>();
+		ResponseObj->SetStringField("status", "error");
+		ResponseObj->SetStringField("message", Message);
+		SendJsonResponse(ResponseObj, OnComplete);
+	}
+}
+
 // Implement module interface
 void FUEPythonServerModule::StartupModule()
 {
 	UE_LOG(LogTemp, Log, TEXT("UEPythonServer module starting up"));
+	
+	JobQueue = MakeShared<FPythonJobQueue>();
+	CodeCache = MakeShared<FPythonCodeCache>();
+	ResultCache = MakeShared<FPythonResultCache>();
+	ScriptRegistry = MakeShared<FPythonScriptRegistry>();
+	Sessions = MakeShared<FPythonSessionManager>();
+	UploadStaging = MakeShared<FAssetUploadStaging>();
+	SceneJournal = MakeShared<FSceneChangeJournal>();
+	MeshStreams = MakeShared<FMeshStreamRegistry>();
+	Metrics = MakeShared<FPythonServerMetrics>();
+	
+	// Modules to import at server start, from +PreloadModules= lines of [UEPythonServer] in the
+	// engine config, or from a comma separated -PythonServerPreload= for on-demand instances
+	FString PreloadList;
+	if (FParse::Value(FCommandLine::Get(), TEXT("PythonServerPreload="), PreloadList, /* bShouldStopOnSeparator */ false))
+	{
+		PreloadModules = FPythonModulePreloader::ParseModuleList(PreloadList);
+	}
+	else if (GConfig != nullptr)
+	{
+		GConfig->GetArray(TEXT("UEPythonServer"), TEXT("PreloadModules"), PreloadModules, GEngineIni);
+	}
+	
+	// Headless instances, such as -unattended -nullrhi automation editors, start the server from the command line
+	uint32 AutoStartPort = 0;
+	if (FParse::Value(FCommandLine::Get(), TEXT("PythonServerPort="), AutoStartPort))
+	{
+		PostEngineInitHandle = FCoreDelegates::OnPostEngineInit.AddRaw(this, &FUEPythonServerModule::StartServerFromCommandLine, AutoStartPort);
+	}
 }
 
 void FUEPythonServerModule::ShutdownModule()
 {
+	FCoreDelegates::OnPostEngineInit.Remove(PostEngineInitHandle);
+	PostEngineInitHandle.Reset();
+	
 	if (bIsServerRunning)
 	{
 		StopServer();
 	}
+	JobQueue.Reset();
+	
+	// Cached code objects must be released while Python is still initialized
+	if (FPythonScriptPlugin::Get()->IsPythonAvailable())
+	{
+		FPyScopedGIL GIL;
+		CodeCache->Empty();
+		ScriptRegistry->Empty();
+		Sessions->Empty();
+	}
+	CodeCache.Reset();
+	ResultCache.Reset();
+	ScriptRegistry.Reset();
+	Sessions.Reset();
+	UploadStaging.Reset();
+	SceneJournal.Reset();
+	MeshStreams.Reset();
+	Metrics.Reset();
+	
 	UE_LOG(LogTemp, Log, TEXT("UEPythonServer module shutting down"));
 }
 
@@ -59,6 +250,72 @@ bool FUEPythonServerModule::StartServer(uint32 Port)
 		return false;
 	}
 	
+	// Serve the same protocol over WebSocket on the next port, the HTTP server works without it
+	WebSocketServer = MakeShared<FPythonWebSocketServer>([this](const FString& Type, const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+	{
+		return DispatchWebSocketRequest(Type, Request, OnComplete);
+	});
+	if (!WebSocketServer->Start(GetWebSocketPort()))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UEPythonServer WebSocket transport unavailable on port %d"), GetWebSocketPort());
+		WebSocketServer.Reset();
+	}
+	
+	// Serve read-only snapshots from worker threads, so health checks do not wait on the game thread
+	StatusListener = MakeShared<FPythonStatusListener>();
+	StatusListener->AddPath(TEXT("/status"));
+	StatusListener->AddPath(TEXT("/metrics"));
+	StatusListener->AddPath(TEXT("/actors"));
+	StatusListener->SetCancelFunction([this](const FString& JobId)
+	{
+		return CancelJob(JobId);
+	});
+	StatusListener->SetJobOutputFunction([this](const FString& JobId, int64 Offset)
+	{
+		return ReadJobOutput(JobId, Offset);
+	});
+	
+	// The listener cancels jobs without authentication, so it is local only unless StatusBindAddress in
+	// [UEPythonServer] of the engine config, or -PythonServerStatusBind=, opts into another address
+	FString StatusBindString;
+	if (!FParse::Value(FCommandLine::Get(), TEXT("PythonServerStatusBind="), StatusBindString) && GConfig != nullptr)
+	{
+		GConfig->GetString(TEXT("UEPythonServer"), TEXT("StatusBindAddress"), StatusBindString, GEngineIni);
+	}
+	FIPv4Address StatusBindAddress = FIPv4Address::InternalLoopback;
+	if (!StatusBindString.IsEmpty() && !FIPv4Address::Parse(StatusBindString, StatusBindAddress))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UEPythonServer ignores invalid status listener address %s, listening on loopback"), *StatusBindString);
+		StatusBindAddress = FIPv4Address::InternalLoopback;
+	}
+	if (!StatusListener->Start(GetStatusPort(), StatusBindAddress))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UEPythonServer status listener unavailable on port %d"), GetStatusPort());
+		StatusListener.Reset();
+	}
+	NextStatusSnapshotTime = 0.0;
+	NextActorsSnapshotTime = 0.0;
+	ActorsSnapshotSequence = MAX_uint64;
+	
+	// Record actor changes for the scene change feed
+	SceneJournal->Start();
+	
+	// Interrupt scripts that run past their timeout
+	Watchdog = MakeShared<FPythonWatchdog>();
+	
+	// Render /capture images with readbacks polled from the tick
+	CaptureReadback = MakeShared<FSceneCaptureReadback>();
+	
+	// Advertise the instance to fleet routers on this machine
+	InstanceId = FGuid::NewGuid();
+	StartedAt = FDateTime::UtcNow();
+	Beacon = MakeShared<FPythonInstanceBeacon>(FPythonInstanceBeacon::GetDefaultDirectory(), ServerPort);
+	NextBeaconTime = 0.0;
+	
+	// Drain queued Python work on the game thread, starting with the preload list
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FUEPythonServerModule::Tick));
+	EnqueuePreloadModules();
+	
 	bIsServerRunning = true;
 	UE_LOG(LogTemp, Log, TEXT("UEPythonServer started on port %d"), ServerPort);
 	return true;
@@ -79,8 +336,54 @@ void FUEPythonServerModule::StopServer()
 	{
 		HttpRouter->UnbindRoute(ExecuteEndpointHandle);
 		HttpRouter->UnbindRoute(StatusEndpointHandle);
+		HttpRouter->UnbindRoute(ExecuteBatchEndpointHandle);
+		HttpRouter->UnbindRoute(JobEndpointHandle);
+		HttpRouter->UnbindRoute(JobOutputEndpointHandle);
+		HttpRouter->UnbindRoute(CancelJobEndpointHandle);
+		HttpRouter->UnbindRoute(RegisterScriptEndpointHandle);
+		HttpRouter->UnbindRoute(InvokeScriptEndpointHandle);
+		HttpRouter->UnbindRoute(UploadEndpointHandle);
+		HttpRouter->UnbindRoute(ImportBatchEndpointHandle);
+		HttpRouter->UnbindRoute(ImportBatchProgressEndpointHandle);
+		HttpRouter->UnbindRoute(SpawnActorEndpointHandle);
+		HttpRouter->UnbindRoute(ActorTransformEndpointHandle);
+		HttpRouter->UnbindRoute(MaterialParameterEndpointHandle);
+		HttpRouter->UnbindRoute(ListActorsEndpointHandle);
+		HttpRouter->UnbindRoute(SceneChangesEndpointHandle);
+		HttpRouter->UnbindRoute(CaptureEndpointHandle);
+		HttpRouter->UnbindRoute(StreamMeshEndpointHandle);
+		HttpRouter->UnbindRoute(RemoveMeshEndpointHandle);
+		HttpRouter->UnbindRoute(MetricsEndpointHandle);
+		HttpRouter->UnbindRoute(CreateSessionEndpointHandle);
+		HttpRouter->UnbindRoute(ListSessionsEndpointHandle);
+		HttpRouter->UnbindRoute(CloseSessionEndpointHandle);
 	}
 	
+	// Stop draining jobs, pending work is dropped with the server
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	TickerHandle.Reset();
+	JobQueue->Reset();
+	Preloader.Reset();
+	ResultCache->Empty();
+	UploadStaging->Empty();
+	ImportBatches.Reset();
+	ImportBatchIds.Reset();
+	SceneJournal->Stop();
+	
+	// Captures still reading back are answered with an error
+	CaptureReadback->Reset();
+	CaptureReadback.Reset();
+	
+	// Stop WebSocket server
+	WebSocketServer.Reset();
+	
+	// Stop the status listener, waiting for the requests it is serving
+	StatusListener.Reset();
+	Watchdog.Reset();
+	
+	// Routers must stop sending work here
+	Beacon.Reset();
+	
 	// Stop HTTP server
 	HttpServerModule.StopAllListeners();
 	
@@ -88,11 +391,101 @@ void FUEPythonServerModule::StopServer()
 	UE_LOG(LogTemp, Log, TEXT("UEPythonServer stopped"));
 }
 
+void FUEPythonServerModule::StartServerFromCommandLine(uint32 Port)
+{
+	FCoreDelegates::OnPostEngineInit.Remove(PostEngineInitHandle);
+	PostEngineInitHandle.Reset();
+	
+	if (Port < 1024 || Port > 65535)
+	{
+		UE_LOG(LogTemp, Error, TEXT("UEPythonServer not started, -PythonServerPort=%u is not between 1024 and 65535"), Port);
+		return;
+	}
+	if (!bIsServerRunning)
+	{
+		UE_LOG(LogTemp, Log, TEXT("UEPythonServer starting from the command line"));
+		StartServer(Port);
+	}
+}
+
 bool FUEPythonServerModule::IsServerRunning() const
 {
 	return bIsServerRunning;
 }
 
+void FUEPythonServerModule::SetMaxOutputChars(int32 InMaxOutputChars)
+{
+	MaxOutputChars = FMath::Clamp(InMaxOutputChars, 4 * 1024, 256 * 1024 * 1024);
+	UE_LOG(LogTemp, Log, TEXT("UEPythonServer output cap set to %d characters"), MaxOutputChars);
+}
+
+void FUEPythonServerModule::SetLogOutput(bool bInLogOutput)
+{
+	bLogOutput = bInLogOutput;
+}
+
+void FUEPythonServerModule::SetDefaultTimeoutSeconds(float InDefaultTimeoutSeconds)
+{
+	DefaultTimeoutSeconds = FMath::Clamp(InDefaultTimeoutSeconds, 0.0f, static_cast<float>(MaxTimeoutSeconds));
+	UE_LOG(LogTemp, Log, TEXT("UEPythonServer default timeout set to %.1f s"), DefaultTimeoutSeconds);
+}
+
+void FUEPythonServerModule::SetPreloadModules(const TArray<FString>& InPreloadModules)
+{
+	PreloadModules.Reset();
+	for (const FString& ModuleName : InPreloadModules)
+	{
+		const FString TrimmedName = ModuleName.TrimStartAndEnd();
+		if (!TrimmedName.IsEmpty())
+		{
+			PreloadModules.AddUnique(TrimmedName);
+		}
+	}
+	UE_LOG(LogTemp, Log, TEXT("UEPythonServer preload list set to %d modules"), PreloadModules.Num());
+}
+
+void FUEPythonServerModule::EnqueuePreloadModules()
+{
+	Preloader.Reset();
+	if (PreloadModules.Num() == 0)
+	{
+		return;
+	}
+	
+	Preloader = MakeShared<FPythonModulePreloader>(PreloadModules, FPlatformTime::Seconds());
+	for (int32 ModuleIndex = 0; ModuleIndex < PreloadModules.Num(); ++ModuleIndex)
+	{
+		const FString ModuleName = PreloadModules[ModuleIndex];
+		TSharedPtr<const FPythonJob> Job = JobQueue->Enqueue([this, ModuleName](FString& OutResult)
+		{
+			PYTHONSERVER_TRACE_SCOPE_TEXT(TEXT("PythonServer.Preload %s"), *ModuleName);
+			
+			bool bSuccess = false;
+			OutResult = RunPython([&ModuleName]()
+			{
+				return FPythonModulePreloader::ImportModule(ModuleName);
+			}, &bSuccess);
+			return bSuccess;
+		},
+		// Keeps the preloader it reports to alive, a restart replaces the module's
+		[Preloader = Preloader, ModuleIndex](const FPythonJob& FinishedJob)
+		{
+			Preloader->OnModuleFinished(ModuleIndex, FinishedJob);
+		}, false, TEXT("preload"), EPythonJobPriority::Batch);
+		
+		if (!Job.IsValid())
+		{
+			Preloader->OnModuleFailed(ModuleIndex, TEXT("Job queue is full"));
+		}
+	}
+}
+
+void FUEPythonServerModule::SetTickBudgetMs(float InTickBudgetMs)
+{
+	TickBudgetMs = FMath::Clamp(InTickBudgetMs, 0.5f, 1000.0f);
+	UE_LOG(LogTemp, Log, TEXT("UEPythonServer tick budget set to %.1f ms"), TickBudgetMs);
+}
+
 void FUEPythonServerModule::RegisterEndpoints()
 {
 	if (!HttpRouter.IsValid())
@@ -111,6 +504,206 @@ void FUEPythonServerModule::RegisterEndpoints()
 			this->HandleExecuteRequest(Request, OnComplete);
 		});
 	
+	// Register batched execute endpoint
+	FHttpPath ExecuteBatchPath("/execute_batch");
+	ExecuteBatchEndpointHandle = HttpRouter->BindRoute(
+		ExecuteBatchPath,
+		EHttpServerRequestVerbs::VERB_POST,
+		[this](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+		{
+			this->HandleExecuteBatchRequest(Request, OnComplete);
+		});
+	
+	// Register job polling endpoint
+	FHttpPath JobPath("/jobs/:id");
+	JobEndpointHandle = HttpRouter->BindRoute(
+		JobPath,
+		EHttpServerRequestVerbs::VERB_GET,
+		[this](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+		{
+			this->HandleJobRequest(Request, OnComplete);
+		});
+	
+	// Register streamed job output endpoint
+	FHttpPath JobOutputPath("/jobs/:id/output");
+	JobOutputEndpointHandle = HttpRouter->BindRoute(
+		JobOutputPath,
+		EHttpServerRequestVerbs::VERB_GET,
+		[this](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+		{
+			this->HandleJobOutputRequest(Request, OnComplete);
+		});
+	
+	// Register job cancellation endpoint
+	FHttpPath CancelJobPath("/jobs/:id/cancel");
+	CancelJobEndpointHandle = HttpRouter->BindRoute(
+		CancelJobPath,
+		EHttpServerRequestVerbs::VERB_POST,
+		[this](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+		{
+			this->HandleCancelJobRequest(Request, OnComplete);
+		});
+	
+	// Register named script endpoints
+	FHttpPath RegisterScriptPath("/scripts/register");
+	RegisterScriptEndpointHandle = HttpRouter->BindRoute(
+		RegisterScriptPath,
+		EHttpServerRequestVerbs::VERB_POST,
+		[this](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+		{
+			this->HandleRegisterScriptRequest(Request, OnComplete);
+		});
+	
+	FHttpPath InvokeScriptPath("/scripts/:name/invoke");
+	InvokeScriptEndpointHandle = HttpRouter->BindRoute(
+		InvokeScriptPath,
+		EHttpServerRequestVerbs::VERB_POST,
+		[this](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+		{
+			this->HandleInvokeScriptRequest(Request, OnComplete);
+		});
+	
+	// Register asset upload endpoint
+	FHttpPath UploadPath("/upload");
+	UploadEndpointHandle = HttpRouter->BindRoute(
+		UploadPath,
+		EHttpServerRequestVerbs::VERB_POST,
+		[this](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+		{
+			this->HandleUploadRequest(Request, OnComplete);
+		});
+	
+	// Register batched asset import endpoints
+	FHttpPath ImportBatchPath("/import/batch");
+	ImportBatchEndpointHandle = HttpRouter->BindRoute(
+		ImportBatchPath,
+		EHttpServerRequestVerbs::VERB_POST,
+		[this](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+		{
+			this->HandleImportBatchRequest(Request, OnComplete);
+		});
+	
+	FHttpPath ImportBatchProgressPath("/import/batch/:id");
+	ImportBatchProgressEndpointHandle = HttpRouter->BindRoute(
+		ImportBatchProgressPath,
+		EHttpServerRequestVerbs::VERB_GET,
+		[this](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+		{
+			this->HandleImportBatchProgressRequest(Request, OnComplete);
+		});
+	
+	// Register native scene operation endpoints, these skip Python entirely
+	FHttpPath SpawnActorPath("/actors/spawn");
+	SpawnActorEndpointHandle = HttpRouter->BindRoute(
+		SpawnActorPath,
+		EHttpServerRequestVerbs::VERB_POST,
+		[this](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+		{
+			this->HandleSpawnActorRequest(Request, OnComplete);
+		});
+	
+	FHttpPath ActorTransformPath("/actors/transform");
+	ActorTransformEndpointHandle = HttpRouter->BindRoute(
+		ActorTransformPath,
+		EHttpServerRequestVerbs::VERB_POST,
+		[this](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+		{
+			this->HandleActorTransformRequest(Request, OnComplete);
+		});
+	
+	FHttpPath MaterialParameterPath("/actors/material_parameter");
+	MaterialParameterEndpointHandle = HttpRouter->BindRoute(
+		MaterialParameterPath,
+		EHttpServerRequestVerbs::VERB_POST,
+		[this](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+		{
+			this->HandleMaterialParameterRequest(Request, OnComplete);
+		});
+	
+	FHttpPath ListActorsPath("/actors");
+	ListActorsEndpointHandle = HttpRouter->BindRoute(
+		ListActorsPath,
+		EHttpServerRequestVerbs::VERB_GET,
+		[this](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+		{
+			this->HandleListActorsRequest(Request, OnComplete);
+		});
+	
+	// Register scene change feed endpoint
+	FHttpPath SceneChangesPath("/scene/changes");
+	SceneChangesEndpointHandle = HttpRouter->BindRoute(
+		SceneChangesPath,
+		EHttpServerRequestVerbs::VERB_GET,
+		[this](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+		{
+			this->HandleSceneChangesRequest(Request, OnComplete);
+		});
+	
+	// Register scene capture endpoint
+	FHttpPath CapturePath("/capture");
+	CaptureEndpointHandle = HttpRouter->BindRoute(
+		CapturePath,
+		EHttpServerRequestVerbs::VERB_GET,
+		[this](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+		{
+			this->HandleCaptureRequest(Request, OnComplete);
+		});
+	
+	// Register mesh streaming endpoints
+	FHttpPath MeshPath("/meshes/:name");
+	StreamMeshEndpointHandle = HttpRouter->BindRoute(
+		MeshPath,
+		EHttpServerRequestVerbs::VERB_POST,
+		[this](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+		{
+			this->HandleStreamMeshRequest(Request, OnComplete);
+		});
+	
+	RemoveMeshEndpointHandle = HttpRouter->BindRoute(
+		MeshPath,
+		EHttpServerRequestVerbs::VERB_DELETE,
+		[this](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+		{
+			this->HandleRemoveMeshRequest(Request, OnComplete);
+		});
+	
+	// Register metrics endpoint
+	FHttpPath MetricsPath("/metrics");
+	MetricsEndpointHandle = HttpRouter->BindRoute(
+		MetricsPath,
+		EHttpServerRequestVerbs::VERB_GET,
+		[this](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+		{
+			this->HandleMetricsRequest(Request, OnComplete);
+		});
+	
+	// Register session endpoints
+	FHttpPath SessionsPath("/sessions");
+	CreateSessionEndpointHandle = HttpRouter->BindRoute(
+		SessionsPath,
+		EHttpServerRequestVerbs::VERB_POST,
+		[this](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+		{
+			this->HandleCreateSessionRequest(Request, OnComplete);
+		});
+	
+	ListSessionsEndpointHandle = HttpRouter->BindRoute(
+		SessionsPath,
+		EHttpServerRequestVerbs::VERB_GET,
+		[this](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+		{
+			this->HandleListSessionsRequest(Request, OnComplete);
+		});
+	
+	FHttpPath SessionPath("/sessions/:id");
+	CloseSessionEndpointHandle = HttpRouter->BindRoute(
+		SessionPath,
+		EHttpServerRequestVerbs::VERB_DELETE,
+		[this](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+		{
+			this->HandleCloseSessionRequest(Request, OnComplete);
+		});
+	
 	// Register status endpoint
 	FHttpPath StatusPath("/status");
 	StatusEndpointHandle = HttpRouter->BindRoute(
@@ -124,87 +717,1769 @@ void FUEPythonServerModule::RegisterEndpoints()
 
 void FUEPythonServerModule::HandleExecuteRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
 {
-	UE_LOG(LogTemp, Log, TEXT("Received execute request"));
+	const double RequestStartTime = FPlatformTime::Seconds();
+	const FString RequestId = PythonServerProtocol::GetRequestId(Request);
+	PYTHONSERVER_TRACE_SCOPE("PythonServer.Request execute");
+	PYTHONSERVER_TRACE_BOOKMARK(TEXT("PythonServer.Request execute %s"), *RequestId);
+	UE_LOG(LogTemp, Log, TEXT("Received execute request %s"), *RequestId);
 	
-	// Create JSON response object
-	TSharedPtr<FJsonObject> ResponseObj = MakeShared<FJsonObject>();
+	// Requests and responses are JSON, or CBOR when the request says so
+	const EPythonServerPayloadFormat Format = PythonServerProtocol::GetRequestFormat(Request);
 	
 	// Parse request body
-	FString RequestBody = UTF8_TO_TCHAR(Request.Body.GetData());
-	TSharedPtr<FJsonObject> RequestObj;
-	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(RequestBody);
+	PythonServerProtocol::FExecuteRequest ExecuteRequest;
+	FString ParseError;
+	const bool bParsed = PythonServerProtocol::ParseExecuteRequest(Request, Format, ExecuteRequest, ParseError);
+	Metrics->RecordStage(EPythonServerStage::Parse, FPlatformTime::Seconds() - RequestStartTime);
+	if (!bParsed)
+	{
+		Metrics->CountExecuteRequest(false);
+		FPythonServerResponseWriter Writer(Format);
+		Writer.WriteString(TEXT("status"), TEXT("error"));
+		Writer.WriteString(TEXT("message"), ParseError);
+		OnComplete(Writer.Finish());
+		return;
+	}
 	
-	if (!FJsonSerializer::Deserialize(Reader, RequestObj))
+	// Code runs in __main__ unless the request names a session
+	FGuid SessionId;
+	if (const FString* SessionParam = Request.QueryParams.Find(TEXT("session")))
 	{
-		// Failed to parse JSON
-		ResponseObj->SetStringField("status", "error");
-		ResponseObj->SetStringField("message", "Invalid JSON request");
-		
-		// Convert JSON to string and send response
-		FString ResponseBody;
-		TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ResponseBody);
-		FJsonSerializer::Serialize(ResponseObj.ToSharedRef(), Writer);
-		
-		OnComplete(FHttpServerResponse::Create(ResponseBody, TEXT("application/json")));
+		ExecuteRequest.Session = *SessionParam;
+	}
+	if (!ExecuteRequest.Session.IsEmpty() && !FGuid::Parse(ExecuteRequest.Session, SessionId))
+	{
+		Metrics->CountExecuteRequest(false);
+		FPythonServerResponseWriter Writer(Format);
+		Writer.WriteString(TEXT("status"), TEXT("error"));
+		Writer.WriteString(TEXT("message"), TEXT("Invalid session id"));
+		OnComplete(Writer.Finish());
 		return;
 	}
 	
-	// Get the Python code from the request
-	FString Code;
-	if (!RequestObj->TryGetStringField("code", Code))
+	EPythonJobPriority Priority;
+	if (!UEPythonServer::GetRequestPriority(Request, ExecuteRequest.Priority, Priority))
 	{
-		// Code parameter is missing
-		ResponseObj->SetStringField("status", "error");
-		ResponseObj->SetStringField("message", "Missing 'code' parameter");
-		
-		// Convert JSON to string and send response
-		FString ResponseBody;
-		TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ResponseBody);
-		FJsonSerializer::Serialize(ResponseObj.ToSharedRef(), Writer);
-		
-		OnComplete(FHttpServerResponse::Create(ResponseBody, TEXT("application/json")));
+		Metrics->CountExecuteRequest(false);
+		FPythonServerResponseWriter Writer(Format);
+		Writer.WriteString(TEXT("status"), TEXT("error"));
+		Writer.WriteString(TEXT("message"), TEXT("Invalid priority, expected interactive, normal or batch"));
+		OnComplete(Writer.Finish());
 		return;
 	}
 	
-	// Execute the Python code
-	FString Result = ExecutePythonCode(Code);
+	const double TimeoutSeconds = UEPythonServer::GetRequestTimeout(Request, ExecuteRequest.TimeoutSeconds, DefaultTimeoutSeconds);
 	
-	// Set the response
-	ResponseObj->SetStringField("status", "success");
-	ResponseObj->SetStringField("result", Result);
+	// Stream mode implies async mode, the output is read incrementally from /jobs/{id}/output
+	const bool bStreamOutput = ExecuteRequest.bStream || UEPythonServer::IsQueryFlagSet(Request, TEXT("stream"));
+	const bool bAsync = bStreamOutput || ExecuteRequest.bAsync || UEPythonServer::IsQueryFlagSet(Request, TEXT("async"));
 	
-	// Convert JSON to string
-	FString ResponseBody;
-	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ResponseBody);
-	FJsonSerializer::Serialize(ResponseObj.ToSharedRef(), Writer);
+	// Evaluation mode returns the code's value in the response, which only synchronous requests have
+	const bool bEval = ExecuteRequest.bEval || UEPythonServer::IsQueryFlagSet(Request, TEXT("eval"));
+	if (bEval && bAsync)
+	{
+		Metrics->CountExecuteRequest(false);
+		FPythonServerResponseWriter Writer(Format);
+		Writer.WriteString(TEXT("status"), TEXT("error"));
+		Writer.WriteString(TEXT("message"), TEXT("Evaluation mode is only supported for synchronous requests"));
+		OnComplete(Writer.Finish());
+		return;
+	}
 	
-	// Send response
-	OnComplete(FHttpServerResponse::Create(ResponseBody, TEXT("application/json")));
-}
-
-void FUEPythonServerModule::HandleStatusRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+	if (const FString* CacheKeyParam = Request.QueryParams.Find(TEXT("cache_key")))
+	{
+		ExecuteRequest.CacheKey = *CacheKeyParam;
+	}
+	if (const FString* CacheTtlParam = Request.QueryParams.Find(TEXT("cache_ttl")))
+	{
+		LexFromString(ExecuteRequest.CacheTtlSeconds, **CacheTtlParam);
+	}
+	const double CacheTtlSeconds = FMath::Clamp(ExecuteRequest.CacheTtlSeconds, 0.0, 3600.0);
+	
+	// Sends the result of a synchronous run, CacheOutcome is only reported for cache-keyed requests
+	const bool bCompress = PythonServerProtocol::AcceptsGzip(Request);
+	const bool bMultipart = Format == EPythonServerPayloadFormat::Json && PythonServerProtocol::AcceptsMultipart(Request);
+	auto SendResult = [this, Format, bCompress, bMultipart, OnComplete, RequestStartTime](const FString& Result, int64 NumDropped, const TCHAR* CacheOutcome, bool bTimedOut, const FPythonResultValue* Value)
+	{
+		const double SerializeStartTime = FPlatformTime::Seconds();
+		
+		// Size the body for the result up front, multi-MB outputs are then written in one pass
+		FPythonServerResponseWriter Writer(Format, Result.Len() + 128);
+		if (bTimedOut)
+		{
+			// The result still has the output of the script up to the interrupt
+			Writer.WriteString(TEXT("status"), TEXT("error"));
+			Writer.WriteString(TEXT("message"), TEXT("Execution timed out"));
+			Writer.WriteBool(TEXT("timed_out"), true);
+		}
+		else
+		{
+			Writer.WriteString(TEXT("status"), TEXT("success"));
+		}
+		Writer.WriteString(TEXT("result"), Result);
+		Writer.WriteNumber(TEXT("dropped"), NumDropped);
+		if (CacheOutcome != nullptr)
+		{
+			Writer.WriteString(TEXT("cache"), CacheOutcome);
+		}
+		
+		// The value is written as structured data, its binary parts as raw CBOR byte strings or multipart parts, base64 otherwise
+		const bool bAttachmentParts = bMultipart && Value != nullptr && Value->Attachments.Num() > 0;
+		if (Value != nullptr && Value->Value.IsValid())
+		{
+			Writer.WriteValue(TEXT("value"), Value->Value);
+			Writer.WriteNumber(TEXT("attachment_count"), Value->Attachments.Num());
+			if (Value->Attachments.Num() > 0 && !bAttachmentParts)
+			{
+				Writer.WriteBinaryArray(TEXT("attachments"), Value->Attachments);
+			}
+		}
+		TUniquePtr<FHttpServerResponse> Response = Writer.Finish();
+		if (bAttachmentParts)
+		{
+			Response = PythonServerProtocol::MakeMultipartResponse(MoveTemp(Response), Value->Attachments);
+		}
+		
+		const double EndTime = FPlatformTime::Seconds();
+		Metrics->RecordStage(EPythonServerStage::Serialize, EndTime - SerializeStartTime);
+		Metrics->RecordStage(EPythonServerStage::Total, EndTime - RequestStartTime);
+		UEPythonServer::CompleteResponse(MoveTemp(Response), bCompress, OnComplete);
+	};
+	
+	// Idempotent requests wait for an identical run in flight or reuse a recent result instead of running again
+	FString ResultKey;
+	if (!bAsync && !ExecuteRequest.CacheKey.IsEmpty())
+	{
+		ResultKey = FPythonResultCache::MakeKey(ExecuteRequest.CacheKey, SessionId, ExecuteRequest.Code, bEval);
+		FPythonResultCache::FWaiter Waiter = [this, SendResult](const FPythonCachedResult& Cached, EPythonCacheOutcome Outcome)
+		{
+			// The request that ran the code was counted by its job
+			if (Outcome != EPythonCacheOutcome::Miss)
+			{
+				Metrics->CountExecuteRequest(Cached.bSuccess);
+			}
+			SendResult(Cached.Result, Cached.NumDropped, LexToString(Outcome), Cached.bTimedOut, Cached.Value.Get());
+		};
+		
+		if (ResultCache->FindOrWait(ResultKey, Waiter))
+		{
+			return;
+		}
+		ResultCache->Begin(ResultKey, MoveTemp(Waiter));
+	}
+	
+	TSharedRef<int64> NumDropped = MakeShared<int64>(0);
+	TSharedPtr<FPythonResultValue> Value = bEval ? MakeShared<FPythonResultValue>() : nullptr;
+	FPythonJobQueue::FJobWork Work = [this, Code = MoveTemp(ExecuteRequest.Code), SessionId, bStreamOutput, NumDropped, Value, EnqueueTime = FPlatformTime::Seconds()](FString& OutResult)
+	{
+		Metrics->RecordStage(EPythonServerStage::QueueWait, FPlatformTime::Seconds() - EnqueueTime);
+		
+		bool bSuccess = false;
+		OutResult = ExecutePythonCode(Code, &bSuccess, bStreamOutput, &NumDropped.Get(), SessionId, Value.Get());
+		Metrics->CountExecuteRequest(bSuccess);
+		return bSuccess;
+	};
+	
+	// In async mode, queue the code and return the job id right away
+	if (bAsync)
+	{
+		TSharedPtr<const FPythonJob> Job = JobQueue->Enqueue(MoveTemp(Work), nullptr, bStreamOutput, RequestId, Priority, TimeoutSeconds);
+		
+		FPythonServerResponseWriter Writer(Format);
+		if (Job.IsValid())
+		{
+			Writer.WriteString(TEXT("status"), TEXT("queued"));
+			Writer.WriteString(TEXT("job_id"), Job->Id.ToString(EGuidFormats::DigitsWithHyphensLower));
+			Writer.WriteBool(TEXT("stream"), bStreamOutput);
+		}
+		else
+		{
+			Metrics->CountExecuteRequest(false);
+			Writer.WriteString(TEXT("status"), TEXT("error"));
+			Writer.WriteString(TEXT("message"), TEXT("Job queue is full"));
+		}
+		OnComplete(Writer.Finish());
+		return;
+	}
+	
+	// Otherwise the response is sent once the dispatcher has run the code
+	TSharedPtr<const FPythonJob> Job = JobQueue->Enqueue(MoveTemp(Work), [this, SendResult, ResultKey, CacheTtlSeconds, NumDropped, Value](const FPythonJob& FinishedJob)
+	{
+		if (ResultKey.IsEmpty())
+		{
+			SendResult(FinishedJob.Result, *NumDropped, nullptr, FinishedJob.bTimedOut, Value.Get());
+			return;
+		}
+		
+		// Answers this request and every identical one that arrived while it ran
+		FPythonCachedResult Result;
+		Result.Result = FinishedJob.Result;
+		Result.bSuccess = FinishedJob.State == EPythonJobState::Succeeded;
+		Result.NumDropped = *NumDropped;
+		Result.bTimedOut = FinishedJob.bTimedOut;
+		Result.Value = Value;
+		ResultCache->Complete(ResultKey, Result, CacheTtlSeconds);
+	}, false, RequestId, Priority, TimeoutSeconds);
+	
+	if (!Job.IsValid())
+	{
+		if (!ResultKey.IsEmpty())
+		{
+			ResultCache->Abort(ResultKey);
+		}
+		Metrics->CountExecuteRequest(false);
+		FPythonServerResponseWriter Writer(Format);
+		Writer.WriteString(TEXT("status"), TEXT("error"));
+		Writer.WriteString(TEXT("message"), TEXT("Job queue is full"));
+		OnComplete(Writer.Finish());
+	}
+}
+
+void FUEPythonServerModule::HandleExecuteBatchRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+{
+	const FString RequestId = PythonServerProtocol::GetRequestId(Request);
+	PYTHONSERVER_TRACE_SCOPE("PythonServer.Request execute_batch");
+	PYTHONSERVER_TRACE_BOOKMARK(TEXT("PythonServer.Request execute_batch %s"), *RequestId);
+	
+	// Parse request body
+	TSharedPtr<FJsonObject> RequestObj;
+	if (!UEPythonServer::ParseJsonBody(Request, RequestObj))
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Invalid JSON request"), OnComplete);
+		return;
+	}
+	
+	// Get the scripts from the request
+	const TArray<TSharedPtr<FJsonValue>>* Scripts = nullptr;
+	if (!RequestObj->TryGetArrayField("scripts", Scripts))
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Missing 'scripts' parameter"), OnComplete);
+		return;
+	}
+	
+	bool bStopOnError = false;
+	RequestObj->TryGetBoolField("stop_on_error", bStopOnError);
+	
+	// A transactional batch is one undo step, with the editor's refresh work done once at the end
+	bool bTransaction = false;
+	RequestObj->TryGetBoolField("transaction", bTransaction);
+	FString TransactionName;
+	if (!RequestObj->TryGetStringField("transaction_name", TransactionName) || TransactionName.IsEmpty())
+	{
+		TransactionName = FString::Printf(TEXT("Python Batch (%d scripts)"), Scripts->Num());
+	}
+	
+	// The timeout covers the whole batch, scripts left when it passes are interrupted as they start
+	double BodyTimeout = 0.0;
+	RequestObj->TryGetNumberField("timeout", BodyTimeout);
+	const double TimeoutSeconds = UEPythonServer::GetRequestTimeout(Request, BodyTimeout, DefaultTimeoutSeconds);
+	
+	FString PriorityParam;
+	RequestObj->TryGetStringField("priority", PriorityParam);
+	EPythonJobPriority Priority;
+	if (!UEPythonServer::GetRequestPriority(Request, PriorityParam, Priority))
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Invalid priority, expected interactive, normal or batch"), OnComplete);
+		return;
+	}
+	
+	// Every script of the batch runs in the same session, or in __main__
+	FGuid SessionId;
+	FString SessionParam;
+	if (RequestObj->TryGetStringField("session", SessionParam) && !FGuid::Parse(SessionParam, SessionId))
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Invalid session id"), OnComplete);
+		return;
+	}
+	
+	UE_LOG(LogTemp, Log, TEXT("Received execute batch request %s with %d scripts"), *RequestId, Scripts->Num());
+	
+	// Run every script back-to-back in one job, preserving the order of the request
+	TSharedRef<TArray<TSharedPtr<FJsonValue>>> Results = MakeShared<TArray<TSharedPtr<FJsonValue>>>();
+	TSharedRef<bool> bTransacted = MakeShared<bool>(false);
+	FPythonJobQueue::FJobWork Work = [this, Scripts = *Scripts, SessionId, bStopOnError, bTransaction, TransactionName, Results, bTransacted](FString& OutResult)
+	{
+		Results->Reserve(Scripts.Num());
+		
+		TUniquePtr<FEditorBatchScope> BatchScope;
+		if (bTransaction)
+		{
+			BatchScope = MakeUnique<FEditorBatchScope>(FText::FromString(TransactionName));
+			*bTransacted = BatchScope->IsTransacting();
+		}
+		
+		bool bStopped = false;
+		for (int32 Index = 0; Index < Scripts.Num(); ++Index)
+		{
+			TSharedPtr<FJsonObject> ItemResult = MakeShared<FJsonObject>();
+			const TSharedPtr<FJsonObject>* ScriptObj = nullptr;
+			
+			// Items default to their index when the client did not provide an id
+			FString Id = FString::FromInt(Index);
+			FString Code;
+			if (Scripts[Index]->TryGetObject(ScriptObj))
+			{
+				(*ScriptObj)->TryGetStringField("id", Id);
+			}
+			
+			if (bStopped)
+			{
+				ItemResult->SetStringField("id", Id);
+				ItemResult->SetStringField("status", "skipped");
+			}
+			else if (ScriptObj == nullptr || !(*ScriptObj)->TryGetStringField("code", Code))
+			{
+				ItemResult->SetStringField("id", Id);
+				ItemResult->SetStringField("status", "error");
+				ItemResult->SetStringField("message", "Missing 'code' parameter");
+				bStopped = bStopOnError;
+			}
+			else
+			{
+				PYTHONSERVER_TRACE_SCOPE("PythonServer.Script");
+				PYTHONSERVER_TRACE_BOOKMARK(TEXT("PythonServer.Script %s"), *Id);
+				bool bSuccess = false;
+				int64 NumDropped = 0;
+				FString Result = ExecutePythonCode(Code, &bSuccess, false, &NumDropped, SessionId);
+				
+				ItemResult->SetStringField("id", Id);
+				ItemResult->SetStringField("status", bSuccess ? "success" : "error");
+				ItemResult->SetStringField("result", Result);
+				ItemResult->SetNumberField("dropped", NumDropped);
+				bStopped = !bSuccess && bStopOnError;
+			}
+			
+			Results->Add(MakeShared<FJsonValueObject>(ItemResult));
+		}
+		
+		// Closes the transaction and flushes the deferred editor work, within the job's timings
+		BatchScope.Reset();
+		return !bStopped;
+	};
+	
+	const bool bCompress = PythonServerProtocol::AcceptsGzip(Request);
+	TSharedPtr<const FPythonJob> Job = JobQueue->Enqueue(MoveTemp(Work), [Results, bTransaction, bTransacted, bCompress, OnComplete](const FPythonJob& FinishedJob)
+	{
+		TSharedPtr<FJsonObject> ResponseObj = MakeShared<FJsonObject>();
+		ResponseObj->SetStringField("status", "success");
+		ResponseObj->SetArrayField("results", *Results);
+		if (bTransaction)
+		{
+			ResponseObj->SetBoolField("transaction", *bTransacted);
+		}
+		if (FinishedJob.bTimedOut)
+		{
+			ResponseObj->SetBoolField("timed_out", true);
+		}
+		UEPythonServer::SendJsonResponse(ResponseObj, OnComplete, bCompress);
+	}, false, RequestId, Priority, TimeoutSeconds);
+	
+	if (!Job.IsValid())
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Job queue is full"), OnComplete);
+	}
+}
+
+void FUEPythonServerModule::HandleJobRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+{
+	const FString* IdParam = Request.PathParams.Find(TEXT("id"));
+	FGuid JobId;
+	if (IdParam == nullptr || !FGuid::Parse(*IdParam, JobId))
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Invalid job id"), OnComplete);
+		return;
+	}
+	
+	FPythonJob Job;
+	if (!JobQueue->GetJob(JobId, Job))
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Unknown job id"), OnComplete);
+		return;
+	}
+	
+	TSharedPtr<FJsonObject> ResponseObj = MakeShared<FJsonObject>();
+	ResponseObj->SetStringField("status", "success");
+	ResponseObj->SetStringField("job_id", *IdParam);
+	ResponseObj->SetStringField("state", LexToString(Job.State));
+	ResponseObj->SetStringField("request_id", Job.RequestId);
+	ResponseObj->SetStringField("priority", LexToString(Job.Priority));
+	
+	if (Job.IsFinished())
+	{
+		ResponseObj->SetStringField("result", Job.Result);
+		if (Job.bResultDelivered)
+		{
+			// The result went out in the reply to the request that queued the job
+			ResponseObj->SetBoolField("result_delivered", true);
+		}
+		if (Job.bTimedOut)
+		{
+			ResponseObj->SetBoolField("timed_out", true);
+		}
+		ResponseObj->SetNumberField("queued_ms", (Job.StartTime - Job.EnqueueTime) * 1000.0);
+		ResponseObj->SetNumberField("run_ms", (Job.EndTime - Job.StartTime) * 1000.0);
+	}
+	
+	UEPythonServer::SendJsonResponse(ResponseObj, OnComplete, PythonServerProtocol::AcceptsGzip(Request));
+}
+
+void FUEPythonServerModule::HandleCancelJobRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+{
+	const FString* IdParam = Request.PathParams.Find(TEXT("id"));
+	UEPythonServer::SendJsonResponse(CancelJob(IdParam ? *IdParam : FString()), OnComplete);
+}
+
+TSharedPtr<FJsonObject> FUEPythonServerModule::CancelJob(const FString& JobIdString)
+{
+	TSharedPtr<FJsonObject> ResponseObj = MakeShared<FJsonObject>();
+	FGuid JobId;
+	if (!FGuid::Parse(JobIdString, JobId))
+	{
+		ResponseObj->SetStringField("status", "error");
+		ResponseObj->SetStringField("message", "Invalid job id");
+		return ResponseObj;
+	}
+	
+	uint64 Serial = 0;
+	const EPythonJobCancelResult CancelResult = JobQueue->Cancel(JobId, Serial);
+	switch (CancelResult)
+	{
+	case EPythonJobCancelResult::Unknown:
+		ResponseObj->SetStringField("status", "error");
+		ResponseObj->SetStringField("message", "Unknown job id");
+		return ResponseObj;
+	case EPythonJobCancelResult::Finished:
+		ResponseObj->SetStringField("status", "error");
+		ResponseObj->SetStringField("message", "Job has already finished");
+		return ResponseObj;
+	case EPythonJobCancelResult::Cancelled:
+		ResponseObj->SetStringField("state", "cancelled");
+		break;
+	case EPythonJobCancelResult::Interrupting:
+		// A native operation or an import slice has no Python to interrupt, it is only reported as cancelled
+		ResponseObj->SetStringField("state", "cancelling");
+		ResponseObj->SetBoolField("interrupted", PythonInterrupt::RequestInterrupt(Serial));
+		break;
+	}
+	
+	UE_LOG(LogTemp, Log, TEXT("UEPythonServer cancelled job %s"), *JobIdString);
+	ResponseObj->SetStringField("status", "success");
+	ResponseObj->SetStringField("job_id", JobIdString);
+	return ResponseObj;
+}
+
+void FUEPythonServerModule::HandleJobOutputRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+{
+	const FString* IdParam = Request.PathParams.Find(TEXT("id"));
+	int64 Offset = 0;
+	if (const FString* OffsetParam = Request.QueryParams.Find(TEXT("offset")))
+	{
+		LexFromString(Offset, **OffsetParam);
+	}
+	
+	UEPythonServer::SendJsonResponse(ReadJobOutput(IdParam ? *IdParam : FString(), Offset), OnComplete, PythonServerProtocol::AcceptsGzip(Request));
+}
+
+TSharedPtr<FJsonObject> FUEPythonServerModule::ReadJobOutput(const FString& JobIdString, int64 Offset)
+{
+	TSharedPtr<FJsonObject> ResponseObj = MakeShared<FJsonObject>();
+	FGuid JobId;
+	if (!FGuid::Parse(JobIdString, JobId))
+	{
+		ResponseObj->SetStringField("status", "error");
+		ResponseObj->SetStringField("message", "Invalid job id");
+		return ResponseObj;
+	}
+	
+	// The stream buffer is guarded by the queue's mutex and filled while the script runs
+	FPythonJobOutputChunk Chunk;
+	if (!JobQueue->ReadStreamedOutput(JobId, Offset, Chunk))
+	{
+		ResponseObj->SetStringField("status", "error");
+		ResponseObj->SetStringField("message", "Unknown job id or job output is not streamed");
+		return ResponseObj;
+	}
+	
+	ResponseObj->SetStringField("status", "success");
+	ResponseObj->SetStringField("job_id", JobIdString);
+	ResponseObj->SetStringField("state", LexToString(Chunk.State));
+	ResponseObj->SetStringField("output", Chunk.Output);
+	ResponseObj->SetNumberField("offset", Chunk.Offset);
+	ResponseObj->SetNumberField("next_offset", Chunk.NextOffset);
+	ResponseObj->SetNumberField("dropped", Chunk.NumDropped);
+	return ResponseObj;
+}
+
+void FUEPythonServerModule::HandleRegisterScriptRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+{
+	TSharedPtr<FJsonObject> RequestObj;
+	if (!UEPythonServer::ParseJsonBody(Request, RequestObj))
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Invalid JSON request"), OnComplete);
+		return;
+	}
+	
+	FString Name;
+	FString Code;
+	if (!RequestObj->TryGetStringField("name", Name) || !RequestObj->TryGetStringField("code", Code))
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Missing 'name' or 'code' parameter"), OnComplete);
+		return;
+	}
+	
+	if (!FPythonScriptRegistry::IsValidName(Name))
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Script names may only contain letters, digits, '_', '-' and '.'"), OnComplete);
+		return;
+	}
+	
+	// Compile right away so syntax errors are reported at registration
+	FPythonJobQueue::FJobWork Work = [this, Name, Code](FString& OutResult)
+	{
+		bool bSuccess = false;
+		OutResult = RunPython([this, &Name, &Code]()
+		{
+			return ScriptRegistry->Register(Name, Code);
+		}, &bSuccess);
+		return bSuccess;
+	};
+	
+	TSharedPtr<const FPythonJob> Job = JobQueue->Enqueue(MoveTemp(Work), [Name, OnComplete](const FPythonJob& FinishedJob)
+	{
+		if (FinishedJob.State != EPythonJobState::Succeeded)
+		{
+			UEPythonServer::SendErrorResponse(FinishedJob.Result, OnComplete);
+			return;
+		}
+		
+		TSharedPtr<FJsonObject> ResponseObj = MakeShared<FJsonObject>();
+		ResponseObj->SetStringField("status", "success");
+		ResponseObj->SetStringField("name", Name);
+		UEPythonServer::SendJsonResponse(ResponseObj, OnComplete);
+	});
+	
+	if (!Job.IsValid())
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Job queue is full"), OnComplete);
+	}
+}
+
+void FUEPythonServerModule::HandleInvokeScriptRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+{
+	const FString RequestId = PythonServerProtocol::GetRequestId(Request);
+	PYTHONSERVER_TRACE_SCOPE("PythonServer.Request invoke");
+	PYTHONSERVER_TRACE_BOOKMARK(TEXT("PythonServer.Request invoke %s"), *RequestId);
+	
+	const FString* NameParam = Request.PathParams.Find(TEXT("name"));
+	if (NameParam == nullptr || !FPythonScriptRegistry::IsValidName(*NameParam))
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Invalid script name"), OnComplete);
+		return;
+	}
+	
+	// An empty body invokes the script without arguments
+	FString ArgsJson = TEXT("{}");
+	FString PriorityParam;
+	double BodyTimeout = 0.0;
+	if (Request.Body.Num() > 0)
+	{
+		TSharedPtr<FJsonObject> RequestObj;
+		if (!UEPythonServer::ParseJsonBody(Request, RequestObj))
+		{
+			UEPythonServer::SendErrorResponse(TEXT("Invalid JSON request"), OnComplete);
+			return;
+		}
+		
+		const TSharedPtr<FJsonObject>* ArgsObj = nullptr;
+		if (RequestObj->TryGetObjectField("args", ArgsObj))
+		{
+			ArgsJson.Reset();
+			TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&ArgsJson);
+			FJsonSerializer::Serialize(ArgsObj->ToSharedRef(), Writer);
+		}
+		RequestObj->TryGetStringField("priority", PriorityParam);
+		RequestObj->TryGetNumberField("timeout", BodyTimeout);
+	}
+	
+	EPythonJobPriority Priority;
+	if (!UEPythonServer::GetRequestPriority(Request, PriorityParam, Priority))
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Invalid priority, expected interactive, normal or batch"), OnComplete);
+		return;
+	}
+	
+	FPythonJobQueue::FJobWork Work = [this, Name = *NameParam, ArgsJson](FString& OutResult)
+	{
+		bool bSuccess = false;
+		OutResult = InvokeRegisteredScript(Name, ArgsJson, &bSuccess);
+		return bSuccess;
+	};
+	
+	TSharedPtr<const FPythonJob> Job = JobQueue->Enqueue(MoveTemp(Work), [OnComplete](const FPythonJob& FinishedJob)
+	{
+		TSharedPtr<FJsonObject> ResponseObj = MakeShared<FJsonObject>();
+		ResponseObj->SetStringField("status", FinishedJob.State == EPythonJobState::Succeeded ? "success" : "error");
+		ResponseObj->SetStringField("result", FinishedJob.Result);
+		if (FinishedJob.bTimedOut)
+		{
+			ResponseObj->SetBoolField("timed_out", true);
+		}
+		UEPythonServer::SendJsonResponse(ResponseObj, OnComplete);
+	}, false, RequestId, Priority, UEPythonServer::GetRequestTimeout(Request, BodyTimeout, DefaultTimeoutSeconds));
+	
+	if (!Job.IsValid())
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Job queue is full"), OnComplete);
+	}
+}
+
+void FUEPythonServerModule::HandleUploadRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+{
+	const FString RequestId = PythonServerProtocol::GetRequestId(Request);
+	PYTHONSERVER_TRACE_SCOPE("PythonServer.Request upload");
+	PYTHONSERVER_TRACE_BOOKMARK(TEXT("PythonServer.Request upload %s"), *RequestId);
+	
+	FString FileName;
+	if (const FString* FileNameParam = Request.QueryParams.Find(TEXT("filename")))
+	{
+		FileName = *FileNameParam;
+	}
+	
+	// The file is either the raw body or the first file part of a multipart form, located in place
+	int32 DataOffset = 0;
+	int32 DataLength = Request.Body.Num();
+	FString Boundary;
+	if (PythonServerProtocol::GetMultipartBoundary(Request, Boundary))
+	{
+		FString PartFileName;
+		if (!PythonServerProtocol::FindMultipartFile(Request.Body, Boundary, PartFileName, DataOffset, DataLength))
+		{
+			UEPythonServer::SendErrorResponse(TEXT("Invalid multipart request, expected a file part"), OnComplete);
+			return;
+		}
+		
+		if (FileName.IsEmpty())
+		{
+			FileName = FPaths::GetCleanFilename(PartFileName);
+		}
+	}
+	
+	if (!FAssetUploadStaging::IsValidFileName(FileName))
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Missing or invalid 'filename' parameter"), OnComplete);
+		return;
+	}
+	
+	if (DataLength == 0)
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Empty upload"), OnComplete);
+		return;
+	}
+	
+	UE_LOG(LogTemp, Log, TEXT("Received upload of %s (%d bytes)"), *FileName, DataLength);
+	
+	TSharedPtr<const FStagedUpload> Upload = UploadStaging->Stage(FileName, TArrayView<const uint8>(Request.Body.GetData() + DataOffset, DataLength));
+	if (!Upload.IsValid())
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Upload staging area is full"), OnComplete);
+		return;
+	}
+	
+	// With ?import=0 the upload stays staged, to be imported later by its id
+	if (!UEPythonServer::GetQueryFlag(Request, TEXT("import"), true))
+	{
+		TSharedPtr<FJsonObject> ResponseObj = MakeShared<FJsonObject>();
+		ResponseObj->SetStringField("status", "staged");
+		ResponseObj->SetStringField("upload_id", Upload->Id.ToString(EGuidFormats::DigitsWithHyphensLower));
+		ResponseObj->SetStringField("filename", Upload->FileName);
+		ResponseObj->SetNumberField("bytes", Upload->Data.Num());
+		UEPythonServer::SendJsonResponse(ResponseObj, OnComplete);
+		return;
+	}
+	
+	FStagedUploadImportOptions Options;
+	if (const FString* DestinationParam = Request.QueryParams.Find(TEXT("destination")))
+	{
+		Options.DestinationPath = *DestinationParam;
+	}
+	if (const FString* NameParam = Request.QueryParams.Find(TEXT("name")))
+	{
+		Options.AssetName = *NameParam;
+	}
+	Options.bReplaceExisting = UEPythonServer::GetQueryFlag(Request, TEXT("replace"), true);
+	Options.bSave = UEPythonServer::GetQueryFlag(Request, TEXT("save"), false);
+	
+	// Import on the game thread, in order with the Python work already queued
+	struct FImportResult
+	{
+		TArray<FString> ObjectPaths;
+		bool bFromMemory = false;
+	};
+	TSharedRef<FImportResult> ImportResult = MakeShared<FImportResult>();
+	
+	FPythonJobQueue::FJobWork Work = [this, Upload, Options, ImportResult](FString& OutResult)
+	{
+		const bool bSuccess = FAssetUploadStaging::Import(*Upload, Options, ImportResult->ObjectPaths, ImportResult->bFromMemory, OutResult);
+		UploadStaging->Release(Upload->Id);
+		return bSuccess;
+	};
+	
+	TSharedPtr<const FPythonJob> Job = JobQueue->Enqueue(MoveTemp(Work), [Upload, ImportResult, OnComplete](const FPythonJob& FinishedJob)
+	{
+		if (FinishedJob.State != EPythonJobState::Succeeded)
+		{
+			UEPythonServer::SendErrorResponse(FinishedJob.Result, OnComplete);
+			return;
+		}
+		
+		TArray<TSharedPtr<FJsonValue>> Imported;
+		for (const FString& ObjectPath : ImportResult->ObjectPaths)
+		{
+			Imported.Add(MakeShared<FJsonValueString>(ObjectPath));
+		}
+		
+		TSharedPtr<FJsonObject> ResponseObj = MakeShared<FJsonObject>();
+		ResponseObj->SetStringField("status", "success");
+		ResponseObj->SetStringField("upload_id", Upload->Id.ToString(EGuidFormats::DigitsWithHyphensLower));
+		ResponseObj->SetStringField("filename", Upload->FileName);
+		ResponseObj->SetNumberField("bytes", Upload->Data.Num());
+		ResponseObj->SetBoolField("in_memory", ImportResult->bFromMemory);
+		ResponseObj->SetArrayField("imported", Imported);
+		UEPythonServer::SendJsonResponse(ResponseObj, OnComplete);
+	}, false, RequestId);
+	
+	if (!Job.IsValid())
+	{
+		UploadStaging->Release(Upload->Id);
+		UEPythonServer::SendErrorResponse(TEXT("Job queue is full"), OnComplete);
+	}
+}
+
+void FUEPythonServerModule::HandleImportBatchRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+{
+	PYTHONSERVER_TRACE_SCOPE("PythonServer.Request import_batch");
+	PYTHONSERVER_TRACE_BOOKMARK(TEXT("PythonServer.Request import_batch %s"), *PythonServerProtocol::GetRequestId(Request));
+	
+	TSharedPtr<FJsonObject> RequestObj;
+	if (!UEPythonServer::ParseJsonBody(Request, RequestObj))
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Invalid JSON request"), OnComplete);
+		return;
+	}
+	
+	const TArray<TSharedPtr<FJsonValue>>* ItemValues = nullptr;
+	if (!RequestObj->TryGetArrayField("items", ItemValues) || ItemValues->Num() == 0)
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Missing 'items' parameter"), OnComplete);
+		return;
+	}
+	
+	// Batch-wide defaults, items may override the destination
+	FString DefaultDestination = TEXT("/Game/Uploads");
+	bool bReplaceExisting = true;
+	bool bSave = true;
+	int32 SliceSize = 16;
+	RequestObj->TryGetStringField("destination", DefaultDestination);
+	RequestObj->TryGetBoolField("replace", bReplaceExisting);
+	RequestObj->TryGetBoolField("save", bSave);
+	RequestObj->TryGetNumberField("slice_size", SliceSize);
+	
+	TArray<FAssetImportBatchItem> Items;
+	Items.Reserve(ItemValues->Num());
+	for (int32 Index = 0; Index < ItemValues->Num(); ++Index)
+	{
+		const TSharedPtr<FJsonObject>* ItemObj = nullptr;
+		if (!(*ItemValues)[Index]->TryGetObject(ItemObj))
+		{
+			UEPythonServer::SendErrorResponse(FString::Printf(TEXT("Item %d is not an object"), Index), OnComplete);
+			return;
+		}
+		
+		FAssetImportBatchItem& Item = Items.AddDefaulted_GetRef();
+		Item.Id = FString::FromInt(Index);
+		Item.DestinationPath = DefaultDestination;
+		(*ItemObj)->TryGetStringField("id", Item.Id);
+		(*ItemObj)->TryGetStringField("filename", Item.FileName);
+		(*ItemObj)->TryGetStringField("destination", Item.DestinationPath);
+		(*ItemObj)->TryGetStringField("name", Item.AssetName);
+		
+		FString UploadId;
+		if ((*ItemObj)->TryGetStringField("upload_id", UploadId) && !FGuid::Parse(UploadId, Item.UploadId))
+		{
+			UEPythonServer::SendErrorResponse(FString::Printf(TEXT("Item %s has an invalid 'upload_id'"), *Item.Id), OnComplete);
+			return;
+		}
+		
+		if (Item.FileName.IsEmpty() && !Item.UploadId.IsValid())
+		{
+			UEPythonServer::SendErrorResponse(FString::Printf(TEXT("Item %s needs a 'filename' or an 'upload_id'"), *Item.Id), OnComplete);
+			return;
+		}
+	}
+	
+	UE_LOG(LogTemp, Log, TEXT("Received import batch request with %d items"), Items.Num());
+	
+	TSharedRef<FAssetImportBatch> Batch = MakeShared<FAssetImportBatch>(MoveTemp(Items), bReplaceExisting, bSave, SliceSize);
+	
+	// Keep the progress of the most recent batches readable
+	const int32 MaxRetainedBatches = 64;
+	ImportBatches.Add(Batch->GetId(), Batch);
+	ImportBatchIds.Add(Batch->GetId());
+	if (ImportBatchIds.Num() > MaxRetainedBatches)
+	{
+		ImportBatches.Remove(ImportBatchIds[0]);
+		ImportBatchIds.RemoveAt(0);
+	}
+	
+	EnqueueImportSlice(Batch);
+	
+	TSharedPtr<FJsonObject> ResponseObj = MakeShared<FJsonObject>();
+	ResponseObj->SetStringField("status", "queued");
+	ResponseObj->SetStringField("batch_id", Batch->GetId().ToString(EGuidFormats::DigitsWithHyphensLower));
+	ResponseObj->SetNumberField("total", Batch->GetItems().Num());
+	UEPythonServer::SendJsonResponse(ResponseObj, OnComplete);
+}
+
+void FUEPythonServerModule::EnqueueImportSlice(const TSharedRef<FAssetImportBatch>& Batch)
+{
+	// One slice per job, so other work and progress reads get a turn between slices
+	FPythonJobQueue::FJobWork Work = [this, Batch](FString& OutResult)
+	{
+		Batch->ImportNextSlice(*UploadStaging);
+		return true;
+	};
+	
+	TSharedPtr<const FPythonJob> Job = JobQueue->Enqueue(MoveTemp(Work), [this, Batch](const FPythonJob& FinishedJob)
+	{
+		if (!Batch->IsFinished())
+		{
+			EnqueueImportSlice(Batch);
+		}
+	}, false, Batch->GetId().ToString(EGuidFormats::DigitsWithHyphensLower), EPythonJobPriority::Batch);
+	
+	if (!Job.IsValid())
+	{
+		Batch->Abort(TEXT("Job queue is full"));
+	}
+}
+
+void FUEPythonServerModule::HandleImportBatchProgressRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+{
+	const FString* IdParam = Request.PathParams.Find(TEXT("id"));
+	FGuid BatchId;
+	if (IdParam == nullptr || !FGuid::Parse(*IdParam, BatchId))
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Invalid batch id"), OnComplete);
+		return;
+	}
+	
+	const TSharedPtr<FAssetImportBatch>* Batch = ImportBatches.Find(BatchId);
+	if (Batch == nullptr)
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Unknown batch id"), OnComplete);
+		return;
+	}
+	
+	int32 NumImported = 0;
+	int32 NumFailed = 0;
+	TArray<TSharedPtr<FJsonValue>> ItemResults;
+	ItemResults.Reserve((*Batch)->GetItems().Num());
+	for (const FAssetImportBatchItem& Item : (*Batch)->GetItems())
+	{
+		TSharedPtr<FJsonObject> ItemObj = MakeShared<FJsonObject>();
+		ItemObj->SetStringField("id", Item.Id);
+		ItemObj->SetStringField("state", LexToString(Item.State));
+		
+		if (Item.State == EAssetImportItemState::Imported)
+		{
+			TArray<TSharedPtr<FJsonValue>> Imported;
+			for (const FString& ObjectPath : Item.ObjectPaths)
+			{
+				Imported.Add(MakeShared<FJsonValueString>(ObjectPath));
+			}
+			ItemObj->SetArrayField("imported", Imported);
+			++NumImported;
+		}
+		else if (Item.State == EAssetImportItemState::Failed)
+		{
+			ItemObj->SetStringField("error", Item.Error);
+			++NumFailed;
+		}
+		
+		ItemResults.Add(MakeShared<FJsonValueObject>(ItemObj));
+	}
+	
+	TSharedPtr<FJsonObject> ResponseObj = MakeShared<FJsonObject>();
+	ResponseObj->SetStringField("status", "success");
+	ResponseObj->SetStringField("batch_id", *IdParam);
+	ResponseObj->SetStringField("state", (*Batch)->IsFinished() ? "finished" : "running");
+	ResponseObj->SetNumberField("total", (*Batch)->GetItems().Num());
+	ResponseObj->SetNumberField("completed", (*Batch)->GetNumCompleted());
+	ResponseObj->SetNumberField("imported", NumImported);
+	ResponseObj->SetNumberField("failed", NumFailed);
+	if ((*Batch)->IsFinished())
+	{
+		ResponseObj->SetBoolField("saved", (*Batch)->HasSaved());
+	}
+	ResponseObj->SetArrayField("items", ItemResults);
+	UEPythonServer::SendJsonResponse(ResponseObj, OnComplete);
+}
+
+void FUEPythonServerModule::HandleSpawnActorRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+{
+	TSharedPtr<FJsonObject> RequestObj;
+	if (!UEPythonServer::ParseJsonBody(Request, RequestObj))
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Invalid JSON request"), OnComplete);
+		return;
+	}
+	
+	EnqueueNativeOperation(TEXT("spawn_actor"), Request, [RequestObj](FJsonObject& OutResponse, FString& OutError)
+	{
+		return SceneFastPath::SpawnActor(*RequestObj, OutResponse, OutError);
+	}, OnComplete);
+}
+
+void FUEPythonServerModule::HandleActorTransformRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+{
+	TSharedPtr<FJsonObject> RequestObj;
+	if (!UEPythonServer::ParseJsonBody(Request, RequestObj))
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Invalid JSON request"), OnComplete);
+		return;
+	}
+	
+	EnqueueNativeOperation(TEXT("set_actor_transform"), Request, [RequestObj](FJsonObject& OutResponse, FString& OutError)
+	{
+		return SceneFastPath::SetActorTransforms(*RequestObj, OutResponse, OutError);
+	}, OnComplete);
+}
+
+void FUEPythonServerModule::HandleMaterialParameterRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+{
+	TSharedPtr<FJsonObject> RequestObj;
+	if (!UEPythonServer::ParseJsonBody(Request, RequestObj))
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Invalid JSON request"), OnComplete);
+		return;
+	}
+	
+	EnqueueNativeOperation(TEXT("set_material_parameter"), Request, [RequestObj](FJsonObject& OutResponse, FString& OutError)
+	{
+		return SceneFastPath::SetMaterialParameter(*RequestObj, OutResponse, OutError);
+	}, OnComplete);
+}
+
+void FUEPythonServerModule::HandleListActorsRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+{
+	FString ClassName;
+	if (const FString* ClassParam = Request.QueryParams.Find(TEXT("class")))
+	{
+		ClassName = *ClassParam;
+	}
+	
+	int32 MaxActors = 10000;
+	if (const FString* LimitParam = Request.QueryParams.Find(TEXT("limit")))
+	{
+		LexFromString(MaxActors, **LimitParam);
+	}
+	
+	EnqueueNativeOperation(TEXT("list_actors"), Request, [this, ClassName, MaxActors](FJsonObject& OutResponse, FString& OutError)
+	{
+		// The journal position of the listing, to follow the level with /scene/changes from there
+		OutResponse.SetNumberField("sequence", SceneJournal->GetSequence());
+		return SceneFastPath::ListActors(ClassName, MaxActors, OutResponse, OutError);
+	}, OnComplete);
+}
+
+void FUEPythonServerModule::HandleSceneChangesRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+{
+	uint64 Since = 0;
+	if (const FString* SinceParam = Request.QueryParams.Find(TEXT("since")))
+	{
+		LexFromString(Since, **SinceParam);
+	}
+	
+	int32 MaxChanges = 10000;
+	if (const FString* LimitParam = Request.QueryParams.Find(TEXT("limit")))
+	{
+		LexFromString(MaxChanges, **LimitParam);
+	}
+	
+	// A limit that is not positive or does not parse would return empty pages flagged "more"
+	MaxChanges = FMath::Clamp(MaxChanges, 1, 10000);
+	
+	// The journal is only written on the game thread, which is where requests are handled, so read it directly
+	TArray<FSceneChange> Changes;
+	const bool bInJournal = SceneJournal->GetChangesSince(Since, MaxChanges, Changes);
+	const bool bMore = bInJournal && Changes.Num() > 0 && Changes.Num() == MaxChanges && Changes.Last().Sequence < SceneJournal->GetSequence();
+	
+	TArray<TSharedPtr<FJsonValue>> ChangeValues;
+	ChangeValues.Reserve(Changes.Num());
+	for (const FSceneChange& Change : Changes)
+	{
+		TSharedPtr<FJsonObject> ChangeObj = MakeShared<FJsonObject>();
+		ChangeObj->SetNumberField("sequence", Change.Sequence);
+		ChangeObj->SetStringField("type", LexToString(Change.Type));
+		ChangeObj->SetStringField("name", Change.Name);
+		
+		if (Change.Type != ESceneChangeType::Removed)
+		{
+			const FVector Location = Change.Transform.GetLocation();
+			const FRotator Rotation = Change.Transform.Rotator();
+			const FVector Scale = Change.Transform.GetScale3D();
+			ChangeObj->SetStringField("label", Change.Label);
+			ChangeObj->SetStringField("class", Change.ClassName);
+			ChangeObj->SetArrayField("location", { MakeShared<FJsonValueNumber>(Location.X), MakeShared<FJsonValueNumber>(Location.Y), MakeShared<FJsonValueNumber>(Location.Z) });
+			ChangeObj->SetArrayField("rotation", { MakeShared<FJsonValueNumber>(Rotation.Pitch), MakeShared<FJsonValueNumber>(Rotation.Yaw), MakeShared<FJsonValueNumber>(Rotation.Roll) });
+			ChangeObj->SetArrayField("scale", { MakeShared<FJsonValueNumber>(Scale.X), MakeShared<FJsonValueNumber>(Scale.Y), MakeShared<FJsonValueNumber>(Scale.Z) });
+		}
+		
+		ChangeValues.Add(MakeShared<FJsonValueObject>(ChangeObj));
+	}
+	
+	TSharedPtr<FJsonObject> ResponseObj = MakeShared<FJsonObject>();
+	ResponseObj->SetStringField("status", "success");
+	ResponseObj->SetNumberField("since", Since);
+	ResponseObj->SetNumberField("next_since", bMore ? Changes.Last().Sequence : SceneJournal->GetSequence());
+	ResponseObj->SetBoolField("more", bMore);
+	ResponseObj->SetBoolField("reset", !bInJournal);
+	ResponseObj->SetArrayField("changes", ChangeValues);
+	UEPythonServer::SendJsonResponse(ResponseObj, OnComplete);
+}
+
+void FUEPythonServerModule::HandleCaptureRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+{
+	const FString RequestId = PythonServerProtocol::GetRequestId(Request);
+	PYTHONSERVER_TRACE_SCOPE("PythonServer.Request capture");
+	PYTHONSERVER_TRACE_BOOKMARK(TEXT("PythonServer.Request capture %s"), *RequestId);
+	
+	FSceneCaptureSettings Settings;
+	FString SettingsError;
+	if (!FSceneCaptureReadback::ParseSettings(Request, Settings, SettingsError))
+	{
+		UEPythonServer::SendErrorResponse(SettingsError, OnComplete);
+		return;
+	}
+	
+	EPythonJobPriority Priority;
+	if (!UEPythonServer::GetRequestPriority(Request, FString(), Priority))
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Invalid priority, expected interactive, normal or batch"), OnComplete);
+		return;
+	}
+	
+	// The job only queues the render, the response is sent from the tick once the readback is done
+	FPythonJobQueue::FJobWork Work = [this, Settings, OnComplete](FString& OutResult)
+	{
+		return CaptureReadback->Begin(Settings, OnComplete, OutResult);
+	};
+	
+	TSharedPtr<const FPythonJob> Job = JobQueue->Enqueue(MoveTemp(Work), [OnComplete](const FPythonJob& FinishedJob)
+	{
+		if (FinishedJob.State != EPythonJobState::Succeeded)
+		{
+			UEPythonServer::SendErrorResponse(FinishedJob.Result, OnComplete);
+		}
+	}, false, RequestId, Priority);
+	
+	if (!Job.IsValid())
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Job queue is full"), OnComplete);
+	}
+}
+
+void FUEPythonServerModule::HandleStreamMeshRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+{
+	const FString* NameParam = Request.PathParams.Find(TEXT("name"));
+	if (NameParam == nullptr || NameParam->IsEmpty())
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Missing mesh name"), OnComplete);
+		return;
+	}
+	
+	const FString* SpaceParam = Request.QueryParams.Find(TEXT("space"));
+	if (SpaceParam && *SpaceParam != TEXT("blender") && *SpaceParam != TEXT("unreal"))
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Invalid space, expected blender or unreal"), OnComplete);
+		return;
+	}
+	
+	// The buffers are decoded here and only applied in the job, shared since the work must be copyable
+	TSharedRef<FMeshStreamUpdate> Update = MakeShared<FMeshStreamUpdate>();
+	FString ParseError;
+	if (!FMeshStreamRegistry::ParseUpdate(Request.Body, SpaceParam && *SpaceParam == TEXT("blender"), *Update, ParseError))
+	{
+		UEPythonServer::SendErrorResponse(ParseError, OnComplete);
+		return;
+	}
+	
+	FMeshStreamOptions Options;
+	if (const FString* MaterialParam = Request.QueryParams.Find(TEXT("material")))
+	{
+		Options.Material = *MaterialParam;
+	}
+	if (Request.QueryParams.Contains(TEXT("collision")))
+	{
+		Options.Collision = UEPythonServer::IsQueryFlagSet(Request, TEXT("collision"));
+	}
+	
+	EnqueueNativeOperation(TEXT("stream_mesh"), Request, [this, Name = *NameParam, Update, Options](FJsonObject& OutResponse, FString& OutError)
+	{
+		return MeshStreams->Apply(Name, *Update, Options, OutResponse, OutError);
+	}, OnComplete);
+}
+
+void FUEPythonServerModule::HandleRemoveMeshRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+{
+	const FString* NameParam = Request.PathParams.Find(TEXT("name"));
+	if (NameParam == nullptr || NameParam->IsEmpty())
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Missing mesh name"), OnComplete);
+		return;
+	}
+	
+	EnqueueNativeOperation(TEXT("remove_mesh"), Request, [this, Name = *NameParam](FJsonObject& OutResponse, FString& OutError)
+	{
+		if (!MeshStreams->Remove(Name))
+		{
+			OutError = FString::Printf(TEXT("Unknown mesh '%s'"), *Name);
+			return false;
+		}
+		OutResponse.SetStringField("name", Name);
+		return true;
+	}, OnComplete);
+}
+
+void FUEPythonServerModule::EnqueueNativeOperation(const TCHAR* Name, const FHttpServerRequest& Request, TFunction<bool(FJsonObject&, FString&)> Operation, const FHttpResultCallback& OnComplete)
+{
+	const FString RequestId = PythonServerProtocol::GetRequestId(Request);
+	PYTHONSERVER_TRACE_SCOPE_TEXT(TEXT("PythonServer.Request %s"), Name);
+	PYTHONSERVER_TRACE_BOOKMARK(TEXT("PythonServer.Request %s %s"), Name, *RequestId);
+	
+	EPythonJobPriority Priority;
+	if (!UEPythonServer::GetRequestPriority(Request, FString(), Priority))
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Invalid priority, expected interactive, normal or batch"), OnComplete);
+		return;
+	}
+	
+	TSharedRef<FJsonObject> ResponseObj = MakeShared<FJsonObject>();
+	FPythonJobQueue::FJobWork Work = [Name, Operation = MoveTemp(Operation), ResponseObj](FString& OutResult)
+	{
+		PYTHONSERVER_TRACE_SCOPE_TEXT(TEXT("PythonServer.Native %s"), Name);
+		return Operation(*ResponseObj, OutResult);
+	};
+	
+	TSharedPtr<const FPythonJob> Job = JobQueue->Enqueue(MoveTemp(Work), [ResponseObj, OnComplete](const FPythonJob& FinishedJob)
+	{
+		if (FinishedJob.State != EPythonJobState::Succeeded)
+		{
+			UEPythonServer::SendErrorResponse(FinishedJob.Result, OnComplete);
+			return;
+		}
+		
+		ResponseObj->SetStringField("status", "success");
+		UEPythonServer::SendJsonResponse(ResponseObj, OnComplete);
+	}, false, RequestId, Priority);
+	
+	if (!Job.IsValid())
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Job queue is full"), OnComplete);
+	}
+}
+
+void FUEPythonServerModule::HandleCreateSessionRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+{
+	// The body is optional, it only names the session
+	FString Name;
+	if (Request.Body.Num() > 0)
+	{
+		TSharedPtr<FJsonObject> RequestObj;
+		if (!UEPythonServer::ParseJsonBody(Request, RequestObj))
+		{
+			UEPythonServer::SendErrorResponse(TEXT("Invalid JSON request"), OnComplete);
+			return;
+		}
+		RequestObj->TryGetStringField("name", Name);
+	}
+	
+	EnqueueNativeOperation(TEXT("create_session"), Request, [this, Name](FJsonObject& OutResponse, FString& OutError)
+	{
+		if (!FPythonScriptPlugin::Get()->IsPythonAvailable())
+		{
+			OutError = TEXT("Python is not available in this Unreal Engine instance");
+			return false;
+		}
+		
+		FPyScopedGIL GIL;
+		const FGuid SessionId = Sessions->Create(Name);
+		if (!SessionId.IsValid())
+		{
+			OutError = FString::Printf(TEXT("Too many sessions, close one first (at most %d)"), Sessions->GetMaxSessions());
+			return false;
+		}
+		
+		OutResponse.SetStringField("session_id", SessionId.ToString(EGuidFormats::DigitsWithHyphensLower));
+		OutResponse.SetNumberField("idle_timeout_seconds", Sessions->GetIdleTimeoutSeconds());
+		return true;
+	}, OnComplete);
+}
+
+void FUEPythonServerModule::HandleListSessionsRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+{
+	EnqueueNativeOperation(TEXT("list_sessions"), Request, [this](FJsonObject& OutResponse, FString& OutError)
+	{
+		TArray<TSharedPtr<FJsonValue>> SessionValues;
+		if (Sessions->GetNum() > 0)
+		{
+			FPyScopedGIL GIL;
+			for (const FPythonSessionInfo& Info : Sessions->GetSessions())
+			{
+				TSharedPtr<FJsonObject> SessionObj = MakeShared<FJsonObject>();
+				SessionObj->SetStringField("session_id", Info.Id.ToString(EGuidFormats::DigitsWithHyphensLower));
+				SessionObj->SetStringField("name", Info.Name);
+				SessionObj->SetNumberField("idle_seconds", Info.IdleSeconds);
+				SessionObj->SetNumberField("globals", Info.NumGlobals);
+				SessionObj->SetNumberField("runs", Info.NumRuns);
+				SessionValues.Add(MakeShared<FJsonValueObject>(SessionObj));
+			}
+		}
+		
+		OutResponse.SetArrayField("sessions", SessionValues);
+		OutResponse.SetNumberField("idle_timeout_seconds", Sessions->GetIdleTimeoutSeconds());
+		return true;
+	}, OnComplete);
+}
+
+void FUEPythonServerModule::HandleCloseSessionRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+{
+	const FString* IdParam = Request.PathParams.Find(TEXT("id"));
+	FGuid SessionId;
+	if (IdParam == nullptr || !FGuid::Parse(*IdParam, SessionId))
+	{
+		UEPythonServer::SendErrorResponse(TEXT("Invalid session id"), OnComplete);
+		return;
+	}
+	
+	// Closed through the dispatcher, so work already queued for the session still runs in it
+	EnqueueNativeOperation(TEXT("close_session"), Request, [this, SessionId](FJsonObject& OutResponse, FString& OutError)
+	{
+		bool bRemoved = false;
+		if (Sessions->GetNum() > 0)
+		{
+			FPyScopedGIL GIL;
+			bRemoved = Sessions->Remove(SessionId);
+		}
+		
+		if (!bRemoved)
+		{
+			OutError = TEXT("Unknown session id");
+			return false;
+		}
+		return true;
+	}, OnComplete);
+}
+
+bool FUEPythonServerModule::DispatchWebSocketRequest(const FString& Type, const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+{
+	if (Type == TEXT("execute"))
+	{
+		HandleExecuteRequest(Request, OnComplete);
+	}
+	else if (Type == TEXT("execute_batch"))
+	{
+		HandleExecuteBatchRequest(Request, OnComplete);
+	}
+	else if (Type == TEXT("status"))
+	{
+		HandleStatusRequest(Request, OnComplete);
+	}
+	else if (Type == TEXT("job"))
+	{
+		HandleJobRequest(Request, OnComplete);
+	}
+	else if (Type == TEXT("job_output"))
+	{
+		HandleJobOutputRequest(Request, OnComplete);
+	}
+	else if (Type == TEXT("cancel_job"))
+	{
+		HandleCancelJobRequest(Request, OnComplete);
+	}
+	else if (Type == TEXT("register_script"))
+	{
+		HandleRegisterScriptRequest(Request, OnComplete);
+	}
+	else if (Type == TEXT("invoke"))
+	{
+		HandleInvokeScriptRequest(Request, OnComplete);
+	}
+	else if (Type == TEXT("import_batch"))
+	{
+		HandleImportBatchRequest(Request, OnComplete);
+	}
+	else if (Type == TEXT("import_batch_progress"))
+	{
+		HandleImportBatchProgressRequest(Request, OnComplete);
+	}
+	else if (Type == TEXT("spawn_actor"))
+	{
+		HandleSpawnActorRequest(Request, OnComplete);
+	}
+	else if (Type == TEXT("set_actor_transform"))
+	{
+		HandleActorTransformRequest(Request, OnComplete);
+	}
+	else if (Type == TEXT("set_material_parameter"))
+	{
+		HandleMaterialParameterRequest(Request, OnComplete);
+	}
+	else if (Type == TEXT("list_actors"))
+	{
+		HandleListActorsRequest(Request, OnComplete);
+	}
+	else if (Type == TEXT("scene_changes"))
+	{
+		HandleSceneChangesRequest(Request, OnComplete);
+	}
+	else if (Type == TEXT("create_session"))
+	{
+		HandleCreateSessionRequest(Request, OnComplete);
+	}
+	else if (Type == TEXT("list_sessions"))
+	{
+		HandleListSessionsRequest(Request, OnComplete);
+	}
+	else if (Type == TEXT("close_session"))
+	{
+		HandleCloseSessionRequest(Request, OnComplete);
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
+
+bool FUEPythonServerModule::Tick(float DeltaTime)
+{
+	Metrics->RecordFrame(DeltaTime);
+	
+	// Evict idle sessions every few seconds rather than taking the GIL every frame
+	const double Now = FPlatformTime::Seconds();
+	if (Now >= NextSessionEvictionTime)
+	{
+		NextSessionEvictionTime = Now + 10.0;
+		if (Sessions->GetNum() > 0 && FPythonScriptPlugin::Get()->IsPythonAvailable())
+		{
+			FPyScopedGIL GIL;
+			const int32 NumEvicted = Sessions->EvictIdle();
+			if (NumEvicted > 0)
+			{
+				UE_LOG(LogTemp, Log, TEXT("UEPythonServer evicted %d idle sessions"), NumEvicted);
+			}
+		}
+	}
+	
+	if (WebSocketServer.IsValid())
+	{
+		PYTHONSERVER_TRACE_SCOPE("PythonServer.WebSocket");
+		WebSocketServer->Tick();
+	}
+	
+	JobQueue->Tick(TickBudgetMs / 1000.0);
+	
+	if (CaptureReadback.IsValid())
+	{
+		PYTHONSERVER_TRACE_SCOPE("PythonServer.CaptureReadback");
+		CaptureReadback->Tick(Now);
+	}
+	
+	PublishStatusSnapshots(Now);
+	PublishInstanceBeacon(Now);
+	return true;
+}
+
+void FUEPythonServerModule::PublishInstanceBeacon(double Now)
+{
+	if (!Beacon.IsValid() || Now < NextBeaconTime)
+	{
+		return;
+	}
+	
+	PYTHONSERVER_TRACE_SCOPE("PythonServer.Beacon");
+	NextBeaconTime = Now + 1.0;
+	
+	const FPythonJobQueueStats QueueStats = JobQueue->GetStats();
+	const FDateTime UnixEpoch(1970, 1, 1);
+	TSharedPtr<FJsonObject> InstanceObj = MakeShared<FJsonObject>();
+	InstanceObj->SetStringField("instance_id", InstanceId.ToString(EGuidFormats::DigitsWithHyphensLower));
+	InstanceObj->SetNumberField("pid", FPlatformProcess::GetCurrentProcessId());
+	InstanceObj->SetStringField("host", FPlatformProcess::ComputerName());
+	InstanceObj->SetNumberField("port", ServerPort);
+	InstanceObj->SetNumberField("websocket_port", WebSocketServer.IsValid() ? GetWebSocketPort() : 0);
+	InstanceObj->SetNumberField("status_port", StatusListener.IsValid() ? GetStatusPort() : 0);
+	InstanceObj->SetStringField("project", FApp::GetProjectName());
+	InstanceObj->SetStringField("engine_version", FEngineVersion::Current().ToString());
+	InstanceObj->SetNumberField("started_at", (StartedAt - UnixEpoch).GetTotalSeconds());
+	InstanceObj->SetNumberField("updated_at", (FDateTime::UtcNow() - UnixEpoch).GetTotalSeconds());
+	InstanceObj->SetNumberField("pending_jobs", QueueStats.NumPending);
+	InstanceObj->SetNumberField("queue_lag_ms", QueueStats.OldestPendingSeconds * 1000.0);
+	InstanceObj->SetNumberField("sessions", Sessions->GetNum());
+	
+	FString Body;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Body);
+	FJsonSerializer::Serialize(InstanceObj.ToSharedRef(), Writer);
+	Beacon->Publish(Body);
+}
+
+void FUEPythonServerModule::PublishStatusSnapshots(double Now)
+{
+	if (!StatusListener.IsValid() || Now < NextStatusSnapshotTime)
+	{
+		return;
+	}
+	
+	PYTHONSERVER_TRACE_SCOPE("PythonServer.Snapshot");
+	NextStatusSnapshotTime = Now + 0.1;
+	StatusListener->SetSnapshot(TEXT("/status"), TEXT("application/json"), BuildStatusBody());
+	StatusListener->SetSnapshot(TEXT("/metrics"), TEXT("text/plain; version=0.0.4"), BuildMetricsBody());
+	
+	// Listing actors costs far more, so only do it while someone reads the list, once a second at
+	// most, and when the journal saw a change. Map loads do not go through the journal, hence the
+	// refresh every 10 seconds regardless
+	const bool bActorsRead = Now - StatusListener->GetLastRequestTime(TEXT("/actors")) < 30.0;
+	const uint64 Sequence = SceneJournal->GetSequence();
+	if (!bActorsRead || Now < NextActorsSnapshotTime || (Sequence == ActorsSnapshotSequence && Now < NextActorsSnapshotTime + 9.0))
+	{
+		return;
+	}
+	NextActorsSnapshotTime = Now + 1.0;
+	
+	TSharedRef<FJsonObject> ActorsObj = MakeShared<FJsonObject>();
+	ActorsObj->SetNumberField("sequence", Sequence);
+	FString Error;
+	if (SceneFastPath::ListActors(FString(), 10000, *ActorsObj, Error))
+	{
+		ActorsObj->SetStringField("status", "success");
+		ActorsSnapshotSequence = Sequence;
+	}
+	else
+	{
+		ActorsObj = MakeShared<FJsonObject>();
+		ActorsObj->SetStringField("status", "error");
+		ActorsObj->SetStringField("message", Error);
+	}
+	
+	FString ActorsBody;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ActorsBody);
+	FJsonSerializer::Serialize(ActorsObj, Writer);
+	StatusListener->SetSnapshot(TEXT("/actors"), TEXT("application/json"), ActorsBody);
+}
+
+void FUEPythonServerModule::HandleStatusRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+{
+	OnComplete(FHttpServerResponse::Create(BuildStatusBody(), TEXT("application/json")));
+}
+
+FString FUEPythonServerModule::BuildStatusBody() const
 {
 	// Create JSON response
 	TSharedPtr<FJsonObject> ResponseObj = MakeShared<FJsonObject>();
 	ResponseObj->SetStringField("status", "running");
 	ResponseObj->SetStringField("version", "0.1.0");
 	ResponseObj->SetNumberField("port", ServerPort);
+	ResponseObj->SetNumberField("websocket_port", WebSocketServer.IsValid() ? GetWebSocketPort() : 0);
+	ResponseObj->SetNumberField("websocket_connections", WebSocketServer.IsValid() ? WebSocketServer->GetNumConnections() : 0);
+	ResponseObj->SetNumberField("status_port", StatusListener.IsValid() ? GetStatusPort() : 0);
+	ResponseObj->SetNumberField("status_requests", StatusListener.IsValid() ? StatusListener->GetNumRequests() : 0);
+	ResponseObj->SetStringField("instance_id", InstanceId.ToString(EGuidFormats::DigitsWithHyphensLower));
+	ResponseObj->SetStringField("project", FApp::GetProjectName());
+	ResponseObj->SetStringField("discovery_file", Beacon.IsValid() ? Beacon->GetFilePath() : FString());
 	
 	// Add Python availability info
 	bool bIsPythonAvailable = FPythonScriptPlugin::Get()->IsPythonAvailable();
 	ResponseObj->SetBoolField("python_available", bIsPythonAvailable);
 	
+	// Add dispatcher info, so clients can see how far behind the queue is
+	const FPythonJobQueueStats QueueStats = JobQueue->GetStats();
+	ResponseObj->SetNumberField("pending_jobs", QueueStats.NumPending);
+	TSharedPtr<FJsonObject> PendingByPriorityObj = MakeShared<FJsonObject>();
+	for (int32 LaneIndex = 0; LaneIndex < static_cast<int32>(EPythonJobPriority::Count); ++LaneIndex)
+	{
+		PendingByPriorityObj->SetNumberField(LexToString(static_cast<EPythonJobPriority>(LaneIndex)), QueueStats.NumPendingByPriority[LaneIndex]);
+	}
+	ResponseObj->SetObjectField("pending_by_priority", PendingByPriorityObj);
+	ResponseObj->SetNumberField("cancelled_jobs", QueueStats.NumCancelled);
+	ResponseObj->SetNumberField("timed_out_jobs", QueueStats.NumTimedOut);
+	ResponseObj->SetNumberField("default_timeout_seconds", DefaultTimeoutSeconds);
+	ResponseObj->SetNumberField("queue_lag_ms", QueueStats.OldestPendingSeconds * 1000.0);
+	ResponseObj->SetNumberField("tick_budget_ms", TickBudgetMs);
+	ResponseObj->SetNumberField("max_output_chars", MaxOutputChars);
+	ResponseObj->SetNumberField("sessions", Sessions->GetNum());
+	ResponseObj->SetNumberField("streamed_meshes", MeshStreams->GetNum());
+	ResponseObj->SetBoolField("log_output", bLogOutput);
+	ResponseObj->SetNumberField("last_tick_ms", QueueStats.LastTickSeconds * 1000.0);
+	ResponseObj->SetNumberField("last_tick_jobs", QueueStats.LastTickJobs);
+	ResponseObj->SetNumberField("total_jobs_run", QueueStats.TotalJobsRun);
+	ResponseObj->SetNumberField("ticks_over_budget", QueueStats.NumTicksOverBudget);
+	
+	// Add the imports queued at server start, a cold instance is warm once its state is done
+	if (Preloader.IsValid())
+	{
+		ResponseObj->SetObjectField("preload", Preloader->ToJson());
+	}
+	
+	// Add scene capture info
+	if (CaptureReadback.IsValid())
+	{
+		const FSceneCaptureStats CaptureStats = CaptureReadback->GetStats();
+		TSharedPtr<FJsonObject> CaptureObj = MakeShared<FJsonObject>();
+		CaptureObj->SetNumberField("in_flight", CaptureStats.NumInFlight);
+		CaptureObj->SetNumberField("completed", CaptureStats.NumCompleted);
+		CaptureObj->SetNumberField("failed", CaptureStats.NumFailed);
+		ResponseObj->SetObjectField("captures", CaptureObj);
+	}
+	
+	// Add compiled-code cache info
+	const FPythonCodeCacheStats CacheStats = CodeCache->GetStats();
+	TSharedPtr<FJsonObject> CacheObj = MakeShared<FJsonObject>();
+	CacheObj->SetNumberField("entries", CacheStats.NumEntries);
+	CacheObj->SetNumberField("capacity", CacheStats.MaxEntries);
+	CacheObj->SetNumberField("hits", CacheStats.NumHits);
+	CacheObj->SetNumberField("misses", CacheStats.NumMisses);
+	CacheObj->SetNumberField("evictions", CacheStats.NumEvictions);
+	ResponseObj->SetObjectField("code_cache", CacheObj);
+	
+	// Add result cache info, to see how much work idempotent requests saved
+	const FPythonResultCacheStats ResultStats = ResultCache->GetStats();
+	TSharedPtr<FJsonObject> ResultObj = MakeShared<FJsonObject>();
+	ResultObj->SetNumberField("entries", ResultStats.NumEntries);
+	ResultObj->SetNumberField("capacity", ResultStats.MaxEntries);
+	ResultObj->SetNumberField("hits", ResultStats.NumHits);
+	ResultObj->SetNumberField("coalesced", ResultStats.NumCoalesced);
+	ResultObj->SetNumberField("misses", ResultStats.NumMisses);
+	ResponseObj->SetObjectField("result_cache", ResultObj);
+	
+	// Add upload staging info
+	const FAssetUploadStagingStats UploadStats = UploadStaging->GetStats();
+	TSharedPtr<FJsonObject> UploadObj = MakeShared<FJsonObject>();
+	UploadObj->SetNumberField("uploads", UploadStats.NumUploads);
+	UploadObj->SetNumberField("bytes", UploadStats.NumBytes);
+	UploadObj->SetNumberField("capacity_bytes", UploadStats.MaxBytes);
+	ResponseObj->SetObjectField("upload_staging", UploadObj);
+	
+	// Add request latency summary, the full histograms are at /metrics
+	TSharedPtr<FJsonObject> LatencyObj = MakeShared<FJsonObject>();
+	for (int32 StageIndex = 0; StageIndex < static_cast<int32>(EPythonServerStage::Count); ++StageIndex)
+	{
+		const FLatencyHistogram& Histogram = Metrics->GetStageHistogram(static_cast<EPythonServerStage>(StageIndex));
+		const uint64 NumSamples = Histogram.GetCount();
+		
+		TSharedPtr<FJsonObject> StageObj = MakeShared<FJsonObject>();
+		StageObj->SetNumberField("count", NumSamples);
+		StageObj->SetNumberField("mean", NumSamples > 0 ? Histogram.GetSumSeconds() * 1000.0 / NumSamples : 0.0);
+		StageObj->SetNumberField("p50", Histogram.GetQuantile(0.5) * 1000.0);
+		StageObj->SetNumberField("p99", Histogram.GetQuantile(0.99) * 1000.0);
+		LatencyObj->SetObjectField(LexToString(static_cast<EPythonServerStage>(StageIndex)), StageObj);
+	}
+	ResponseObj->SetObjectField("latency_ms", LatencyObj);
+	
+	// Add editor frame times, to see what the server's work costs the editor
+	const FLatencyHistogram& FrameHistogram = Metrics->GetFrameHistogram();
+	TSharedPtr<FJsonObject> FrameObj = MakeShared<FJsonObject>();
+	FrameObj->SetNumberField("count", FrameHistogram.GetCount());
+	FrameObj->SetNumberField("mean", FrameHistogram.GetCount() > 0 ? FrameHistogram.GetSumSeconds() * 1000.0 / FrameHistogram.GetCount() : 0.0);
+	FrameObj->SetNumberField("p50", FrameHistogram.GetQuantile(0.5) * 1000.0);
+	FrameObj->SetNumberField("p99", FrameHistogram.GetQuantile(0.99) * 1000.0);
+	ResponseObj->SetObjectField("frame_ms", FrameObj);
+	ResponseObj->SetNumberField("execute_requests", Metrics->GetNumExecuteRequests());
+	ResponseObj->SetNumberField("execute_errors", Metrics->GetNumExecuteErrors());
+	
+	// Add registered script names
+	TArray<TSharedPtr<FJsonValue>> ScriptNames;
+	for (const FString& ScriptName : ScriptRegistry->GetNames())
+	{
+		ScriptNames.Add(MakeShared<FJsonValueString>(ScriptName));
+	}
+	ResponseObj->SetArrayField("scripts", ScriptNames);
+	
 	// Convert JSON to string
 	FString ResponseBody;
 	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ResponseBody);
 	FJsonSerializer::Serialize(ResponseObj.ToSharedRef(), Writer);
+	return ResponseBody;
+}
+
+void FUEPythonServerModule::HandleMetricsRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+{
+	OnComplete(FHttpServerResponse::Create(BuildMetricsBody(), TEXT("text/plain; version=0.0.4")));
+}
+
+FString FUEPythonServerModule::BuildMetricsBody() const
+{
+	FString Body;
+	Body.Reserve(16 * 1024);
+	Metrics->WritePrometheusText(Body);
 	
-	// Send response
-	OnComplete(FHttpServerResponse::Create(ResponseBody, TEXT("application/json")));
+	// Gauges and counters owned by the other subsystems
+	const FPythonJobQueueStats QueueStats = JobQueue->GetStats();
+	const FPythonCodeCacheStats CacheStats = CodeCache->GetStats();
+	Body += TEXT("# TYPE uepython_pending_jobs gauge\n");
+	Body += FString::Printf(TEXT("uepython_pending_jobs %d\n"), QueueStats.NumPending);
+	Body += TEXT("# TYPE uepython_pending_jobs_by_priority gauge\n");
+	for (int32 LaneIndex = 0; LaneIndex < static_cast<int32>(EPythonJobPriority::Count); ++LaneIndex)
+	{
+		Body += FString::Printf(TEXT("uepython_pending_jobs_by_priority{priority=\"%s\"} %d\n"), LexToString(static_cast<EPythonJobPriority>(LaneIndex)), QueueStats.NumPendingByPriority[LaneIndex]);
+	}
+	Body += TEXT("# TYPE uepython_jobs_cancelled_total counter\n");
+	Body += FString::Printf(TEXT("uepython_jobs_cancelled_total %llu\n"), QueueStats.NumCancelled);
+	Body += TEXT("# TYPE uepython_jobs_timed_out_total counter\n");
+	Body += FString::Printf(TEXT("uepython_jobs_timed_out_total %llu\n"), QueueStats.NumTimedOut);
+	Body += TEXT("# TYPE uepython_queue_lag_seconds gauge\n");
+	Body += FString::Printf(TEXT("uepython_queue_lag_seconds %.6f\n"), QueueStats.OldestPendingSeconds);
+	Body += TEXT("# TYPE uepython_jobs_run_total counter\n");
+	Body += FString::Printf(TEXT("uepython_jobs_run_total %llu\n"), QueueStats.TotalJobsRun);
+	Body += TEXT("# TYPE uepython_ticks_over_budget_total counter\n");
+	Body += FString::Printf(TEXT("uepython_ticks_over_budget_total %llu\n"), QueueStats.NumTicksOverBudget);
+	Body += TEXT("# TYPE uepython_code_cache_hits_total counter\n");
+	Body += FString::Printf(TEXT("uepython_code_cache_hits_total %llu\n"), CacheStats.NumHits);
+	Body += TEXT("# TYPE uepython_code_cache_misses_total counter\n");
+	Body += FString::Printf(TEXT("uepython_code_cache_misses_total %llu\n"), CacheStats.NumMisses);
+	const FPythonResultCacheStats ResultStats = ResultCache->GetStats();
+	Body += TEXT("# TYPE uepython_result_cache_hits_total counter\n");
+	Body += FString::Printf(TEXT("uepython_result_cache_hits_total %llu\n"), ResultStats.NumHits);
+	Body += TEXT("# TYPE uepython_result_cache_coalesced_total counter\n");
+	Body += FString::Printf(TEXT("uepython_result_cache_coalesced_total %llu\n"), ResultStats.NumCoalesced);
+	Body += TEXT("# TYPE uepython_result_cache_misses_total counter\n");
+	Body += FString::Printf(TEXT("uepython_result_cache_misses_total %llu\n"), ResultStats.NumMisses);
+	Body += TEXT("# TYPE uepython_code_cache_entries gauge\n");
+	Body += FString::Printf(TEXT("uepython_code_cache_entries %d\n"), CacheStats.NumEntries);
+	Body += TEXT("# TYPE uepython_websocket_connections gauge\n");
+	Body += FString::Printf(TEXT("uepython_websocket_connections %d\n"), WebSocketServer.IsValid() ? WebSocketServer->GetNumConnections() : 0);
+	Body += TEXT("# TYPE uepython_status_listener_requests_total counter\n");
+	Body += FString::Printf(TEXT("uepython_status_listener_requests_total %llu\n"), StatusListener.IsValid() ? StatusListener->GetNumRequests() : 0);
+	return Body;
+}
+
+FString FUEPythonServerModule::ExecutePythonCode(const FString& Code, bool* bOutSuccess, bool bStreamOutput, int64* OutNumDropped, const FGuid& SessionId, FPythonResultValue* OutValue)
+{
+	return RunPython([this, &Code, &SessionId, OutValue]()
+	{
+		// Reuse the compiled code object when this exact script ran before
+		const double CompileStartTime = FPlatformTime::Seconds();
+		FPyObjectPtr CodeObject;
+		FPyObjectPtr ExpressionObject;
+		{
+			PYTHONSERVER_TRACE_SCOPE("PythonServer.Compile");
+			CodeObject = OutValue ? CodeCache->FindOrCompileEval(Code, ExpressionObject) : CodeCache->FindOrCompile(Code);
+		}
+		const double ExecuteStartTime = FPlatformTime::Seconds();
+		Metrics->RecordStage(EPythonServerStage::Compile, ExecuteStartTime - CompileStartTime);
+		if (!CodeObject)
+		{
+			return false;
+		}
+		
+		// Run in the session's globals, or in the __main__ module's scope as ExecPythonString does
+		PyObject* Globals = nullptr;
+		if (SessionId.IsValid())
+		{
+			Globals = Sessions->Use(SessionId);
+			if (Globals == nullptr)
+			{
+				PyErr_Format(PyExc_KeyError, "Unknown or expired session '%s'", TCHAR_TO_UTF8(*SessionId.ToString(EGuidFormats::DigitsWithHyphensLower)));
+				return false;
+			}
+		}
+		else
+		{
+			PyObject* MainModule = PyImport_AddModule("__main__");
+			Globals = PyModule_GetDict(MainModule);
+		}
+		
+		// A __result__ left in the globals by an earlier run is not this run's value
+		if (OutValue && PyDict_DelItemString(Globals, "__result__") != 0)
+		{
+			PyErr_Clear();
+		}
+		
+		FPyObjectPtr EvalResult;
+		{
+			PYTHONSERVER_TRACE_SCOPE("PythonServer.Exec");
+			EvalResult = FPyObjectPtr::StealReference(PyEval_EvalCode(CodeObject.Get(), Globals, Globals));
+			if (EvalResult && ExpressionObject)
+			{
+				EvalResult = FPyObjectPtr::StealReference(PyEval_EvalCode(ExpressionObject.Get(), Globals, Globals));
+			}
+		}
+		Metrics->RecordStage(EPythonServerStage::Execute, FPlatformTime::Seconds() - ExecuteStartTime);
+		if (!EvalResult || !OutValue)
+		{
+			return EvalResult.IsValid();
+		}
+		
+		// __result__ set by the script takes precedence over its final expression
+		FPyObjectPtr Value = FPyObjectPtr::NewReference(PyDict_GetItemString(Globals, "__result__"));
+		if (Value)
+		{
+			PyDict_DelItemString(Globals, "__result__");
+		}
+		else
+		{
+			Value = EvalResult;
+		}
+		
+		PYTHONSERVER_TRACE_SCOPE("PythonServer.ConvertValue");
+		return PythonValueConverter::Convert(Value.Get(), *OutValue);
+	}, bOutSuccess, bStreamOutput, OutNumDropped);
+}
+
+FString FUEPythonServerModule::InvokeRegisteredScript(const FString& Name, const FString& ArgsJson, bool* bOutSuccess)
+{
+	return RunPython([this, &Name, &ArgsJson]()
+	{
+		PYTHONSERVER_TRACE_SCOPE_TEXT(TEXT("PythonServer.Invoke %s"), *Name);
+		
+		FPyObjectPtr CodeObject = ScriptRegistry->Find(Name);
+		if (!CodeObject)
+		{
+			PyErr_Format(PyExc_KeyError, "No script registered as '%s'", TCHAR_TO_UTF8(*Name));
+			return false;
+		}
+		
+		// Decode the arguments into a dict with Python's own json module
+		FPyObjectPtr JsonModule = FPyObjectPtr::StealReference(PyImport_ImportModule("json"));
+		if (!JsonModule)
+		{
+			return false;
+		}
+		
+		FPyObjectPtr Args = FPyObjectPtr::StealReference(PyObject_CallMethod(JsonModule.Get(), "loads", "s", TCHAR_TO_UTF8(*ArgsJson)));
+		if (!Args)
+		{
+			return false;
+		}
+		
+		// Each invocation gets fresh globals so calls never see each other's state
+		FPyObjectPtr Globals = FPyObjectPtr::StealReference(PyDict_New());
+		PyDict_SetItemString(Globals.Get(), "__builtins__", PyEval_GetBuiltins());
+		PyDict_SetItemString(Globals.Get(), "__name__", FPyObjectPtr::StealReference(PyUnicode_FromString("__main__")).Get());
+		PyDict_SetItemString(Globals.Get(), "args", Args.Get());
+		
+		FPyObjectPtr EvalResult = FPyObjectPtr::StealReference(PyEval_EvalCode(CodeObject.Get(), Globals.Get(), Globals.Get()));
+		return EvalResult.IsValid();
+	}, bOutSuccess);
 }
 
-FString FUEPythonServerModule::ExecutePythonCode(const FString& Code)
+FString FUEPythonServerModule::RunPython(TFunctionRef<bool()> Body, bool* bOutSuccess, bool bStreamOutput, int64* OutNumDropped)
 {
+	if (bOutSuccess)
+	{
+		*bOutSuccess = false;
+	}
+	
 	// Check if Python is available
 	if (!FPythonScriptPlugin::Get()->IsPythonAvailable())
 	{
@@ -212,43 +2487,99 @@ FString FUEPythonServerModule::ExecutePythonCode(const FString& Code)
 		return TEXT("Error: Python is not available in this Unreal Engine instance");
 	}
 	
-	// Create a string to capture output
-	FString OutputString;
+	// Capture output up to the cap, keeping its head and tail
+	FPythonOutputCapture Capture(MaxOutputChars);
 	
-	// Redirect stdout to capture output
-	FPyObjectPtr StdoutRedirect = FPythonScriptPlugin::Get()->RedirectPythonOutput([&OutputString](const FString& InString) {
-		OutputString += InString;
-		UE_LOG(LogTemp, Log, TEXT("Python output: %s"), *InString);
+	// Only the start of a run's output is logged, so a print loop cannot flood the log
+	int32 NumLoggedChars = 0;
+	
+	// Redirect stdout to capture output. Streamed output goes to the running job's bounded buffer instead
+	double CaptureSeconds = 0.0;
+	FPyObjectPtr StdoutRedirect = FPythonScriptPlugin::Get()->RedirectPythonOutput([this, &Capture, &NumLoggedChars, &CaptureSeconds, bStreamOutput](const FString& InString) {
+		const double CaptureStartTime = FPlatformTime::Seconds();
+		if (bStreamOutput)
+		{
+			JobQueue->AppendRunningOutput(InString);
+		}
+		else
+		{
+			Capture.Append(InString);
+		}
+		
+		if (bLogOutput && NumLoggedChars < MaxLoggedCharsPerRun)
+		{
+			NumLoggedChars += InString.Len();
+			UE_LOG(LogTemp, Log, TEXT("Python output: %s"), *InString);
+			if (NumLoggedChars >= MaxLoggedCharsPerRun)
+			{
+				UE_LOG(LogTemp, Log, TEXT("Python output: further output of this run is not logged"));
+			}
+		}
+		CaptureSeconds += FPlatformTime::Seconds() - CaptureStartTime;
 	});
 	
 	// Execute the Python code
 	bool bSuccess = false;
+	bool bTimedOut = false;
+	FString ErrorString;
 	{
-		// Use a Python script module's scope to execute the code
-		FPythonScriptPlugin::Get()->ExecPythonString(
-			Code, 
-			/* OutResult */ nullptr, 
-			/* OutError */ nullptr, 
-			/* InPythonModule */ FString("__main__"),
-			/* InLocalContext */ nullptr,
-			/* bStopOnError */ true,
-			/* bSilent */ false,
-			/* OutSuccess */ &bSuccess
-		);
+		PYTHONSERVER_TRACE_SCOPE("PythonServer.RunPython");
+		FPyScopedGIL GIL;
+		
+		// Lets /jobs/{id}/cancel and the watchdog interrupt the script from another thread
+		const uint64 Serial = JobQueue->GetRunningJobSerial();
+		const double Deadline = JobQueue->GetRunningJobDeadline();
+		PythonInterrupt::FScopedRun InterruptibleRun(Serial);
+		if (Deadline > 0.0 && Watchdog.IsValid())
+		{
+			Watchdog->Arm(Serial, Deadline);
+		}
+		
+		bSuccess = Body();
+		
+		// A script that finished as the deadline passed keeps its result
+		bTimedOut = Deadline > 0.0 && Watchdog.IsValid() && Watchdog->Disarm() && !bSuccess;
+		if (!bSuccess)
+		{
+			PyUtil::LogPythonError(&ErrorString);
+		}
 	}
 	
 	// Reset stdout redirection
 	StdoutRedirect.Reset();
+	Metrics->RecordStage(EPythonServerStage::OutputCapture, CaptureSeconds);
+	
+	if (bOutSuccess)
+	{
+		*bOutSuccess = bSuccess;
+	}
+	
+	const int64 NumDropped = Capture.GetNumDropped();
+	if (OutNumDropped)
+	{
+		*OutNumDropped = NumDropped;
+	}
+	if (NumDropped > 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Python output was over the %d character cap, %lld characters were dropped"), MaxOutputChars, NumDropped);
+	}
 	
+	FString OutputString = Capture.Finish();
+	if (bTimedOut)
+	{
+		JobQueue->MarkRunningJobTimedOut();
+		UE_LOG(LogTemp, Error, TEXT("Python code ran past its timeout and was interrupted"));
+		return FString::Printf(TEXT("Error: Execution timed out and was interrupted: %s\nOutput: %s"), *ErrorString, *OutputString);
+	}
 	if (!bSuccess)
 	{
 		UE_LOG(LogTemp, Error, TEXT("Failed to execute Python code"));
-		return FString::Printf(TEXT("Error executing Python code. Output: %s"), *OutputString);
+		return FString::Printf(TEXT("Error executing Python code: %s\nOutput: %s"), *ErrorString, *OutputString);
 	}
 	
 	return OutputString;
 }
 
 #undef LOCTEXT_NAMESPACE
-	
+
 IMPLEMENT_MODULE(FUEPythonServerModule, UEPythonServer) 
\ No newline at end of file
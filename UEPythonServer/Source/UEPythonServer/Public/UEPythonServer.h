@@ -6,6 +6,26 @@
 #include "Modules/ModuleManager.h"
 #include "HttpServerModule.h"
 #include "IHttpRouter.h"
+#include "Containers/Ticker.h"
+#include "Dom/JsonObject.h"
+
+class FPythonJobQueue;
+class FPythonCodeCache;
+class FPythonResultCache;
+class FPythonScriptRegistry;
+class FPythonWebSocketServer;
+class FAssetUploadStaging;
+class FAssetImportBatch;
+class FSceneChangeJournal;
+class FPythonServerMetrics;
+class FPythonSessionManager;
+class FPythonStatusListener;
+class FPythonWatchdog;
+class FPythonInstanceBeacon;
+class FPythonModulePreloader;
+class FSceneCaptureReadback;
+class FMeshStreamRegistry;
+struct FPythonResultValue;
 
 class UEPYTHONSERVER_API FUEPythonServerModule : public IModuleInterface
 {
@@ -13,19 +33,19 @@ public:
 	/** IModuleInterface implementation */
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
-
+	
 	/**
 	 * Starts the HTTP server on the specified port
 	 * @param Port The port to run the server on
 	 * @return True if the server started successfully
 	 */
 	bool StartServer(uint32 Port = 8500);
-
+	
 	/**
 	 * Stops the HTTP server
 	 */
 	void StopServer();
-
+	
 	/**
 	 * Checks if the server is currently running
 	 * @return True if the server is running
@@ -38,6 +58,89 @@ public:
 	 */
 	uint32 GetServerPort() const { return ServerPort; }
 	
+	/**
+	 * Gets the port of the WebSocket transport, always the port after the HTTP port
+	 * @return The port number
+	 */
+	uint32 GetWebSocketPort() const { return ServerPort + 1; }
+	
+	/**
+	 * Gets the port of the read-only status listener, always two ports after the HTTP port
+	 * @return The port number
+	 */
+	uint32 GetStatusPort() const { return ServerPort + 2; }
+	
+	/**
+	 * Gets the time the game-thread dispatcher may spend running Python work per tick
+	 * @return The budget in milliseconds
+	 */
+	float GetTickBudgetMs() const { return TickBudgetMs; }
+	
+	/**
+	 * Sets the time the game-thread dispatcher may spend running Python work per tick.
+	 * A job that has started always runs to completion, the budget only stops new jobs from starting.
+	 * @param InTickBudgetMs The budget in milliseconds
+	 */
+	void SetTickBudgetMs(float InTickBudgetMs);
+	
+	/**
+	 * Gets the number of characters of output kept per run
+	 * @return The cap in characters
+	 */
+	int32 GetMaxOutputChars() const { return MaxOutputChars; }
+	
+	/**
+	 * Sets the number of characters of output kept per run. Past the cap, the head and the tail of
+	 * the output are kept and the characters in between are dropped.
+	 * @param InMaxOutputChars The cap in characters
+	 */
+	void SetMaxOutputChars(int32 InMaxOutputChars);
+	
+	/**
+	 * Gets whether Python output is written to the log
+	 * @return True if output is logged
+	 */
+	bool IsOutputLogged() const { return bLogOutput; }
+	
+	/**
+	 * Sets whether Python output is written to the log. Only the first MaxLoggedCharsPerRun characters of a run are logged.
+	 * @param bInLogOutput Whether to log output
+	 */
+	void SetLogOutput(bool bInLogOutput);
+	
+	/**
+	 * Gets the time a job may run for when its request does not set a timeout
+	 * @return The timeout in seconds, 0 for no limit
+	 */
+	float GetDefaultTimeoutSeconds() const { return DefaultTimeoutSeconds; }
+	
+	/**
+	 * Sets the time a job may run for when its request does not set a timeout. Past it, the
+	 * watchdog interrupts the job's Python and the request fails with the output so far.
+	 * @param InDefaultTimeoutSeconds The timeout in seconds, 0 for no limit
+	 */
+	void SetDefaultTimeoutSeconds(float InDefaultTimeoutSeconds);
+	
+	/**
+	 * Gets the modules imported when the server starts
+	 * @return The module names, in import order
+	 */
+	const TArray<FString>& GetPreloadModules() const { return PreloadModules; }
+	
+	/**
+	 * Sets the modules imported when the server starts, so the first requests do not pay for the
+	 * imports. Read from PreloadModules in the [UEPythonServer] section of the engine config, or
+	 * from -PythonServerPreload=; takes effect the next time the server starts.
+	 * @param InPreloadModules The module names, a dotted name may also be an attribute such as unreal.EditorAssetLibrary
+	 */
+	void SetPreloadModules(const TArray<FString>& InPreloadModules);
+	
+	/** Longest timeout a request may ask for, in seconds */
+	static constexpr double MaxTimeoutSeconds = 24.0 * 60.0 * 60.0;
+	
+	/** Characters of output logged per run at most */
+	static constexpr int32 MaxLoggedCharsPerRun = 16 * 1024;
+	
 private:
 	/** The HTTP server instance */
 	TSharedPtr<IHttpRouter> HttpRouter;
@@ -54,25 +157,372 @@ private:
 	/** Handle for the status endpoint */
 	FHttpRequestHandler StatusEndpointHandle;
 	
+	/** Handle for the batched Python code execution endpoint */
+	FHttpRequestHandler ExecuteBatchEndpointHandle;
+	
+	/** Handle for the job polling endpoint */
+	FHttpRequestHandler JobEndpointHandle;
+	
+	/** Handle for the streamed job output endpoint */
+	FHttpRequestHandler JobOutputEndpointHandle;
+	
+	/** Handle for the job cancellation endpoint */
+	FHttpRequestHandler CancelJobEndpointHandle;
+	
+	/** Dispatcher queue for all Python work, drained on the game thread */
+	TSharedPtr<FPythonJobQueue> JobQueue;
+	
+	/** Compiled code objects of recently executed scripts */
+	TSharedPtr<FPythonCodeCache> CodeCache;
+	
+	/** Results of cache-keyed /execute requests, and the runs identical requests wait on */
+	TSharedPtr<FPythonResultCache> ResultCache;
+	
+	/** Scripts registered by name through /scripts/register */
+	TSharedPtr<FPythonScriptRegistry> ScriptRegistry;
+	
+	/** Handle for the named script registration endpoint */
+	FHttpRequestHandler RegisterScriptEndpointHandle;
+	
+	/** Handle for the named script invocation endpoint */
+	FHttpRequestHandler InvokeScriptEndpointHandle;
+	
+	/** Handle for the asset upload endpoint */
+	FHttpRequestHandler UploadEndpointHandle;
+	
+	/** Uploaded asset files waiting to be imported */
+	TSharedPtr<FAssetUploadStaging> UploadStaging;
+	
+	/** Handle for the batched asset import endpoint */
+	FHttpRequestHandler ImportBatchEndpointHandle;
+	
+	/** Handle for the batched asset import progress endpoint */
+	FHttpRequestHandler ImportBatchProgressEndpointHandle;
+	
+	/** Import batches by id, kept after they finish so their progress can still be read */
+	TMap<FGuid, TSharedPtr<FAssetImportBatch>> ImportBatches;
+	
+	/** Import batch ids, oldest first */
+	TArray<FGuid> ImportBatchIds;
+	
+	/** Handles for the native scene operation endpoints */
+	FHttpRequestHandler SpawnActorEndpointHandle;
+	FHttpRequestHandler ActorTransformEndpointHandle;
+	FHttpRequestHandler MaterialParameterEndpointHandle;
+	FHttpRequestHandler ListActorsEndpointHandle;
+	
+	/** Handle for the scene change feed endpoint */
+	FHttpRequestHandler SceneChangesEndpointHandle;
+	
+	/** Handle for the scene capture endpoint */
+	FHttpRequestHandler CaptureEndpointHandle;
+	
+	/** Renders and reads back /capture images, alive while the server runs */
+	TSharedPtr<FSceneCaptureReadback> CaptureReadback;
+	
+	/** Handles for the mesh streaming endpoints */
+	FHttpRequestHandler StreamMeshEndpointHandle;
+	FHttpRequestHandler RemoveMeshEndpointHandle;
+	
+	/** Meshes streamed by clients, kept across server restarts as their actors stay in the level */
+	TSharedPtr<FMeshStreamRegistry> MeshStreams;
+	
+	/** Actor changes of the editor world, recorded while the server runs */
+	TSharedPtr<FSceneChangeJournal> SceneJournal;
+	
+	/** Handle for the Prometheus metrics endpoint */
+	FHttpRequestHandler MetricsEndpointHandle;
+	
+	/** Request counters and per-stage latency histograms */
+	TSharedPtr<FPythonServerMetrics> Metrics;
+	
+	/** Handles for the session endpoints */
+	FHttpRequestHandler CreateSessionEndpointHandle;
+	FHttpRequestHandler ListSessionsEndpointHandle;
+	FHttpRequestHandler CloseSessionEndpointHandle;
+	
+	/** Persistent execution contexts of the clients */
+	TSharedPtr<FPythonSessionManager> Sessions;
+	
+	/** Time of the next check for idle sessions, in FPlatformTime::Seconds() */
+	double NextSessionEvictionTime = 0.0;
+	
+	/** WebSocket transport serving the same requests over long-lived connections */
+	TSharedPtr<FPythonWebSocketServer> WebSocketServer;
+	
+	/** Listener answering read-only requests from snapshots, off the game thread */
+	TSharedPtr<FPythonStatusListener> StatusListener;
+	
+	/** Interrupts Python that runs past its job's timeout, alive while the server runs */
+	TSharedPtr<FPythonWatchdog> Watchdog;
+	
+	/** Advertises the server in the discovery directory for fleet routing, alive while the server runs */
+	TSharedPtr<FPythonInstanceBeacon> Beacon;
+	
+	/** Identifies this run of the server in the discovery file and /status */
+	FGuid InstanceId;
+	
+	/** Time the server started, reported in the discovery file */
+	FDateTime StartedAt;
+	
+	/** Imports of the preload list queued when the server started */
+	TSharedPtr<FPythonModulePreloader> Preloader;
+	
+	/** Time of the next discovery file update, in FPlatformTime::Seconds() */
+	double NextBeaconTime = 0.0;
+	
+	/** Time of the next status and metrics snapshot, in FPlatformTime::Seconds() */
+	double NextStatusSnapshotTime = 0.0;
+	
+	/** Time of the next actor list snapshot, in FPlatformTime::Seconds() */
+	double NextActorsSnapshotTime = 0.0;
+	
+	/** Scene journal position of the last actor list snapshot */
+	uint64 ActorsSnapshotSequence = MAX_uint64;
+	
+	/** Handle for the game-thread tick that drains the job queue */
+	FTSTicker::FDelegateHandle TickerHandle;
+	
+	/** Handle for starting the server once the engine is up, when -PythonServerPort= is given */
+	FDelegateHandle PostEngineInitHandle;
+	
+	/** Time in milliseconds the job queue may use per tick */
+	float TickBudgetMs = 5.0f;
+	
+	/** Characters of output kept per run */
+	int32 MaxOutputChars = 4 * 1024 * 1024;
+	
+	/** Whether Python output is written to the log */
+	bool bLogOutput = true;
+	
+	/** Time in seconds a job may run for when its request does not set a timeout, 0 for no limit */
+	float DefaultTimeoutSeconds = 0.0f;
+	
+	/** Modules imported when the server starts */
+	TArray<FString> PreloadModules;
+	
+	/**
+	 * Starts the server on the port given with -PythonServerPort=, once the engine and Python are initialized
+	 */
+	void StartServerFromCommandLine(uint32 Port);
+	
 	/**
 	 * Registers the HTTP endpoints
 	 */
 	void RegisterEndpoints();
 	
+	/**
+	 * Queues the imports of the preload list in the batch lane, so requests arriving meanwhile go first
+	 */
+	void EnqueuePreloadModules();
+	
 	/**
 	 * Handles the execute endpoint request
 	 */
 	void HandleExecuteRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete);
 	
+	/**
+	 * Handles the execute_batch endpoint request
+	 * Runs every script of the batch back-to-back in a single dispatcher job
+	 */
+	void HandleExecuteBatchRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete);
+	
+	/**
+	 * Handles the job polling endpoint request
+	 */
+	void HandleJobRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete);
+	
+	/**
+	 * Handles the job cancellation endpoint request
+	 */
+	void HandleCancelJobRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete);
+	
+	/**
+	 * Cancels a pending job or interrupts a running one, from any thread. The status listener
+	 * calls it from its workers, so a script blocking the game thread can still be stopped.
+	 * @return The response object, an error if the job is unknown or has finished
+	 */
+	TSharedPtr<FJsonObject> CancelJob(const FString& JobIdString);
+	
+	/**
+	 * Handles the streamed job output endpoint request
+	 */
+	void HandleJobOutputRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete);
+	
+	/**
+	 * Reads a streamed job's output from an offset, from any thread. The status listener calls it
+	 * from its workers, so the output can be followed while the script holds the game thread.
+	 * @return The response object, an error if the job is unknown or does not stream its output
+	 */
+	TSharedPtr<FJsonObject> ReadJobOutput(const FString& JobIdString, int64 Offset);
+	
+	/**
+	 * Handles the named script registration endpoint request
+	 */
+	void HandleRegisterScriptRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete);
+	
+	/**
+	 * Handles the named script invocation endpoint request
+	 */
+	void HandleInvokeScriptRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete);
+	
+	/**
+	 * Handles the asset upload endpoint request
+	 * Stages the uploaded bytes in memory and imports them on the game thread
+	 */
+	void HandleUploadRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete);
+	
+	/**
+	 * Handles the batched asset import endpoint request
+	 * Imports the manifest a slice per dispatcher job and saves the packages once at the end
+	 */
+	void HandleImportBatchRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete);
+	
+	/**
+	 * Handles the batched asset import progress endpoint request
+	 */
+	void HandleImportBatchProgressRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete);
+	
+	/**
+	 * Queues the next slice of an import batch, each slice queues the one after it when done
+	 */
+	void EnqueueImportSlice(const TSharedRef<FAssetImportBatch>& Batch);
+	
+	/**
+	 * Handles the native actor spawn endpoint request
+	 */
+	void HandleSpawnActorRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete);
+	
+	/**
+	 * Handles the native actor transform endpoint request
+	 */
+	void HandleActorTransformRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete);
+	
+	/**
+	 * Handles the native material parameter endpoint request
+	 */
+	void HandleMaterialParameterRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete);
+	
+	/**
+	 * Handles the native actor list endpoint request
+	 */
+	void HandleListActorsRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete);
+	
+	/**
+	 * Handles the scene change feed endpoint request
+	 */
+	void HandleSceneChangesRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete);
+	
+	/**
+	 * Handles the scene capture endpoint request, the image is sent once its readback finishes
+	 */
+	void HandleCaptureRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete);
+	
+	/**
+	 * Handles the mesh streaming endpoint request, creating or updating a section from binary buffers
+	 */
+	void HandleStreamMeshRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete);
+	
+	/**
+	 * Handles the streamed mesh removal endpoint request
+	 */
+	void HandleRemoveMeshRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete);
+	
+	/**
+	 * Handles the session creation endpoint request
+	 */
+	void HandleCreateSessionRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete);
+	
+	/**
+	 * Handles the session listing endpoint request
+	 */
+	void HandleListSessionsRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete);
+	
+	/**
+	 * Handles the session close endpoint request
+	 */
+	void HandleCloseSessionRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete);
+	
+	/**
+	 * Runs a native operation on the game thread, in order with queued Python work, and sends its response
+	 * @param Name Name of the operation in traces
+	 * @param Request The request, names the operation's trace spans and may set its ?priority=
+	 * @param Operation Fills in the response fields, returning false with the error set on failure
+	 */
+	void EnqueueNativeOperation(const TCHAR* Name, const FHttpServerRequest& Request, TFunction<bool(FJsonObject& /*OutResponse*/, FString& /*OutError*/)> Operation, const FHttpResultCallback& OnComplete);
+	
+	/**
+	 * Routes a WebSocket message to the HTTP handler for its type
+	 * @return False if the type is unknown
+	 */
+	bool DispatchWebSocketRequest(const FString& Type, const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete);
+	
+	/**
+	 * Drains queued jobs on the game thread
+	 * @return True to keep ticking
+	 */
+	bool Tick(float DeltaTime);
+	
 	/**
 	 * Handles the status endpoint request
 	 */
 	void HandleStatusRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete);
 	
+	/**
+	 * Handles the Prometheus metrics endpoint request
+	 */
+	void HandleMetricsRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete);
+	
+	/**
+	 * Builds the body of a /status response
+	 */
+	FString BuildStatusBody() const;
+	
+	/**
+	 * Builds the body of a /metrics response
+	 */
+	FString BuildMetricsBody() const;
+	
+	/**
+	 * Refreshes the snapshots served by the status listener, on the game thread
+	 * The actor list is only rebuilt while clients read it, and when the level changed
+	 */
+	void PublishStatusSnapshots(double Now);
+	
+	/**
+	 * Rewrites the discovery file with the current load, about once a second, on the game thread
+	 */
+	void PublishInstanceBeacon(double Now);
+	
 	/**
 	 * Executes Python code in the Unreal Engine
 	 * @param Code The Python code to execute
+	 * @param bOutSuccess Optional, set to whether the code ran without error
+	 * @param bStreamOutput Whether output goes to the running job's stream buffer instead of the result
+	 * @param OutNumDropped Optional, set to the number of characters of output dropped by the cap
+	 * @param SessionId Session whose globals the code runs in, invalid to run in __main__
+	 * @param OutValue Optional, runs the code in evaluation mode and sets the value of its
+	 *        __result__ global, or else of its final expression
+	 * @return Result of the execution
+	 */
+	FString ExecutePythonCode(const FString& Code, bool* bOutSuccess = nullptr, bool bStreamOutput = false, int64* OutNumDropped = nullptr, const FGuid& SessionId = FGuid(), FPythonResultValue* OutValue = nullptr);
+	
+	/**
+	 * Runs a registered script with the given arguments, exposed to the script as the 'args' dict
+	 * @param Name The registered script name
+	 * @param ArgsJson The arguments as a JSON object
+	 * @param bOutSuccess Optional, set to whether the script ran without error
 	 * @return Result of the execution
 	 */
-	FString ExecutePythonCode(const FString& Code);
+	FString InvokeRegisteredScript(const FString& Name, const FString& ArgsJson, bool* bOutSuccess = nullptr);
+	
+	/**
+	 * Runs Python work with the GIL held and its output captured
+	 * @param Body Performs the work, returning false with the Python error set on failure
+	 * @param bOutSuccess Optional, set to whether the work succeeded
+	 * @param bStreamOutput Whether output goes to the running job's stream buffer instead of the result
+	 * @param OutNumDropped Optional, set to the number of characters of output dropped by the cap
+	 * @return The captured output, or an error message including the output on failure
+	 */
+	FString RunPython(TFunctionRef<bool()> Body, bool* bOutSuccess = nullptr, bool bStreamOutput = false, int64* OutNumDropped = nullptr);
 }; 
\ No newline at end of file
@@ -30,7 +30,9 @@ public class UEPythonServer : ModuleRules
 				"HTTP",
 				"Json",
 				"JsonUtilities",
+				"Cbor",
 				"PythonScriptPlugin",
+				"WebSocketNetworking",
 				// ... add other public dependencies that you statically link with here ...
 			}
 			);
@@ -40,10 +42,32 @@ public class UEPythonServer : ModuleRules
 			{
 				"Slate",
 				"SlateCore",
+				"Sockets",
+				"Networking",
+				"RenderCore",
+				"RHI",
+				"ImageWrapper",
+				"ProceduralMeshComponent",
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
 		
+		// Gzip request bodies are inflated in chunks with zlib's streaming API
+		AddEngineThirdPartyPrivateStaticDependencies(Target, "zlib");
+		
+		// Asset import through /upload needs the editor's factories and AssetTools
+		if (Target.bBuildEditor)
+		{
+			PrivateDependencyModuleNames.AddRange(
+				new string[]
+				{
+					"UnrealEd",
+					"AssetTools",
+					"AssetRegistry",
+				}
+				);
+		}
+		
 		DynamicallyLoadedModuleNames.AddRange(
 			new string[]
 			{
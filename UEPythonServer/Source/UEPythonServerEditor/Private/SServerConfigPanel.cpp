@@ -5,6 +5,8 @@
 #include "Widgets/Text/STextBlock.h"
 #include "Widgets/Input/SButton.h"
 #include "Widgets/Input/SNumericEntryBox.h"
+#include "Widgets/Input/SCheckBox.h"
+#include "Widgets/Input/SEditableTextBox.h"
 #include "Widgets/Layout/SBox.h"
 #include "EditorStyleSet.h"
 #include "Modules/ModuleManager.h"
@@ -63,6 +65,145 @@ void SServerConfigPanel::Construct(const FArguments& InArgs)
 			]
 		]
 		
+		// Dispatcher budget
+		+SVerticalBox::Slot()
+		.AutoHeight()
+		.Padding(5.0f)
+		[
+			SNew(SHorizontalBox)
+			
+			+SHorizontalBox::Slot()
+			.AutoWidth()
+			.VAlign(VAlign_Center)
+			.Padding(0.0f, 0.0f, 5.0f, 0.0f)
+			[
+				SNew(STextBlock)
+				.Text(FText::FromString(TEXT("Tick Budget (ms):")))
+				.ToolTipText(FText::FromString(TEXT("Time the server may spend running queued Python work per editor frame")))
+			]
+			
+			+SHorizontalBox::Slot()
+			.AutoWidth()
+			.VAlign(VAlign_Center)
+			[
+				SNew(SNumericEntryBox<float>)
+				.Value(this, &SServerConfigPanel::GetTickBudgetMs)
+				.OnValueCommitted(this, &SServerConfigPanel::OnTickBudgetCommitted)
+				.AllowSpin(true)
+				.MinValue(0.5f)
+				.MaxValue(1000.0f)
+				.MinSliderValue(0.5f)
+				.MaxSliderValue(50.0f)
+			]
+		]
+		
+		// Script timeout
+		+SVerticalBox::Slot()
+		.AutoHeight()
+		.Padding(5.0f)
+		[
+			SNew(SHorizontalBox)
+			
+			+SHorizontalBox::Slot()
+			.AutoWidth()
+			.VAlign(VAlign_Center)
+			.Padding(0.0f, 0.0f, 5.0f, 0.0f)
+			[
+				SNew(STextBlock)
+				.Text(FText::FromString(TEXT("Script Timeout (s):")))
+				.ToolTipText(FText::FromString(TEXT("Time a script may run before it is interrupted, 0 for no limit. Requests can set their own timeout")))
+			]
+			
+			+SHorizontalBox::Slot()
+			.AutoWidth()
+			.VAlign(VAlign_Center)
+			[
+				SNew(SNumericEntryBox<float>)
+				.Value(this, &SServerConfigPanel::GetDefaultTimeoutSeconds)
+				.OnValueCommitted(this, &SServerConfigPanel::OnDefaultTimeoutCommitted)
+				.AllowSpin(true)
+				.MinValue(0.0f)
+				.MaxValue(86400.0f)
+				.MinSliderValue(0.0f)
+				.MaxSliderValue(600.0f)
+			]
+		]
+		
+		// Output capture
+		+SVerticalBox::Slot()
+		.AutoHeight()
+		.Padding(5.0f)
+		[
+			SNew(SHorizontalBox)
+			
+			+SHorizontalBox::Slot()
+			.AutoWidth()
+			.VAlign(VAlign_Center)
+			.Padding(0.0f, 0.0f, 5.0f, 0.0f)
+			[
+				SNew(STextBlock)
+				.Text(FText::FromString(TEXT("Max Output (KB):")))
+				.ToolTipText(FText::FromString(TEXT("Output kept per script run, past this the start and end of the output are kept")))
+			]
+			
+			+SHorizontalBox::Slot()
+			.AutoWidth()
+			.VAlign(VAlign_Center)
+			[
+				SNew(SNumericEntryBox<int32>)
+				.Value(this, &SServerConfigPanel::GetMaxOutputKB)
+				.OnValueCommitted(this, &SServerConfigPanel::OnMaxOutputCommitted)
+				.AllowSpin(true)
+				.MinValue(4)
+				.MaxValue(256 * 1024)
+				.MinSliderValue(4)
+				.MaxSliderValue(64 * 1024)
+			]
+			
+			+SHorizontalBox::Slot()
+			.AutoWidth()
+			.VAlign(VAlign_Center)
+			.Padding(10.0f, 0.0f, 0.0f, 0.0f)
+			[
+				SNew(SCheckBox)
+				.IsChecked(this, &SServerConfigPanel::GetLogOutputState)
+				.OnCheckStateChanged(this, &SServerConfigPanel::OnLogOutputChanged)
+				.ToolTipText(FText::FromString(TEXT("Write the start of each run's output to the log")))
+				[
+					SNew(STextBlock)
+					.Text(FText::FromString(TEXT("Log Output")))
+				]
+			]
+		]
+		
+		// Module preloading
+		+SVerticalBox::Slot()
+		.AutoHeight()
+		.Padding(5.0f)
+		[
+			SNew(SHorizontalBox)
+			
+			+SHorizontalBox::Slot()
+			.AutoWidth()
+			.VAlign(VAlign_Center)
+			.Padding(0.0f, 0.0f, 5.0f, 0.0f)
+			[
+				SNew(STextBlock)
+				.Text(FText::FromString(TEXT("Preload Modules:")))
+				.ToolTipText(FText::FromString(TEXT("Comma separated modules imported when the server starts, so the first requests do not wait on them")))
+			]
+			
+			+SHorizontalBox::Slot()
+			.FillWidth(1.0f)
+			.VAlign(VAlign_Center)
+			[
+				SNew(SEditableTextBox)
+				.Text(this, &SServerConfigPanel::GetPreloadModulesText)
+				.OnTextCommitted(this, &SServerConfigPanel::OnPreloadModulesCommitted)
+				.HintText(FText::FromString(TEXT("unreal, unreal.EditorAssetLibrary, my_helpers")))
+			]
+		]
+		
 		// Status and Controls
 		+SVerticalBox::Slot()
 		.AutoHeight()
@@ -175,6 +316,81 @@ FText SServerConfigPanel::GetPortText() const
 	return FText::AsNumber(Port);
 }
 
+TOptional<float> SServerConfigPanel::GetTickBudgetMs() const
+{
+	FUEPythonServerModule& ServerModule = FModuleManager::GetModuleChecked<FUEPythonServerModule>("UEPythonServer");
+	return ServerModule.GetTickBudgetMs();
+}
+
+void SServerConfigPanel::OnTickBudgetCommitted(float NewValue, ETextCommit::Type CommitType)
+{
+	if (CommitType == ETextCommit::OnEnter || CommitType == ETextCommit::OnUserMovedFocus)
+	{
+		FUEPythonServerModule& ServerModule = FModuleManager::GetModuleChecked<FUEPythonServerModule>("UEPythonServer");
+		ServerModule.SetTickBudgetMs(NewValue);
+	}
+}
+
+TOptional<float> SServerConfigPanel::GetDefaultTimeoutSeconds() const
+{
+	FUEPythonServerModule& ServerModule = FModuleManager::GetModuleChecked<FUEPythonServerModule>("UEPythonServer");
+	return ServerModule.GetDefaultTimeoutSeconds();
+}
+
+void SServerConfigPanel::OnDefaultTimeoutCommitted(float NewValue, ETextCommit::Type CommitType)
+{
+	if (CommitType == ETextCommit::OnEnter || CommitType == ETextCommit::OnUserMovedFocus)
+	{
+		FUEPythonServerModule& ServerModule = FModuleManager::GetModuleChecked<FUEPythonServerModule>("UEPythonServer");
+		ServerModule.SetDefaultTimeoutSeconds(NewValue);
+	}
+}
+
+TOptional<int32> SServerConfigPanel::GetMaxOutputKB() const
+{
+	FUEPythonServerModule& ServerModule = FModuleManager::GetModuleChecked<FUEPythonServerModule>("UEPythonServer");
+	return ServerModule.GetMaxOutputChars() / 1024;
+}
+
+void SServerConfigPanel::OnMaxOutputCommitted(int32 NewValue, ETextCommit::Type CommitType)
+{
+	if (CommitType == ETextCommit::OnEnter || CommitType == ETextCommit::OnUserMovedFocus)
+	{
+		FUEPythonServerModule& ServerModule = FModuleManager::GetModuleChecked<FUEPythonServerModule>("UEPythonServer");
+		ServerModule.SetMaxOutputChars(NewValue * 1024);
+	}
+}
+
+ECheckBoxState SServerConfigPanel::GetLogOutputState() const
+{
+	FUEPythonServerModule& ServerModule = FModuleManager::GetModuleChecked<FUEPythonServerModule>("UEPythonServer");
+	return ServerModule.IsOutputLogged() ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+}
+
+void SServerConfigPanel::OnLogOutputChanged(ECheckBoxState NewState)
+{
+	FUEPythonServerModule& ServerModule = FModuleManager::GetModuleChecked<FUEPythonServerModule>("UEPythonServer");
+	ServerModule.SetLogOutput(NewState == ECheckBoxState::Checked);
+}
+
+FText SServerConfigPanel::GetPreloadModulesText() const
+{
+	FUEPythonServerModule& ServerModule = FModuleManager::GetModuleChecked<FUEPythonServerModule>("UEPythonServer");
+	return FText::FromString(FString::Join(ServerModule.GetPreloadModules(), TEXT(", ")));
+}
+
+void SServerConfigPanel::OnPreloadModulesCommitted(const FText& InText, ETextCommit::Type CommitType)
+{
+	if (CommitType == ETextCommit::OnEnter || CommitType == ETextCommit::OnUserMovedFocus)
+	{
+		TArray<FString> ModuleNames;
+		InText.ToString().ParseIntoArray(ModuleNames, TEXT(","), /* InCullEmpty */ true);
+		
+		FUEPythonServerModule& ServerModule = FModuleManager::GetModuleChecked<FUEPythonServerModule>("UEPythonServer");
+		ServerModule.SetPreloadModules(ModuleNames);
+	}
+}
+
 FReply SServerConfigPanel::OnToggleServer()
 {
 	// Get the server module
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "Widgets/SCompoundWidget.h"
 #include "Input/Reply.h"
+#include "Styling/SlateTypes.h"
 
 /**
  * Server configuration panel widget
@@ -28,6 +29,36 @@ public:
 	/** Get the current port text */
 	FText GetPortText() const;
 	
+	/** Get the dispatcher tick budget from the server module */
+	TOptional<float> GetTickBudgetMs() const;
+	
+	/** Apply a new dispatcher tick budget to the server module */
+	void OnTickBudgetCommitted(float NewValue, ETextCommit::Type CommitType);
+	
+	/** Get the default script timeout from the server module */
+	TOptional<float> GetDefaultTimeoutSeconds() const;
+	
+	/** Apply a new default script timeout to the server module */
+	void OnDefaultTimeoutCommitted(float NewValue, ETextCommit::Type CommitType);
+	
+	/** Get the per-run output cap from the server module, in KB */
+	TOptional<int32> GetMaxOutputKB() const;
+	
+	/** Apply a new per-run output cap to the server module */
+	void OnMaxOutputCommitted(int32 NewValue, ETextCommit::Type CommitType);
+	
+	/** Get whether the server module logs Python output */
+	ECheckBoxState GetLogOutputState() const;
+	
+	/** Toggle logging of Python output */
+	void OnLogOutputChanged(ECheckBoxState NewState);
+	
+	/** Get the preload list from the server module, comma separated */
+	FText GetPreloadModulesText() const;
+	
+	/** Apply a new preload list to the server module */
+	void OnPreloadModulesCommitted(const FText& InText, ETextCommit::Type CommitType);
+	
 	/** Toggle server state (start/stop) */
 	FReply OnToggleServer();
 	
@@ -7,6 +7,7 @@ that connects AI agents with Blender and Unreal Engine.
 
 import logging
 import json
+import os
 import uuid
 import asyncio
 import traceback
@@ -25,7 +26,7 @@ from .blender_addon_server.extended_server import (
     DummyBlenderConnection,
     BlenderConnection
 )
-from .unreal_connection import UnrealConnection
+from .unreal_connection import FINISHED_JOB_STATES, UnrealConnection, UnrealFleet
 from .langchain_integration import LangchainManager
 from .ai_tools import ToolHandler
 from .ai_tools.prompt_engineering import (
@@ -57,6 +58,9 @@ app.add_middleware(
 # Store active connections
 active_connections: Dict[str, Dict[str, Any]] = {}
 
+# Time a job relay keeps retrying while the editor does not answer, such as during a restart
+JOB_RELAY_SILENCE_SECONDS = 60.0
+
 # Message models
 class Message(BaseModel):
     """Model for messages exchanged with the AI agent."""
@@ -92,8 +96,8 @@ except Exception as e:
     logger.warning("Using dummy Blender connection instead. Some features may not work.")
     blender_connection = DummyBlenderConnection()
 
-# Initialize Unreal connection
-unreal_connection = UnrealConnection()
+# Initialize Unreal connection, UNREAL_FLEET=1 spreads work over every editor instance of this machine
+unreal_connection = UnrealFleet() if os.environ.get("UNREAL_FLEET") == "1" else UnrealConnection()
 langchain_manager = LangchainManager()
 tool_handler = ToolHandler(blender_connection, unreal_connection)
 
@@ -442,6 +446,73 @@ async def send_to_stream(message: Message, connection_id: str):
             raise e
         raise HTTPException(status_code=500, detail=str(e))
 
+@app.post("/stream/unreal_job")
+async def relay_unreal_job(connection_id: str, job_id: str, poll_interval: float = 0.25):
+    """
+    Relay the streamed output of an Unreal Engine job to a stream connection.
+    
+    The job must have been submitted with streaming enabled. Output is sent as
+    "unreal_output" events, followed by one "unreal_job_complete" event.
+    
+    Args:
+        connection_id: ID of the connection to send to
+        job_id: ID of the Unreal Engine job
+        poll_interval: Seconds between polls of the Unreal plugin
+        
+    Returns:
+        Dict with the result
+    """
+    if connection_id not in active_connections:
+        raise HTTPException(status_code=404, detail=f"Connection not found: {connection_id}")
+    
+    queue = active_connections[connection_id]["queue"]
+    
+    async def poll_and_queue():
+        offset = 0
+        last_answer = time.monotonic()
+        while connection_id in active_connections:
+            chunk = await asyncio.to_thread(unreal_connection.read_job_output, job_id, offset)
+            
+            # The editor not answering does not end the job, only give up once it stays silent
+            if chunk.get("retryable") and time.monotonic() - last_answer < JOB_RELAY_SILENCE_SECONDS:
+                await asyncio.sleep(max(poll_interval, 1.0))
+                continue
+            if chunk.get("status") != "success":
+                await queue.put({"event": "unreal_job_complete", "data": json.dumps(chunk)})
+                return
+            last_answer = time.monotonic()
+            
+            if chunk["output"] or chunk["dropped"]:
+                await queue.put({
+                    "event": "unreal_output",
+                    "data": json.dumps({
+                        "job_id": job_id,
+                        "output": chunk["output"],
+                        "offset": chunk["offset"],
+                        "dropped": chunk["dropped"]
+                    })
+                })
+            offset = chunk["next_offset"]
+            
+            if chunk["state"] in FINISHED_JOB_STATES:
+                result = await asyncio.to_thread(unreal_connection.get_job, job_id)
+                await queue.put({"event": "unreal_job_complete", "data": json.dumps(result)})
+                return
+            
+            await asyncio.sleep(poll_interval)
+    
+    background_tasks = BackgroundTasks()
+    background_tasks.add_task(poll_and_queue)
+    
+    return JSONResponse(
+        content=create_success_response({
+            "connection_id": connection_id,
+            "job_id": job_id,
+            "message": "Relaying Unreal Engine job output to stream"
+        }),
+        background=background_tasks
+    )
+
 @app.get("/ai/prompts")
 async def get_ai_prompts(
     platform: Optional[str] = None,
@@ -553,6 +624,8 @@ async def status_endpoint():
                 unreal_status["message"] = "Connected successfully"
             except Exception as e:
                 unreal_status["error"] = str(e)
+        if isinstance(unreal_connection, UnrealFleet):
+            unreal_status["instances"] = unreal_connection.instances()
         
         return create_success_response({
             "server": {
@@ -5,12 +5,111 @@ This module provides functionality to communicate with the Unreal Engine plugin.
 """
 
 import logging
+import base64
+import gzip
 import json
+import os
+import asyncio
+import itertools
+import struct
+import sys
+import tempfile
+import threading
+import time
+import aiohttp
 import requests
-from typing import Dict, Any, Optional, Union
+from array import array
+from typing import Dict, Any, List, Optional, Union
 
 logger = logging.getLogger(__name__)
 
+# Code larger than this is sent gzip compressed to /execute
+COMPRESS_REQUEST_BYTES = 64 * 1024
+
+# Overrides the directory where editor instances advertise themselves, -PythonServerDiscoveryDir= in the editor
+DISCOVERY_DIR_ENV = "UEPYTHONSERVER_DISCOVERY_DIR"
+
+def default_discovery_dir() -> str:
+    """Get the directory the plugin writes its discovery files to by default, in the user's temp directory."""
+    return os.environ.get(DISCOVERY_DIR_ENV) or os.path.join(tempfile.gettempdir(), "UEPythonServer", "instances")
+
+# Job states after which a job no longer changes, the ones FPythonJob::IsFinished accepts
+FINISHED_JOB_STATES = frozenset(("succeeded", "failed", "cancelled"))
+
+# Field of the objects that stand in for binary attachments in an evaluated value
+ATTACHMENT_FIELD = "__attachment__"
+
+def _split_multipart(response) -> List[bytes]:
+    """Split a multipart/mixed response into the bodies of its parts, in order."""
+    content_type = response.headers.get("Content-Type", "")
+    boundary = content_type.split("boundary=", 1)[1].split(";", 1)[0].strip().strip('"')
+    delimiter = b"\r\n--" + boundary.encode("ascii")
+    
+    # The first delimiter has no leading CRLF, prepend one so every part splits the same way
+    parts = []
+    for chunk in (b"\r\n" + response.content).split(delimiter)[1:]:
+        if chunk.startswith(b"--"):
+            break
+        headers_end = chunk.find(b"\r\n\r\n")
+        parts.append(chunk[headers_end + 4:])
+    return parts
+
+def _resolve_attachments(value: Any, attachments: List[bytes]) -> Any:
+    """Replace the {"__attachment__": index} objects of an evaluated value with the attachment bytes."""
+    if isinstance(value, dict):
+        if ATTACHMENT_FIELD in value:
+            return attachments[int(value[ATTACHMENT_FIELD])]
+        return {key: _resolve_attachments(item, attachments) for key, item in value.items()}
+    if isinstance(value, list):
+        return [_resolve_attachments(item, attachments) for item in value]
+    return value
+
+# Buffer types of the /meshes binary layout, with the array typecode and components per vertex
+MESH_BUFFERS = {
+    "positions": (1, "f", 3),
+    "indices": (2, "I", None),
+    "normals": (3, "f", 3),
+    "uv0": (4, "f", 2),
+    "colors": (5, "B", 4),
+    "tangents": (6, "f", 3),
+}
+
+def _pack_mesh_buffer(values: Any, typecode: str) -> bytes:
+    """Pack a flat or nested sequence, a numpy array or raw bytes into little-endian bytes."""
+    if isinstance(values, (bytes, bytearray, memoryview)):
+        return bytes(values)
+    if hasattr(values, "astype"):
+        return values.astype({"f": "<f4", "I": "<u4", "B": "u1"}[typecode]).tobytes()
+    values = list(values)
+    if values and isinstance(values[0], (list, tuple)):
+        values = list(itertools.chain.from_iterable(values))
+    packed = array(typecode, values)
+    if sys.byteorder != "little":
+        packed.byteswap()
+    return packed.tobytes()
+
+def pack_mesh_stream(vertex_count: int, section: int = 0, **buffers: Any) -> bytes:
+    """
+    Encode mesh buffers in the binary layout of the plugin's /meshes endpoint.
+    
+    Buffers are passed by name, see MESH_BUFFERS, and buffers left out are not sent.
+    With Blender, fill flat arrays with foreach_get, for example
+    mesh.vertices.foreach_get("co", positions) and mesh.loop_triangles.foreach_get("vertices", indices).
+    """
+    chunks = [b"UEMS", struct.pack("<HHII", 1, section, vertex_count, 0)]
+    count = 0
+    for name, values in buffers.items():
+        if values is None:
+            continue
+        buffer_type, typecode, _ = MESH_BUFFERS[name]
+        data = _pack_mesh_buffer(values, typecode)
+        chunks.append(struct.pack("<II", buffer_type, len(data)))
+        chunks.append(data)
+        chunks.append(b"\0" * (-len(data) % 4))
+        count += 1
+    chunks[1] = struct.pack("<HHII", 1, section, vertex_count, count)
+    return b"".join(chunks)
+
 class UnrealConnection:
     """Class for managing connections to Unreal Engine."""
     
@@ -55,12 +154,22 @@ class UnrealConnection:
         self.is_connected = False
         logger.info("Unreal Engine connection closed")
     
-    def execute_code(self, code: str) -> Dict[str, Any]:
+    def execute_code(self, code: str, session_id: Optional[str] = None,
+                     cache_key: Optional[str] = None, cache_ttl: float = 0.0,
+                     priority: Optional[str] = None, timeout: Optional[float] = None,
+                     evaluate: bool = False) -> Dict[str, Any]:
         """
         Execute Python code in Unreal Engine.
         
         Args:
             code: Python code to execute
+            session_id: Optional session from create_session() to run in, instead of __main__
+            cache_key: Marks a read-only script idempotent, identical requests with the same key share one run
+            cache_ttl: Seconds to reuse the result of a cache-keyed request for, 0 to only share runs in flight
+            priority: Queue lane, "interactive", "normal" (the default) or "batch"
+            timeout: Seconds the script may run before it is interrupted, instead of the server's default
+            evaluate: Return the script's __result__, or else its final expression, under "value".
+                bytes in the value are sent as binary attachments and restored as bytes
             
         Returns:
             Dict with the execution result and/or error information
@@ -74,9 +183,141 @@ class UnrealConnection:
             payload = {
                 "code": code
             }
+            if session_id:
+                payload["session"] = session_id
+            if cache_key:
+                payload["cache_key"] = cache_key
+                payload["cache_ttl"] = cache_ttl
+            if priority:
+                payload["priority"] = priority
+            if timeout:
+                payload["timeout"] = timeout
+            if evaluate:
+                payload["eval"] = True
+            
+            # Large scripts are compressed, the plugin inflates them before parsing
+            body = json.dumps(payload).encode("utf-8")
+            headers = {"Content-Type": "application/json"}
+            if evaluate:
+                headers["Accept"] = "multipart/mixed, application/json"
+            if len(body) >= COMPRESS_REQUEST_BYTES:
+                body = gzip.compress(body, compresslevel=1)
+                headers["Content-Encoding"] = "gzip"
+            
+            response = requests.post(
+                f"{self.base_url}/execute", 
+                data=body, 
+                headers=headers,
+                timeout=max(30, timeout + 10) if timeout else 30
+            )
+            
+            if response.status_code == 200 and response.headers.get("Content-Type", "").startswith("multipart/mixed"):
+                parts = _split_multipart(response)
+                result = json.loads(parts[0])
+                result["value"] = _resolve_attachments(result.get("value"), parts[1:])
+                return result
+            elif response.status_code == 200:
+                result = response.json()
+                if "attachments" in result:
+                    attachments = [base64.b64decode(attachment) for attachment in result.pop("attachments")]
+                    result["value"] = _resolve_attachments(result.get("value"), attachments)
+                return result
+            else:
+                error_text = response.text
+                logger.error(f"Error from Unreal Engine: {error_text}")
+                return {"status": "error", "message": f"Unreal Engine returned {response.status_code}: {error_text}"}
+        except Exception as e:
+            logger.error(f"Error executing Unreal Engine code: {str(e)}")
+            return {"status": "error", "message": str(e)}
+    
+    def execute_batch(self, scripts: List[Union[str, Dict[str, Any]]], stop_on_error: bool = False,
+                      session_id: Optional[str] = None, priority: Optional[str] = None,
+                      timeout: Optional[float] = None, transaction: bool = False,
+                      transaction_name: Optional[str] = None) -> Dict[str, Any]:
+        """
+        Execute several Python scripts in Unreal Engine with a single request.
+        
+        Args:
+            scripts: Scripts to execute, either code strings or {"id": ..., "code": ...} dicts
+            stop_on_error: Skip the remaining scripts after the first failure
+            session_id: Optional session from create_session() to run every script in
+            priority: Queue lane, "interactive", "normal" (the default) or "batch"
+            timeout: Seconds the whole batch may run before it is interrupted, instead of the server's default
+            transaction: Make the batch a single undo step, with the editor's refresh work done once at the end
+            transaction_name: Name of the undo step, instead of the server's default
+            
+        Returns:
+            Dict with a "results" list in the same order as the scripts
+        """
+        if not self.is_connected:
+            connected = self.connect()
+            if not connected:
+                return {"status": "error", "message": "Not connected to Unreal Engine"}
+        
+        try:
+            payload = {
+                "scripts": [
+                    script if isinstance(script, dict) else {"id": str(index), "code": script}
+                    for index, script in enumerate(scripts)
+                ],
+                "stop_on_error": stop_on_error
+            }
+            if session_id:
+                payload["session"] = session_id
+            if priority:
+                payload["priority"] = priority
+            if timeout:
+                payload["timeout"] = timeout
+            if transaction:
+                payload["transaction"] = True
+                if transaction_name:
+                    payload["transaction_name"] = transaction_name
+            
+            response = requests.post(
+                f"{self.base_url}/execute_batch", 
+                json=payload, 
+                timeout=max(30, timeout + 10) if timeout else 30
+            )
+            
+            if response.status_code == 200:
+                return response.json()
+            else:
+                error_text = response.text
+                logger.error(f"Error from Unreal Engine: {error_text}")
+                return {"status": "error", "message": f"Unreal Engine returned {response.status_code}: {error_text}"}
+        except Exception as e:
+            logger.error(f"Error executing Unreal Engine batch: {str(e)}")
+            return {"status": "error", "message": str(e)}
+    
+    def submit_code(self, code: str, stream: bool = False, priority: Optional[str] = None,
+                    timeout: Optional[float] = None) -> Dict[str, Any]:
+        """
+        Queue Python code for asynchronous execution in Unreal Engine.
+        
+        Args:
+            code: Python code to execute
+            stream: Stream the output so it can be read while the job runs with read_job_output()
+            priority: Queue lane, "interactive", "normal" (the default) or "batch"
+            timeout: Seconds the job may run once started before it is interrupted
+            
+        Returns:
+            Dict with the "job_id" to poll with get_job()
+        """
+        if not self.is_connected:
+            connected = self.connect()
+            if not connected:
+                return {"status": "error", "message": "Not connected to Unreal Engine"}
+        
+        try:
+            payload = {"code": code}
+            if priority:
+                payload["priority"] = priority
+            if timeout:
+                payload["timeout"] = timeout
             
             response = requests.post(
                 f"{self.base_url}/execute", 
+                params={"stream": "1"} if stream else {"async": "1"},
                 json=payload, 
                 timeout=30
             )
@@ -88,7 +329,505 @@ class UnrealConnection:
                 logger.error(f"Error from Unreal Engine: {error_text}")
                 return {"status": "error", "message": f"Unreal Engine returned {response.status_code}: {error_text}"}
         except Exception as e:
-            logger.error(f"Error executing Unreal Engine code: {str(e)}")
+            logger.error(f"Error submitting Unreal Engine code: {str(e)}")
+            return {"status": "error", "message": str(e)}
+    
+    def get_job(self, job_id: str) -> Dict[str, Any]:
+        """
+        Get the state, and the result once finished, of an asynchronous job.
+        
+        Args:
+            job_id: Id returned by submit_code()
+            
+        Returns:
+            Dict with the job "state" and, when finished, its "result"
+        """
+        try:
+            response = requests.get(f"{self.base_url}/jobs/{job_id}", timeout=5)
+            
+            if response.status_code == 200:
+                return response.json()
+            else:
+                error_text = response.text
+                logger.error(f"Error from Unreal Engine: {error_text}")
+                return {"status": "error", "message": f"Unreal Engine returned {response.status_code}: {error_text}"}
+        except Exception as e:
+            logger.error(f"Error polling Unreal Engine job: {str(e)}")
+            return {"status": "error", "message": str(e)}
+    
+    def cancel_job(self, job_id: str) -> Dict[str, Any]:
+        """
+        Cancel a pending job, or interrupt a running one.
+        
+        The request goes to the status listener first, which answers from a worker thread
+        while the game thread is busy with the job, then to the HTTP port.
+        
+        Args:
+            job_id: Id returned by submit_code()
+            
+        Returns:
+            Dict with the job "state", "cancelled" or "cancelling" while it is interrupted
+        """
+        status_url = f"http://{self.host}:{self.port + 2}"
+        for base_url in (status_url, self.base_url):
+            try:
+                response = requests.post(f"{base_url}/jobs/{job_id}/cancel", timeout=5)
+                
+                if response.status_code == 200:
+                    return response.json()
+                error_text = response.text
+                logger.error(f"Error from Unreal Engine: {error_text}")
+                last_error = {"status": "error", "message": f"Unreal Engine returned {response.status_code}: {error_text}"}
+            except Exception as e:
+                logger.error(f"Error cancelling Unreal Engine job: {str(e)}")
+                last_error = {"status": "error", "message": str(e)}
+        return last_error
+    
+    def read_job_output(self, job_id: str, offset: int = 0) -> Dict[str, Any]:
+        """
+        Read the streamed output of a job submitted with submit_code(stream=True).
+        
+        The request goes to the status listener first, which answers from a worker thread
+        while the game thread runs the job, then to the HTTP port, which only answers between
+        game-thread ticks.
+        
+        Args:
+            job_id: Id returned by submit_code()
+            offset: Offset returned as "next_offset" by the previous read
+            
+        Returns:
+            Dict with the new "output", the "next_offset" and the job "state". When neither port
+            answered, the error has "retryable" set, the job may still be running
+        """
+        status_url = f"http://{self.host}:{self.port + 2}"
+        last_error = None
+        for base_url in (status_url, self.base_url):
+            try:
+                response = requests.get(f"{base_url}/jobs/{job_id}/output", params={"offset": offset}, timeout=5)
+                
+                if response.status_code == 200:
+                    return response.json()
+                error_text = response.text
+                logger.error(f"Error from Unreal Engine: {error_text}")
+                last_error = {"status": "error", "message": f"Unreal Engine returned {response.status_code}: {error_text}"}
+            except Exception as e:
+                logger.debug(f"Error reading Unreal Engine job output from {base_url}: {str(e)}")
+                if last_error is None or last_error.get("retryable"):
+                    last_error = {"status": "error", "message": str(e), "retryable": True}
+        return last_error
+    
+    def register_script(self, name: str, code: str) -> Dict[str, Any]:
+        """
+        Upload a script once so it can be invoked by name with invoke_script().
+        
+        Args:
+            name: Name to register the script under (letters, digits, '_', '-' and '.')
+            code: Python code of the script, which reads its arguments from the `args` dict
+            
+        Returns:
+            Dict with the registration status, or the compile error
+        """
+        return self._post("/scripts/register", {"name": name, "code": code})
+    
+    def invoke_script(self, name: str, args: Optional[Dict[str, Any]] = None) -> Dict[str, Any]:
+        """
+        Invoke a script previously uploaded with register_script().
+        
+        Args:
+            name: Name the script was registered under
+            args: JSON-serializable arguments, exposed to the script as the `args` dict
+            
+        Returns:
+            Dict with the execution result and/or error information
+        """
+        return self._post(f"/scripts/{name}/invoke", {"args": args or {}})
+    
+    def upload_asset(self, data: Union[bytes, str], filename: Optional[str] = None,
+                     destination_path: str = "/Game/Uploads", asset_name: Optional[str] = None,
+                     import_now: bool = True, save: bool = False) -> Dict[str, Any]:
+        """
+        Upload asset bytes to Unreal Engine and import them, without Unreal re-reading a file from disk.
+        
+        Args:
+            data: The file bytes, or the path of a local file to read them from
+            filename: Name of the uploaded file, its extension selects the importer. Defaults to the file name of the path
+            destination_path: Content folder to import into
+            asset_name: Name of the new asset, defaults to the file name without extension
+            import_now: Whether to import right away, otherwise the upload is only staged
+            save: Whether to save the imported packages
+            
+        Returns:
+            Dict with the upload id and the imported object paths
+        """
+        if isinstance(data, str):
+            filename = filename or os.path.basename(data)
+            with open(data, "rb") as f:
+                data = f.read()
+        
+        if not filename:
+            return {"status": "error", "message": "A filename is required when uploading bytes"}
+        
+        if not self.is_connected:
+            connected = self.connect()
+            if not connected:
+                return {"status": "error", "message": "Not connected to Unreal Engine"}
+        
+        params = {
+            "filename": filename,
+            "destination": destination_path,
+            "import": "1" if import_now else "0",
+            "save": "1" if save else "0",
+        }
+        if asset_name:
+            params["name"] = asset_name
+        
+        try:
+            response = requests.post(
+                f"{self.base_url}/upload",
+                params=params,
+                data=data,
+                headers={"Content-Type": "application/octet-stream"},
+                timeout=300,
+            )
+            
+            if response.status_code == 200:
+                return response.json()
+            else:
+                error_text = response.text
+                logger.error(f"Error from Unreal Engine: {error_text}")
+                return {"status": "error", "message": f"Unreal Engine returned {response.status_code}: {error_text}"}
+        except Exception as e:
+            logger.error(f"Error uploading asset to Unreal Engine: {str(e)}")
+            return {"status": "error", "message": str(e)}
+    
+    def import_batch(self, items: List[Dict[str, Any]], destination_path: str = "/Game/Uploads",
+                     save: bool = True, replace_existing: bool = True, slice_size: int = 16) -> Dict[str, Any]:
+        """
+        Import many assets with one grouped AssetTools call per slice and a single save at the end.
+        
+        Args:
+            items: Manifest items, each with a "filename" on the Unreal host or an "upload_id" from
+                upload_asset(import_now=False), and optionally "id", "destination" and "name"
+            destination_path: Content folder for items without their own destination
+            save: Whether to save the imported packages once every item has been imported
+            replace_existing: Whether existing assets are replaced
+            slice_size: Items imported per editor tick slice
+            
+        Returns:
+            Dict with the "batch_id" to poll with get_import_batch()
+        """
+        return self._post("/import/batch", {
+            "items": items,
+            "destination": destination_path,
+            "save": save,
+            "replace": replace_existing,
+            "slice_size": slice_size,
+        })
+    
+    def get_import_batch(self, batch_id: str) -> Dict[str, Any]:
+        """
+        Get the progress of an import batch.
+        
+        Args:
+            batch_id: Id returned by import_batch()
+            
+        Returns:
+            Dict with the batch "state", "completed" out of "total", and the state of every item
+        """
+        try:
+            response = requests.get(f"{self.base_url}/import/batch/{batch_id}", timeout=5)
+            
+            if response.status_code == 200:
+                return response.json()
+            else:
+                error_text = response.text
+                logger.error(f"Error from Unreal Engine: {error_text}")
+                return {"status": "error", "message": f"Unreal Engine returned {response.status_code}: {error_text}"}
+        except Exception as e:
+            logger.error(f"Error polling Unreal Engine import batch: {str(e)}")
+            return {"status": "error", "message": str(e)}
+    
+    def spawn_actor(self, actor_class: str = "StaticMeshActor", mesh: Optional[str] = None,
+                    location: Optional[List[float]] = None, rotation: Optional[List[float]] = None,
+                    scale: Optional[List[float]] = None, label: Optional[str] = None) -> Dict[str, Any]:
+        """
+        Spawn an actor through the native fast path, without running Python in Unreal.
+        
+        Args:
+            actor_class: Class name or path, such as "StaticMeshActor" or "/Game/BP_Tree.BP_Tree_C"
+            mesh: Static mesh to assign, such as "/Engine/BasicShapes/Cube.Cube"
+            location: [x, y, z]
+            rotation: [pitch, yaw, roll]
+            scale: [x, y, z]
+            label: Label shown in the World Outliner
+            
+        Returns:
+            Dict with the new actor's "name", "label" and "path"
+        """
+        payload: Dict[str, Any] = {"class": actor_class}
+        for key, value in (("mesh", mesh), ("location", location), ("rotation", rotation), ("scale", scale), ("label", label)):
+            if value is not None:
+                payload[key] = value
+        return self._post("/actors/spawn", payload)
+    
+    def set_actor_transforms(self, transforms: List[Dict[str, Any]]) -> Dict[str, Any]:
+        """
+        Move several actors in one request through the native fast path.
+        
+        Args:
+            transforms: Entries with the "actor" name or label and any of "location", "rotation" and "scale"
+            
+        Returns:
+            Dict with the number of actors "updated"
+        """
+        return self._post("/actors/transform", {"actors": transforms})
+    
+    def set_material_parameter(self, actor: str, parameter: str, value: Union[float, List[float], str], slot: int = 0) -> Dict[str, Any]:
+        """
+        Set a material parameter on an actor through the native fast path.
+        
+        Args:
+            actor: Actor name or label
+            parameter: Material parameter name
+            value: A number for scalar parameters, [r, g, b(, a)] for vector parameters or a texture path
+            slot: Material slot of the actor's primitive component
+            
+        Returns:
+            Dict with the dynamic material instance path
+        """
+        payload: Dict[str, Any] = {"actor": actor, "parameter": parameter, "slot": slot}
+        if isinstance(value, str):
+            payload["texture"] = value
+        elif isinstance(value, (list, tuple)):
+            payload["vector"] = list(value)
+        else:
+            payload["scalar"] = value
+        return self._post("/actors/material_parameter", payload)
+    
+    def list_actors(self, actor_class: Optional[str] = None, limit: int = 10000) -> Dict[str, Any]:
+        """
+        List the actors of the level with their transforms through the native fast path.
+        
+        Args:
+            actor_class: Only list actors of this class or a subclass
+            limit: Maximum number of actors to return
+            
+        Returns:
+            Dict with the "actors" list and the "total" number of matching actors
+        """
+        params: Dict[str, Any] = {"limit": limit}
+        if actor_class:
+            params["class"] = actor_class
+        
+        try:
+            response = requests.get(f"{self.base_url}/actors", params=params, timeout=30)
+            
+            if response.status_code == 200:
+                return response.json()
+            else:
+                error_text = response.text
+                logger.error(f"Error from Unreal Engine: {error_text}")
+                return {"status": "error", "message": f"Unreal Engine returned {response.status_code}: {error_text}"}
+        except Exception as e:
+            logger.error(f"Error listing Unreal Engine actors: {str(e)}")
+            return {"status": "error", "message": str(e)}
+    
+    def get_scene_changes(self, since: int = 0, limit: int = 10000) -> Dict[str, Any]:
+        """
+        Get the actor changes of the level since a journal sequence number.
+        
+        Start from the "sequence" of list_actors(), then pass each reply's "next_since" to the next call.
+        When the reply has "reset" set, the changes are no longer retained and list_actors() must be called again.
+        Moves by set_actor_location or set_actor_transform outside an editor transaction are not reported.
+        
+        Args:
+            since: The last sequence number seen
+            limit: Maximum number of changes to return, "more" is set when there are further changes
+            
+        Returns:
+            Dict with the "changes", "next_since", "more" and "reset" fields
+        """
+        try:
+            response = requests.get(f"{self.base_url}/scene/changes", params={"since": since, "limit": limit}, timeout=30)
+            
+            if response.status_code == 200:
+                return response.json()
+            else:
+                error_text = response.text
+                logger.error(f"Error from Unreal Engine: {error_text}")
+                return {"status": "error", "message": f"Unreal Engine returned {response.status_code}: {error_text}"}
+        except Exception as e:
+            logger.error(f"Error reading Unreal Engine scene changes: {str(e)}")
+            return {"status": "error", "message": str(e)}
+    
+    def capture(self, width: int = 1280, height: int = 720, image_format: str = "jpeg", quality: int = 85,
+                location: Optional[List[float]] = None, rotation: Optional[List[float]] = None,
+                fov: Optional[float] = None) -> Dict[str, Any]:
+        """
+        Render the scene to an image on the server.
+        
+        The camera is the active level viewport's unless location, rotation or fov are given.
+        
+        Args:
+            width: Image width in pixels
+            height: Image height in pixels
+            image_format: "jpeg" or "png"
+            quality: JPEG quality, 1 to 100
+            location: Camera location as [x, y, z]
+            rotation: Camera rotation as [pitch, yaw, roll]
+            fov: Horizontal field of view in degrees
+            
+        Returns:
+            Dict with the encoded "image" bytes and its "content_type"
+        """
+        params: Dict[str, Any] = {"width": width, "height": height, "format": image_format, "quality": quality}
+        if location is not None:
+            params["location"] = ",".join(str(value) for value in location)
+        if rotation is not None:
+            params["rotation"] = ",".join(str(value) for value in rotation)
+        if fov is not None:
+            params["fov"] = fov
+        
+        try:
+            response = requests.get(f"{self.base_url}/capture", params=params, timeout=30)
+            content_type = response.headers.get("Content-Type", "")
+            
+            if response.status_code == 200 and content_type.startswith("image/"):
+                return {"status": "success", "content_type": content_type, "image": response.content}
+            elif content_type.startswith("application/json"):
+                return response.json()
+            else:
+                error_text = response.text
+                logger.error(f"Error from Unreal Engine: {error_text}")
+                return {"status": "error", "message": f"Unreal Engine returned {response.status_code}: {error_text}"}
+        except Exception as e:
+            logger.error(f"Error capturing Unreal Engine scene: {str(e)}")
+            return {"status": "error", "message": str(e)}
+    
+    def stream_mesh(self, name: str, vertex_count: int, section: int = 0, blender_space: bool = True,
+                    material: Optional[str] = None, collision: Optional[bool] = None, **buffers: Any) -> Dict[str, Any]:
+        """
+        Create or update a mesh in the level from raw vertex buffers, without an FBX round trip.
+        
+        The first call of a section sends positions and indices. Later calls may send only the
+        buffers that changed, an update of the positions alone is applied in place.
+        
+        Args:
+            name: Name of the mesh, also the label of its actor
+            vertex_count: Number of vertices of the section
+            section: Index of the section, one per material
+            blender_space: Whether the buffers are in Blender's right-handed meters
+            material: Optional material path for the section
+            collision: Whether the section gets collision, kept as it is when None
+            **buffers: positions, indices, normals, uv0, colors and tangents, see MESH_BUFFERS
+            
+        Returns:
+            Dict with the "vertices" and "triangles" of the section, and whether it was "rebuilt"
+        """
+        params: Dict[str, Any] = {"space": "blender" if blender_space else "unreal"}
+        if material:
+            params["material"] = material
+        if collision is not None:
+            params["collision"] = int(collision)
+        
+        try:
+            response = requests.post(
+                f"{self.base_url}/meshes/{name}",
+                params=params,
+                data=pack_mesh_stream(vertex_count, section, **buffers),
+                headers={"Content-Type": "application/octet-stream"},
+                timeout=30
+            )
+            
+            if response.status_code == 200:
+                return response.json()
+            else:
+                error_text = response.text
+                logger.error(f"Error from Unreal Engine: {error_text}")
+                return {"status": "error", "message": f"Unreal Engine returned {response.status_code}: {error_text}"}
+        except Exception as e:
+            logger.error(f"Error streaming mesh to Unreal Engine: {str(e)}")
+            return {"status": "error", "message": str(e)}
+    
+    def remove_mesh(self, name: str) -> Dict[str, Any]:
+        """Destroy the actor of a mesh created with stream_mesh()."""
+        try:
+            response = requests.delete(f"{self.base_url}/meshes/{name}", timeout=5)
+            
+            if response.status_code == 200:
+                return response.json()
+            else:
+                error_text = response.text
+                logger.error(f"Error from Unreal Engine: {error_text}")
+                return {"status": "error", "message": f"Unreal Engine returned {response.status_code}: {error_text}"}
+        except Exception as e:
+            logger.error(f"Error removing Unreal Engine mesh: {str(e)}")
+            return {"status": "error", "message": str(e)}
+    
+    def create_session(self, name: str = "") -> Dict[str, Any]:
+        """
+        Create a persistent execution context in Unreal Engine.
+        
+        Code run with the returned "session_id" shares globals across calls, so imports and
+        state are kept, without seeing the globals of other clients. Sessions that are not
+        used for "idle_timeout_seconds" are evicted.
+        
+        Args:
+            name: Optional name shown by list_sessions()
+            
+        Returns:
+            Dict with the "session_id"
+        """
+        return self._post("/sessions", {"name": name})
+    
+    def list_sessions(self) -> Dict[str, Any]:
+        """List the execution contexts alive in Unreal Engine."""
+        try:
+            response = requests.get(f"{self.base_url}/sessions", timeout=5)
+            
+            if response.status_code == 200:
+                return response.json()
+            else:
+                error_text = response.text
+                logger.error(f"Error from Unreal Engine: {error_text}")
+                return {"status": "error", "message": f"Unreal Engine returned {response.status_code}: {error_text}"}
+        except Exception as e:
+            logger.error(f"Error listing Unreal Engine sessions: {str(e)}")
+            return {"status": "error", "message": str(e)}
+    
+    def close_session(self, session_id: str) -> Dict[str, Any]:
+        """Drop an execution context and its globals."""
+        try:
+            response = requests.delete(f"{self.base_url}/sessions/{session_id}", timeout=5)
+            
+            if response.status_code == 200:
+                return response.json()
+            else:
+                error_text = response.text
+                logger.error(f"Error from Unreal Engine: {error_text}")
+                return {"status": "error", "message": f"Unreal Engine returned {response.status_code}: {error_text}"}
+        except Exception as e:
+            logger.error(f"Error closing Unreal Engine session: {str(e)}")
+            return {"status": "error", "message": str(e)}
+    
+    def _post(self, path: str, payload: Dict[str, Any]) -> Dict[str, Any]:
+        """POST a JSON payload to the plugin and return the decoded response."""
+        if not self.is_connected:
+            connected = self.connect()
+            if not connected:
+                return {"status": "error", "message": "Not connected to Unreal Engine"}
+        
+        try:
+            response = requests.post(f"{self.base_url}{path}", json=payload, timeout=30)
+            
+            if response.status_code == 200:
+                return response.json()
+            else:
+                error_text = response.text
+                logger.error(f"Error from Unreal Engine: {error_text}")
+                return {"status": "error", "message": f"Unreal Engine returned {response.status_code}: {error_text}"}
+        except Exception as e:
+            logger.error(f"Error calling Unreal Engine {path}: {str(e)}")
             return {"status": "error", "message": str(e)}
     
     # Convenience methods for common Unreal Engine operations
@@ -141,5 +880,377 @@ print(version)
         except Exception as e:
             return {"status": "error", "message": f"Error executing command {command_type}: {str(e)}"}
 
+class UnrealFleet:
+    """
+    Routes work across several Unreal editor instances on this machine, to the least loaded one.
+    
+    Instances are found through the discovery files the plugin writes. Work that refers to
+    state held by one instance, such as a job, a session or a staged upload, goes back to the
+    instance that created it. Other calls go to the least loaded instance. It exposes the same
+    methods as UnrealConnection, so it can replace one.
+    """
+    
+    def __init__(self, discovery_dir: Optional[str] = None, stale_seconds: float = 30.0,
+                 load_cache_seconds: float = 0.5):
+        """
+        Initialize a fleet router.
+        
+        Args:
+            discovery_dir: Directory of the plugin's discovery files, see default_discovery_dir()
+            stale_seconds: Ignore instances whose discovery file was not updated for this long
+            load_cache_seconds: How long a load reading from an instance's status port is reused
+        """
+        self.discovery_dir = discovery_dir or default_discovery_dir()
+        self.stale_seconds = stale_seconds
+        self.load_cache_seconds = load_cache_seconds
+        self._connections: Dict[str, UnrealConnection] = {}
+        self._instances: Dict[str, Dict[str, Any]] = {}
+        self._loads: Dict[str, Any] = {}
+        self._in_flight: Dict[str, int] = {}
+        self._owners: Dict[str, str] = {}
+        self._lock = threading.Lock()
+    
+    @property
+    def is_connected(self) -> bool:
+        """Whether at least one instance is known."""
+        return bool(self._instances)
+    
+    def connect(self) -> bool:
+        """
+        Discover the running instances.
+        
+        Returns:
+            bool: True if at least one instance was found
+        """
+        instances = self.discover()
+        logger.info(f"Found {len(instances)} Unreal Engine instances in {self.discovery_dir}")
+        return bool(instances)
+    
+    def disconnect(self) -> None:
+        """Forget the known instances."""
+        with self._lock:
+            self._instances.clear()
+            self._connections.clear()
+            self._loads.clear()
+    
+    def discover(self) -> List[Dict[str, Any]]:
+        """
+        Read the discovery files and keep the instances that updated theirs recently.
+        
+        Returns:
+            List of instance descriptions, as written by the plugin
+        """
+        instances = {}
+        now = time.time()
+        try:
+            names = os.listdir(self.discovery_dir)
+        except OSError:
+            names = []
+        for name in names:
+            if not name.endswith(".json"):
+                continue
+            try:
+                with open(os.path.join(self.discovery_dir, name), encoding="utf-8") as file:
+                    instance = json.load(file)
+            except (OSError, ValueError):
+                continue
+            if now - instance.get("updated_at", 0) > self.stale_seconds:
+                continue
+            key = f"localhost:{instance['port']}"
+            instance["key"] = key
+            instances[key] = instance
+        
+        with self._lock:
+            self._instances = instances
+            for key, instance in instances.items():
+                if key not in self._connections:
+                    connection = UnrealConnection(port=instance["port"])
+                    connection.is_connected = True
+                    self._connections[key] = connection
+        return list(instances.values())
+    
+    def instances(self) -> List[Dict[str, Any]]:
+        """
+        Get the known instances with their current load.
+        
+        Returns:
+            List of instance descriptions with a "load" field
+        """
+        return [dict(instance, load=self._load(instance)) for instance in list(self._instances.values())]
+    
+    def _load(self, instance: Dict[str, Any]) -> float:
+        """
+        Score how busy an instance is, lower is better.
+        
+        The status port answers from a worker thread, so it reports the queue depth even while
+        the game thread runs a script. A stale snapshot means the game thread is busy with one.
+        Requests this router has in flight count too, since their jobs may not be queued yet.
+        """
+        key = instance["key"]
+        now = time.monotonic()
+        with self._lock:
+            cached = self._loads.get(key)
+            in_flight = self._in_flight.get(key, 0)
+        if cached is not None and now - cached[0] < self.load_cache_seconds:
+            return cached[1] + in_flight
+        
+        load = float("inf")
+        status_port = instance.get("status_port") or instance["port"]
+        try:
+            response = requests.get(f"http://localhost:{status_port}/status", timeout=0.5)
+            if response.status_code == 200:
+                status = response.json()
+                load = float(status.get("pending_jobs", 0))
+                if float(response.headers.get("X-Snapshot-Age-Ms", 0)) > 250:
+                    load += 1.0
+        except Exception as e:
+            logger.debug(f"Unreal Engine instance {key} did not answer: {str(e)}")
+        
+        with self._lock:
+            self._loads[key] = (now, load)
+        return load + in_flight
+    
+    def _pick(self) -> Optional[str]:
+        """Get the key of the least loaded instance, discovering instances when none is known."""
+        if not self._instances:
+            self.discover()
+        candidates = [(self._load(instance), instance["key"]) for instance in list(self._instances.values())]
+        candidates = [candidate for candidate in candidates if candidate[0] != float("inf")]
+        if not candidates:
+            # Instances may have come and gone since the last discovery
+            self.discover()
+            candidates = [(self._load(instance), instance["key"]) for instance in list(self._instances.values())]
+            candidates = [candidate for candidate in candidates if candidate[0] != float("inf")]
+        return min(candidates)[1] if candidates else None
+    
+    def _call(self, key: Optional[str], method: str, *args, **kwargs) -> Dict[str, Any]:
+        """Call a method of an instance's connection, counting the call as in flight."""
+        if key is None or key not in self._connections:
+            return {"status": "error", "message": "No Unreal Engine instance available"}
+        with self._lock:
+            self._in_flight[key] = self._in_flight.get(key, 0) + 1
+        try:
+            result = getattr(self._connections[key], method)(*args, **kwargs)
+        finally:
+            with self._lock:
+                self._in_flight[key] -= 1
+        if isinstance(result, dict):
+            result.setdefault("instance", key)
+        return result
+    
+    def _remember(self, result: Dict[str, Any], field: str, key: Optional[str]) -> Dict[str, Any]:
+        """Record which instance owns the id a call returned."""
+        if key is not None and isinstance(result, dict) and result.get(field):
+            with self._lock:
+                self._owners[result[field]] = key
+        return result
+    
+    def _owner(self, owned_id: Optional[str]) -> Optional[str]:
+        """Get the instance owning an id, or the least loaded instance for unknown ids."""
+        with self._lock:
+            key = self._owners.get(owned_id) if owned_id else None
+        return key or self._pick()
+    
+    def execute_code(self, code: str, session_id: Optional[str] = None, **kwargs) -> Dict[str, Any]:
+        """Execute Python code, in the session's instance or the least loaded one. See UnrealConnection.execute_code."""
+        return self._call(self._owner(session_id), "execute_code", code, session_id=session_id, **kwargs)
+    
+    def execute_batch(self, scripts: List[Union[str, Dict[str, Any]]], stop_on_error: bool = False,
+                      session_id: Optional[str] = None, **kwargs) -> Dict[str, Any]:
+        """Execute several scripts on one instance. See UnrealConnection.execute_batch."""
+        return self._call(self._owner(session_id), "execute_batch", scripts, stop_on_error, session_id=session_id, **kwargs)
+    
+    def submit_code(self, code: str, **kwargs) -> Dict[str, Any]:
+        """Queue Python code on the least loaded instance. See UnrealConnection.submit_code."""
+        key = self._pick()
+        return self._remember(self._call(key, "submit_code", code, **kwargs), "job_id", key)
+    
+    def get_job(self, job_id: str) -> Dict[str, Any]:
+        """Poll a job on the instance that queued it."""
+        return self._call(self._owner(job_id), "get_job", job_id)
+    
+    def cancel_job(self, job_id: str) -> Dict[str, Any]:
+        """Cancel a job on the instance that queued it."""
+        return self._call(self._owner(job_id), "cancel_job", job_id)
+    
+    def read_job_output(self, job_id: str, offset: int = 0) -> Dict[str, Any]:
+        """Read the streamed output of a job from the instance that runs it."""
+        return self._call(self._owner(job_id), "read_job_output", job_id, offset)
+    
+    def upload_asset(self, *args, **kwargs) -> Dict[str, Any]:
+        """Upload an asset to the least loaded instance. See UnrealConnection.upload_asset."""
+        key = self._pick()
+        return self._remember(self._call(key, "upload_asset", *args, **kwargs), "upload_id", key)
+    
+    def import_batch(self, items: List[Dict[str, Any]], *args, **kwargs) -> Dict[str, Any]:
+        """Import a manifest on the instance holding its staged uploads, if any."""
+        upload_ids = [item["upload_id"] for item in items if item.get("upload_id")]
+        key = self._owner(upload_ids[0] if upload_ids else None)
+        return self._remember(self._call(key, "import_batch", items, *args, **kwargs), "batch_id", key)
+    
+    def get_import_batch(self, batch_id: str) -> Dict[str, Any]:
+        """Read the progress of an import batch from the instance running it."""
+        return self._call(self._owner(batch_id), "get_import_batch", batch_id)
+    
+    def stream_mesh(self, name: str, *args, **kwargs) -> Dict[str, Any]:
+        """Stream a mesh to the instance it was first sent to. See UnrealConnection.stream_mesh."""
+        key = self._owner(f"mesh:{name}")
+        result = self._call(key, "stream_mesh", name, *args, **kwargs)
+        if result.get("status") == "success":
+            self._remember({"mesh": f"mesh:{name}"}, "mesh", key)
+        return result
+    
+    def remove_mesh(self, name: str) -> Dict[str, Any]:
+        """Remove a streamed mesh from the instance showing it."""
+        return self._call(self._owner(f"mesh:{name}"), "remove_mesh", name)
+    
+    def create_session(self, name: str = "") -> Dict[str, Any]:
+        """Create a session on the least loaded instance, later calls for it go to that instance."""
+        key = self._pick()
+        return self._remember(self._call(key, "create_session", name), "session_id", key)
+    
+    def close_session(self, session_id: str) -> Dict[str, Any]:
+        """Close a session on the instance holding it."""
+        return self._call(self._owner(session_id), "close_session", session_id)
+    
+    def list_sessions(self) -> Dict[str, Any]:
+        """List the sessions of every instance, each tagged with its "instance"."""
+        sessions = []
+        for key in list(self._instances):
+            result = self._call(key, "list_sessions")
+            for session in result.get("sessions", []):
+                sessions.append(dict(session, instance=key))
+        return {"status": "success", "sessions": sessions}
+    
+    def __getattr__(self, name: str):
+        """Send any other UnrealConnection call to the least loaded instance."""
+        if name.startswith("_") or not callable(getattr(UnrealConnection, name, None)):
+            raise AttributeError(name)
+        return lambda *args, **kwargs: self._call(self._pick(), name, *args, **kwargs)
+
+class UnrealWebSocketConnection:
+    """
+    Persistent WebSocket connection to the Unreal Engine plugin.
+    
+    Requests carry an id, so many can be in flight at once over the same connection.
+    The plugin listens on the port after its HTTP port.
+    """
+    
+    def __init__(self, host: str = "localhost", port: int = 8501, request_timeout: Optional[float] = 600.0):
+        """
+        Initialize an Unreal Engine WebSocket connection.
+        
+        Args:
+            host: Host where Unreal Engine is running
+            port: Port where the Unreal plugin WebSocket transport is listening
+            request_timeout: Seconds request() waits for a reply, None to wait as long as the connection lives
+        """
+        self.url = f"ws://{host}:{port}"
+        self.request_timeout = request_timeout
+        self._session: Optional[aiohttp.ClientSession] = None
+        self._socket: Optional[aiohttp.ClientWebSocketResponse] = None
+        self._pending: Dict[str, asyncio.Future] = {}
+        self._ids = itertools.count(1)
+        self._reader: Optional[asyncio.Task] = None
+    
+    async def connect(self) -> bool:
+        """
+        Open the WebSocket connection.
+        
+        Returns:
+            bool: True if connection successful, False otherwise
+        """
+        try:
+            self._session = aiohttp.ClientSession()
+            self._socket = await self._session.ws_connect(self.url)
+            self._reader = asyncio.create_task(self._read_loop())
+            logger.info(f"Connected to Unreal Engine WebSocket at {self.url}")
+            return True
+        except Exception as e:
+            logger.error(f"Error connecting to Unreal Engine WebSocket: {str(e)}")
+            await self.close()
+            return False
+    
+    async def close(self) -> None:
+        """Close the WebSocket connection, failing every request still in flight."""
+        if self._reader:
+            self._reader.cancel()
+            self._reader = None
+        if self._socket:
+            await self._socket.close()
+            self._socket = None
+        if self._session:
+            await self._session.close()
+            self._session = None
+        for future in self._pending.values():
+            if not future.done():
+                future.set_exception(ConnectionError("Unreal Engine WebSocket closed"))
+        self._pending.clear()
+    
+    async def request(self, request_type: str, **fields: Any) -> Dict[str, Any]:
+        """
+        Send a request and wait for its reply.
+        
+        Args:
+            request_type: Endpoint to call (execute, execute_batch, status, job, job_output, register_script, invoke)
+            **fields: Request body fields, for example code="print(1)" or async=True
+            
+        Returns:
+            Dict with the response of the endpoint, or an error when the connection dropped or no
+            reply came within request_timeout
+        """
+        if self._socket is None or self._socket.closed:
+            return {"status": "error", "message": "Not connected to Unreal Engine"}
+        
+        request_id = str(next(self._ids))
+        future = asyncio.get_running_loop().create_future()
+        self._pending[request_id] = future
+        
+        try:
+            await self._socket.send_str(json.dumps({"id": request_id, "type": request_type, **fields}))
+            return await asyncio.wait_for(future, self.request_timeout)
+        except asyncio.TimeoutError:
+            return {"status": "error", "message": f"Unreal Engine did not answer within {self.request_timeout} s"}
+        except (ConnectionError, aiohttp.ClientError) as e:
+            return {"status": "error", "message": str(e) or "Unreal Engine WebSocket closed"}
+        finally:
+            self._pending.pop(request_id, None)
+    
+    async def execute_code(self, code: str) -> Dict[str, Any]:
+        """Execute Python code in Unreal Engine over the WebSocket connection."""
+        return await self.request("execute", code=code)
+    
+    async def _read_loop(self) -> None:
+        """Resolve pending requests as their replies arrive, in any order."""
+        socket = self._socket
+        try:
+            async for message in socket:
+                if message.type != aiohttp.WSMsgType.TEXT:
+                    continue
+                try:
+                    reply = json.loads(message.data)
+                    request_id = reply.get("id", "")
+                except (ValueError, AttributeError, TypeError):
+                    logger.warning("Skipped a malformed Unreal Engine WebSocket frame")
+                    continue
+                future = self._pending.pop(request_id, None)
+                if future and not future.done():
+                    future.set_result(reply.get("response"))
+        finally:
+            # The server went away, for example on an editor restart, so nothing pending will be answered.
+            # A reader that outlived its socket, after close() and a new connect(), leaves the new one alone
+            if self._socket is socket:
+                self._socket = None
+                self._reader = None
+                for future in self._pending.values():
+                    if not future.done():
+                        future.set_exception(ConnectionError("Unreal Engine WebSocket closed"))
+                self._pending.clear()
+                
+                # The session only served this socket, connect() opens a new one
+                session, self._session = self._session, None
+                if session:
+                    await session.close()
+
 # Create a global instance for convenience
 unreal_connection = UnrealConnection() 
\ No newline at end of file
@@ -0,0 +1,123 @@
+#!/usr/bin/env python
+"""
+Script to benchmark the UEPythonServer plugin endpoints.
+"""
+
+import os
+import sys
+import json
+import asyncio
+import argparse
+from typing import Any, Dict
+
+# Add the project root directory to the Python path
+sys.path.insert(0, os.path.abspath(os.path.join(os.path.dirname(__file__), '..')))
+
+from tests.utils.plugin_benchmark import SCRIPTS, BenchmarkConfig, PluginBenchmark
+
+def parse_mix(value: str) -> Dict[str, float]:
+    """
+    Parse a script mix such as "noop:8,spawn:1,stdout:1".
+
+    Args:
+        value: Comma-separated script names, each with an optional weight.
+
+    Returns:
+        Dict[str, float]: The weight of each script.
+    """
+    mix = {}
+    for item in value.split(','):
+        name, _, weight = item.strip().partition(':')
+        if name not in SCRIPTS:
+            raise argparse.ArgumentTypeError(f"Unknown script '{name}', expected one of {', '.join(SCRIPTS)}")
+        mix[name] = float(weight) if weight else 1.0
+    return mix
+
+def print_report(summary: Dict[str, Any]):
+    """Print a benchmark summary as a table."""
+    print(f"Requests:   {summary['requests']} ({summary['errors']} errors)")
+    print(f"Throughput: {summary['throughput_rps']:.1f} req/s")
+    print(f"Latency:    p50 {summary['p50_ms']:.2f} ms, p99 {summary['p99_ms']:.2f} ms, max {summary['max_ms']:.2f} ms")
+    print()
+
+    print(f"{'script':<12}{'requests':>10}{'errors':>8}{'p50 ms':>10}{'p99 ms':>10}{'max ms':>10}")
+    for name, stats in summary['scripts'].items():
+        print(f"{name:<12}{stats['requests']:>10}{stats['errors']:>8}{stats['p50_ms']:>10.2f}{stats['p99_ms']:>10.2f}{stats['max_ms']:>10.2f}")
+    print()
+
+    idle = summary['frame_idle']
+    load = summary['frame_load']
+    if idle['frames'] or load['frames']:
+        print(f"Editor frames idle: p50 {idle['p50_ms']:.2f} ms, p99 {idle['p99_ms']:.2f} ms ({idle['frames']} frames)")
+        print(f"Editor frames load: p50 {load['p50_ms']:.2f} ms, p99 {load['p99_ms']:.2f} ms ({load['frames']} frames)")
+    else:
+        print("Editor frames: not reported, the plugin has no /metrics endpoint")
+
+    if summary['server_stages']:
+        print()
+        print(f"{'server stage':<16}{'samples':>10}{'p50 ms':>10}{'p99 ms':>10}")
+        for stage, stats in summary['server_stages'].items():
+            print(f"{stage:<16}{stats['samples']:>10}{stats['p50_ms']:>10.3f}{stats['p99_ms']:>10.3f}")
+
+def main():
+    """Main entry point."""
+    parser = argparse.ArgumentParser(description='Benchmark the UEPythonServer plugin endpoints')
+    parser.add_argument('--url', default='http://localhost:8500', help='Base URL of the plugin')
+    parser.add_argument('--endpoint', choices=['execute', 'status'], default='execute', help='Endpoint to load')
+    parser.add_argument('-c', '--concurrency', type=int, default=4, help='Number of concurrent clients')
+    parser.add_argument('-d', '--duration', type=float, default=10.0, help='Seconds to apply load for')
+    parser.add_argument('-n', '--requests', type=int, help='Total number of requests, instead of a duration')
+    parser.add_argument('--mix', type=parse_mix, default={'noop': 1.0},
+                        help=f"Weighted scripts to send, e.g. noop:8,spawn:1,stdout:1 (scripts: {', '.join(SCRIPTS)})")
+    parser.add_argument('--payload-bytes', type=int, default=0, help='Pad each script to this many bytes')
+    parser.add_argument('--stdout-bytes', type=int, default=1024 * 1024, help='Bytes printed by the stdout script')
+    parser.add_argument('--warmup', type=int, default=10, help='Requests sent before measuring')
+    parser.add_argument('--idle-seconds', type=float, default=3.0, help='Seconds of idle frame times to measure first')
+    parser.add_argument('--json', help='Also write the summary to this file')
+    parser.add_argument('--max-p99-ms', type=float, help='Exit with an error if the p99 latency is above this')
+    parser.add_argument('--max-frame-p99-ms', type=float, help='Exit with an error if the p99 frame time under load is above this')
+
+    args = parser.parse_args()
+
+    config = BenchmarkConfig(
+        base_url=args.url,
+        endpoint=args.endpoint,
+        concurrency=args.concurrency,
+        duration=args.duration,
+        requests=args.requests,
+        mix=args.mix,
+        payload_bytes=args.payload_bytes,
+        stdout_bytes=args.stdout_bytes,
+        warmup=args.warmup,
+        idle_seconds=args.idle_seconds,
+    )
+
+    # Print header
+    print('=' * 80)
+    print('UEPythonServer Benchmark')
+    print('=' * 80)
+
+    async def run():
+        async with PluginBenchmark(config) as benchmark:
+            return await benchmark.run()
+
+    summary = asyncio.run(run()).summary()
+    print_report(summary)
+
+    if args.json:
+        with open(args.json, 'w') as f:
+            json.dump(summary, f, indent=2)
+
+    # Fail the run on a regression past the given thresholds
+    failed = summary['errors'] > 0
+    if args.max_p99_ms is not None and summary['p99_ms'] > args.max_p99_ms:
+        print(f"FAIL: p99 latency {summary['p99_ms']:.2f} ms is above {args.max_p99_ms:.2f} ms")
+        failed = True
+    if args.max_frame_p99_ms is not None and summary['frame_load']['p99_ms'] > args.max_frame_p99_ms:
+        print(f"FAIL: p99 frame time {summary['frame_load']['p99_ms']:.2f} ms is above {args.max_frame_p99_ms:.2f} ms")
+        failed = True
+
+    sys.exit(1 if failed else 0)
+
+if __name__ == '__main__':
+    main()
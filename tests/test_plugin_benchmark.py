@@ -0,0 +1,139 @@
+"""
+Tests for the plugin benchmark report.
+
+This module contains tests for the percentile and /metrics histogram helpers of
+tests/utils/plugin_benchmark.py, fed with text laid out like the plugin's
+WritePrometheusHistogram output, without a running editor.
+"""
+
+import unittest
+
+from tests.utils.plugin_benchmark import percentile, parse_histograms, histogram_delta_quantile
+
+# FLatencyHistogram::BucketBounds, the +Inf bucket follows the last one
+BUCKET_BOUNDS = [
+    0.00005, 0.0001, 0.00025, 0.0005,
+    0.001, 0.0025, 0.005, 0.01,
+    0.025, 0.05, 0.1, 0.25,
+    0.5, 1.0, 2.5, 5.0,
+    10.0,
+]
+
+def histogram_text(name, labels, counts):
+    """
+    Write a histogram as WritePrometheusHistogram does.
+    
+    Args:
+        name: Metric name
+        labels: Label set without braces, may be empty
+        counts: Samples per bucket bound, the key "+Inf" for samples past the last bound
+    """
+    separator = "," if labels else ""
+    lines = []
+    cumulative = 0
+    for bound in BUCKET_BOUNDS:
+        cumulative += counts.get(bound, 0)
+        lines.append(f'{name}_bucket{{{labels}{separator}le="{bound:g}"}} {cumulative}')
+    cumulative += counts.get("+Inf", 0)
+    lines.append(f'{name}_bucket{{{labels}{separator}le="+Inf"}} {cumulative}')
+    label_set = f"{{{labels}}}" if labels else ""
+    lines.append(f"{name}_sum{label_set} 0.123456789")
+    lines.append(f"{name}_count{label_set} {cumulative}")
+    return "\n".join(lines) + "\n"
+
+def metrics_text(execute_counts, frame_counts):
+    """Write a /metrics scrape with the execute and queue_wait stages and the frame histogram."""
+    return (
+        "# HELP uepython_execute_requests_total Requests received by /execute\n"
+        "# TYPE uepython_execute_requests_total counter\n"
+        "uepython_execute_requests_total 42\n"
+        "# HELP uepython_stage_seconds Time spent in each stage of the /execute request path\n"
+        "# TYPE uepython_stage_seconds histogram\n"
+        + histogram_text("uepython_stage_seconds", 'stage="queue_wait"', {0.00005: 5})
+        + histogram_text("uepython_stage_seconds", 'stage="execute"', execute_counts)
+        + "# HELP uepython_frame_seconds Duration of the editor frames while the server is running\n"
+        "# TYPE uepython_frame_seconds histogram\n"
+        + histogram_text("uepython_frame_seconds", "", frame_counts)
+    )
+
+class TestPercentile(unittest.TestCase):
+    """Test the client-side latency percentiles."""
+    
+    def test_interpolates_between_samples(self):
+        """Test p50 and p99 of unordered samples."""
+        samples = [float(value) for value in range(100, 0, -1)]
+        
+        self.assertAlmostEqual(percentile(samples, 0.5), 50.5)
+        self.assertAlmostEqual(percentile(samples, 0.99), 99.01)
+        self.assertEqual(percentile(samples, 1.0), 100.0)
+        self.assertEqual(percentile([4.0, 1.0, 3.0, 2.0], 0.5), 2.5)
+    
+    def test_few_samples(self):
+        """Test that no samples give 0 and a single sample gives itself."""
+        self.assertEqual(percentile([], 0.99), 0.0)
+        self.assertEqual(percentile([0.25], 0.99), 0.25)
+
+class TestHistograms(unittest.TestCase):
+    """Test reading latency quantiles from two /metrics scrapes."""
+    
+    def setUp(self):
+        """Set up a scrape before and after a window of 100 execute samples."""
+        self.before = parse_histograms(metrics_text({0.001: 10}, {0.01: 3}))
+        self.after = parse_histograms(metrics_text({0.001: 20, 0.0025: 80, 0.005: 8, "+Inf": 2}, {0.01: 3, 0.025: 1}))
+    
+    def test_parse_histograms(self):
+        """Test the keys and cumulative buckets, with bounds written by %g and the +Inf bucket."""
+        self.assertEqual(set(self.after), {
+            ("uepython_stage_seconds", "queue_wait"),
+            ("uepython_stage_seconds", "execute"),
+            ("uepython_frame_seconds", ""),
+        })
+        
+        buckets = self.after[("uepython_stage_seconds", "execute")]
+        self.assertEqual([bound for bound, _ in buckets], BUCKET_BOUNDS + [float("inf")])
+        self.assertEqual(buckets[0], (0.00005, 0))
+        self.assertEqual(buckets[4], (0.001, 20))
+        self.assertEqual(buckets[6], (0.005, 108))
+        self.assertEqual(buckets[-2], (10.0, 108))
+        self.assertEqual(buckets[-1], (float("inf"), 110))
+    
+    def test_delta_quantiles(self):
+        """Test p50 and p98 of only the samples recorded between the scrapes."""
+        key = ("uepython_stage_seconds", "execute")
+        
+        count, p50 = histogram_delta_quantile(self.before[key], self.after[key], 0.5)
+        self.assertEqual(count, 100)
+        # Rank 50 is the 40th of the 80 samples in the 1 ms to 2.5 ms bucket
+        self.assertAlmostEqual(p50, 0.00175)
+        
+        _, p98 = histogram_delta_quantile(self.before[key], self.after[key], 0.98)
+        self.assertAlmostEqual(p98, 0.005)
+    
+    def test_delta_quantile_in_inf_bucket(self):
+        """Test that a quantile past the last bound is reported at the last bound, as /status does."""
+        key = ("uepython_stage_seconds", "execute")
+        
+        _, p99 = histogram_delta_quantile(self.before[key], self.after[key], 0.99)
+        self.assertEqual(p99, 10.0)
+    
+    def test_delta_without_first_scrape(self):
+        """Test that an empty first scrape gives the quantiles of the whole histogram."""
+        key = ("uepython_frame_seconds", "")
+        
+        count, p50 = histogram_delta_quantile([], self.after[key], 0.5)
+        self.assertEqual(count, 4)
+        self.assertAlmostEqual(p50, 0.005 + (0.01 - 0.005) * 2 / 3)
+        
+        count, p99 = histogram_delta_quantile(self.before[key], self.after[key], 0.99)
+        self.assertEqual(count, 1)
+        self.assertAlmostEqual(p99, 0.01 + (0.025 - 0.01) * 0.99)
+    
+    def test_empty_window(self):
+        """Test that two identical scrapes give no samples."""
+        key = ("uepython_stage_seconds", "queue_wait")
+        
+        self.assertEqual(histogram_delta_quantile(self.before[key], self.after[key], 0.99), (0, 0.0))
+        self.assertEqual(histogram_delta_quantile([], [], 0.5), (0, 0.0))
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,218 @@
+"""
+Tests for the Unreal plugin wire formats.
+
+This module contains tests for the helpers of unreal_connection that encode and decode
+the binary bodies exchanged with the UEPythonServer plugin, and for the routing of
+UnrealFleet, without a running editor.
+"""
+
+import json
+import os
+import shutil
+import struct
+import tempfile
+import time
+import unittest
+from types import SimpleNamespace
+from unittest.mock import patch, MagicMock
+
+from src.unreal_blender_mcp.unreal_connection import UnrealFleet, pack_mesh_stream, _split_multipart, _resolve_attachments
+
+class TestPackMeshStream(unittest.TestCase):
+    """Test the /meshes binary layout written by pack_mesh_stream."""
+    
+    def test_header_and_buffers(self):
+        """Test a triangle with positions, indices and colors."""
+        positions = [(0.0, 0.0, 0.0), (1.0, 0.0, 0.0), (0.0, 1.0, 0.0)]
+        colors = [(255, 0, 0, 255), (0, 255, 0, 255), (0, 0, 255, 255)]
+        
+        data = pack_mesh_stream(3, section=2, positions=positions, indices=[0, 1, 2], colors=colors)
+        
+        # Magic, then version, section, vertex count and buffer count
+        self.assertEqual(data[:4], b"UEMS")
+        self.assertEqual(struct.unpack_from("<HHII", data, 4), (1, 2, 3, 3))
+        
+        offset = 16
+        buffers = []
+        while offset < len(data):
+            buffer_type, length = struct.unpack_from("<II", data, offset)
+            offset += 8
+            buffers.append((buffer_type, data[offset:offset + length]))
+            offset += length + (-length % 4)
+        self.assertEqual(offset, len(data))
+        
+        self.assertEqual([(buffer_type, len(body)) for buffer_type, body in buffers], [(1, 36), (2, 12), (5, 12)])
+        self.assertEqual(struct.unpack("<9f", buffers[0][1]), (0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0, 0.0))
+        self.assertEqual(struct.unpack("<3I", buffers[1][1]), (0, 1, 2))
+        self.assertEqual(buffers[2][1], bytes([255, 0, 0, 255, 0, 255, 0, 255, 0, 0, 255, 255]))
+    
+    def test_padding_and_skipped_buffers(self):
+        """Test that buffers are padded to 4 bytes and that None buffers are left out."""
+        data = pack_mesh_stream(1, positions=[0.5, 0.5, 0.5], normals=None, colors=b"\x01\x02\x03\x04\x05\x06")
+        
+        self.assertEqual(struct.unpack_from("<HHII", data, 4), (1, 0, 1, 2))
+        self.assertEqual(struct.unpack_from("<II", data, 16), (1, 12))
+        self.assertEqual(struct.unpack_from("<II", data, 36), (5, 6))
+        
+        # The length field holds the unpadded size, the padding is zeros up to the next multiple of 4
+        self.assertEqual(data[44:50], b"\x01\x02\x03\x04\x05\x06")
+        self.assertEqual(data[50:], b"\0\0")
+        self.assertEqual(len(data) % 4, 0)
+
+class TestMultipartAttachments(unittest.TestCase):
+    """Test decoding the multipart/mixed replies of /execute with binary attachments."""
+    
+    def make_response(self, result, attachments, content_type="multipart/mixed; boundary={}"):
+        """Build a reply laid out like the plugin's MakeMultipartResponse."""
+        boundary = "uepython-0123456789abcdef"
+        body = f"--{boundary}\r\nContent-Type: application/json\r\n\r\n".encode("ascii") + json.dumps(result).encode("utf-8")
+        for index, attachment in enumerate(attachments):
+            body += f"\r\n--{boundary}\r\nContent-Type: application/octet-stream\r\nContent-ID: <{index}>\r\n\r\n".encode("ascii")
+            body += attachment
+        body += f"\r\n--{boundary}--\r\n".encode("ascii")
+        return SimpleNamespace(headers={"Content-Type": content_type.format(boundary)}, content=body)
+    
+    def test_split_multipart(self):
+        """Test that the parts come back in order with their exact bytes."""
+        # Attachments may hold CRLFs and dashes, and may be empty
+        attachments = [b"\x00\x01\x02\xff", b"line\r\n--not a boundary\r\n\r\n", b""]
+        response = self.make_response({"status": "success", "value": None}, attachments)
+        
+        parts = _split_multipart(response)
+        
+        self.assertEqual(len(parts), 4)
+        self.assertEqual(json.loads(parts[0]), {"status": "success", "value": None})
+        self.assertEqual(parts[1:], attachments)
+    
+    def test_split_multipart_quoted_boundary(self):
+        """Test a boundary given as a quoted string followed by another parameter."""
+        response = self.make_response({"value": 1}, [b"abc"], content_type='multipart/mixed; boundary="{}"; charset=utf-8')
+        
+        self.assertEqual(_split_multipart(response)[1:], [b"abc"])
+    
+    def test_resolve_attachments(self):
+        """Test that attachment references are replaced at any depth and other values are kept."""
+        attachments = [b"first", b"second"]
+        value = {
+            "image": {"__attachment__": 1},
+            "frames": [{"__attachment__": 0}, {"__attachment__": "1"}, 3],
+            "meta": {"name": "capture", "size": [2, 2]},
+        }
+        
+        self.assertEqual(_resolve_attachments(value, attachments), {
+            "image": b"second",
+            "frames": [b"first", b"second", 3],
+            "meta": {"name": "capture", "size": [2, 2]},
+        })
+        self.assertEqual(_resolve_attachments("plain", attachments), "plain")
+        self.assertIsNone(_resolve_attachments(None, attachments))
+    
+    def test_split_then_resolve(self):
+        """Test the decoding done by execute_code on a multipart reply."""
+        response = self.make_response({"status": "success", "value": {"png": {"__attachment__": 0}}}, [b"\x89PNG\r\n"])
+        
+        parts = _split_multipart(response)
+        result = json.loads(parts[0])
+        
+        self.assertEqual(_resolve_attachments(result["value"], parts[1:]), {"png": b"\x89PNG\r\n"})
+
+class TestUnrealFleetRouting(unittest.TestCase):
+    """Test how UnrealFleet spreads calls across instances and routes owned ids back."""
+    
+    def setUp(self):
+        """Set up a discovery directory with three instances and a fake status port for each."""
+        self.discovery_dir = tempfile.mkdtemp()
+        for port in (8500, 8510, 8520):
+            self.write_instance(port)
+        
+        # Status replies by status port, an exception stands for an instance that does not answer
+        self.status = {
+            8502: ({"pending_jobs": 3}, {}),
+            8512: ({"pending_jobs": 1}, {}),
+            8522: ({"pending_jobs": 2}, {}),
+        }
+        self.get_patcher = patch('src.unreal_blender_mcp.unreal_connection.requests.get', side_effect=self.fake_status)
+        self.get_patcher.start()
+        
+        self.fleet = UnrealFleet(discovery_dir=self.discovery_dir, load_cache_seconds=0.0)
+        self.fleet.connect()
+        for key in list(self.fleet._connections):
+            self.fleet._connections[key] = MagicMock()
+    
+    def tearDown(self):
+        """Tear down test fixtures."""
+        self.get_patcher.stop()
+        shutil.rmtree(self.discovery_dir)
+    
+    def write_instance(self, port, updated_at=None):
+        """Write a discovery file like the plugin's beacon does."""
+        instance = {"port": port, "status_port": port + 2, "updated_at": time.time() if updated_at is None else updated_at}
+        with open(os.path.join(self.discovery_dir, f"{port}.json"), "w", encoding="utf-8") as file:
+            json.dump(instance, file)
+    
+    def fake_status(self, url, timeout=None):
+        """Answer GET /status from the status table."""
+        port = int(url.split(":")[2].split("/")[0])
+        reply = self.status[port]
+        if isinstance(reply, Exception):
+            raise reply
+        body, headers = reply
+        return SimpleNamespace(status_code=200, json=lambda: body, headers=headers)
+    
+    def test_pick_least_loaded(self):
+        """Test that the instance with the fewest pending jobs is picked."""
+        self.assertEqual(self.fleet._pick(), "localhost:8510")
+    
+    def test_pick_counts_busy_game_thread(self):
+        """Test that a stale status snapshot counts as one more job."""
+        self.status[8512] = ({"pending_jobs": 1}, {"X-Snapshot-Age-Ms": "1000"})
+        self.status[8522] = ({"pending_jobs": 1}, {"X-Snapshot-Age-Ms": "10"})
+        
+        self.assertEqual(self.fleet._pick(), "localhost:8520")
+    
+    def test_pick_counts_in_flight_calls(self):
+        """Test that calls this router has in flight add to an instance's load."""
+        self.fleet._in_flight["localhost:8510"] = 2
+        
+        self.assertEqual(self.fleet._pick(), "localhost:8520")
+    
+    def test_pick_skips_unreachable_and_stale_instances(self):
+        """Test that instances that do not answer or stopped updating their discovery file are left out."""
+        self.status[8512] = ConnectionError("refused")
+        self.write_instance(8520, updated_at=time.time() - 3600)
+        self.fleet.discover()
+        
+        self.assertEqual(self.fleet._pick(), "localhost:8500")
+        
+        self.status[8502] = ConnectionError("refused")
+        self.assertIsNone(self.fleet._pick())
+        self.assertEqual(self.fleet.get_job("job")["status"], "error")
+    
+    def test_owned_ids_go_back_to_their_instance(self):
+        """Test that jobs and sessions are routed to the instance that created them."""
+        self.fleet._connections["localhost:8510"].submit_code.return_value = {"status": "success", "job_id": "job-1"}
+        self.fleet._connections["localhost:8510"].create_session.return_value = {"status": "success", "session_id": "session-1"}
+        self.assertEqual(self.fleet.submit_code("pass")["instance"], "localhost:8510")
+        self.assertEqual(self.fleet.create_session()["instance"], "localhost:8510")
+        
+        # Another instance is now the least loaded, owned ids stay where they are
+        self.status[8512] = ({"pending_jobs": 9}, {})
+        self.assertEqual(self.fleet._owner("job-1"), "localhost:8510")
+        self.assertEqual(self.fleet._owner("session-1"), "localhost:8510")
+        self.fleet.get_job("job-1")
+        self.fleet._connections["localhost:8510"].get_job.assert_called_once_with("job-1")
+        self.fleet.execute_code("x = 1", session_id="session-1")
+        self.fleet._connections["localhost:8510"].execute_code.assert_called_once_with("x = 1", session_id="session-1")
+    
+    def test_unknown_ids_go_to_least_loaded(self):
+        """Test that ids no instance returned, and calls without one, go to the least loaded instance."""
+        self.assertEqual(self.fleet._owner("job-from-elsewhere"), "localhost:8510")
+        self.assertEqual(self.fleet._owner(None), "localhost:8510")
+        
+        # Failed calls return no id, so nothing is remembered for them
+        self.fleet._connections["localhost:8510"].submit_code.return_value = {"status": "error", "message": "busy"}
+        self.fleet.submit_code("pass")
+        self.assertEqual(self.fleet._owners, {})
+
+if __name__ == "__main__":
+    unittest.main()
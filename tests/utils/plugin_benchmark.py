@@ -0,0 +1,340 @@
+"""
+Load and latency benchmark for the UEPythonServer plugin.
+
+This module drives the plugin's HTTP endpoints with a configurable number of
+concurrent clients and a weighted mix of scripts, and reports client-side
+latency percentiles, throughput, and the editor frame times measured by the
+plugin while the load was applied.
+"""
+
+import asyncio
+import random
+import re
+import time
+from dataclasses import dataclass, field
+from typing import Any, Dict, List, Optional, Tuple
+
+import aiohttp
+
+
+# Scripts the benchmark can send, keyed by the name used in the mix.
+# Each one spawns or prints in a way that leaves the level as it found it.
+SCRIPTS: Dict[str, str] = {
+    "noop": "pass\n",
+    "spawn": (
+        "import unreal\n"
+        "actor = unreal.EditorLevelLibrary.spawn_actor_from_class(unreal.StaticMeshActor, unreal.Vector(0, 0, 0))\n"
+        "unreal.EditorLevelLibrary.destroy_actor(actor)\n"
+    ),
+    "stdout": "print('x' * {stdout_bytes})\n",
+}
+
+_BUCKET_RE = re.compile(r'^(\w+)_bucket\{(.*?)le="([^"]+)"\}\s+(\d+)')
+_STAGE_RE = re.compile(r'stage="([^"]+)"')
+
+
+def percentile(samples: List[float], fraction: float) -> float:
+    """
+    Get a percentile of a list of samples, with linear interpolation.
+
+    Args:
+        samples: The samples, in any order
+        fraction: The percentile as a fraction, e.g. 0.99
+
+    Returns:
+        The percentile, or 0 when there are no samples
+    """
+    if not samples:
+        return 0.0
+    ordered = sorted(samples)
+    rank = fraction * (len(ordered) - 1)
+    lower = int(rank)
+    upper = min(lower + 1, len(ordered) - 1)
+    return ordered[lower] + (ordered[upper] - ordered[lower]) * (rank - lower)
+
+
+def parse_histograms(text: str) -> Dict[Tuple[str, str], List[Tuple[float, int]]]:
+    """
+    Parse the histogram buckets of a /metrics scrape.
+
+    Args:
+        text: Prometheus text exposition from /metrics
+
+    Returns:
+        Cumulative (upper bound, count) buckets keyed by (metric name, stage),
+        with an empty stage for histograms that have no stage label
+    """
+    histograms: Dict[Tuple[str, str], List[Tuple[float, int]]] = {}
+    for line in text.splitlines():
+        match = _BUCKET_RE.match(line)
+        if not match:
+            continue
+        name, labels, bound, count = match.groups()
+        stage = _STAGE_RE.search(labels)
+        key = (name, stage.group(1) if stage else "")
+        histograms.setdefault(key, []).append((float(bound), int(count)))
+    return histograms
+
+
+def histogram_delta_quantile(before: List[Tuple[float, int]], after: List[Tuple[float, int]],
+                             fraction: float) -> Tuple[int, float]:
+    """
+    Estimate a quantile of the samples recorded between two scrapes of a histogram.
+
+    Args:
+        before: Cumulative buckets of the first scrape
+        after: Cumulative buckets of the second scrape
+        fraction: The quantile as a fraction
+
+    Returns:
+        The number of samples in the window and the quantile in seconds,
+        interpolated within its bucket as the plugin does for /status
+    """
+    previous = dict(before)
+    deltas = [(bound, count - previous.get(bound, 0)) for bound, count in after]
+    total = deltas[-1][1] if deltas else 0
+    if total <= 0:
+        return 0, 0.0
+
+    rank = fraction * total
+    lower_bound = 0.0
+    below = 0
+    last_finite = max((bound for bound, _ in deltas if bound != float("inf")), default=0.0)
+    for bound, cumulative in deltas:
+        if cumulative >= rank and cumulative > below:
+            if bound == float("inf"):
+                return total, last_finite
+            position = (rank - below) / (cumulative - below)
+            return total, lower_bound + (bound - lower_bound) * min(max(position, 0.0), 1.0)
+        lower_bound = bound
+        below = cumulative
+    return total, last_finite
+
+
+@dataclass
+class BenchmarkConfig:
+    """Settings of one benchmark run."""
+
+    base_url: str = "http://localhost:8500"
+    endpoint: str = "execute"
+    concurrency: int = 4
+    duration: float = 10.0
+    requests: Optional[int] = None
+    mix: Dict[str, float] = field(default_factory=lambda: {"noop": 1.0})
+    payload_bytes: int = 0
+    stdout_bytes: int = 1024 * 1024
+    warmup: int = 10
+    idle_seconds: float = 3.0
+    timeout: float = 60.0
+
+
+@dataclass
+class BenchmarkResult:
+    """Latencies and errors collected during a run, in seconds."""
+
+    latencies: Dict[str, List[float]] = field(default_factory=dict)
+    errors: Dict[str, int] = field(default_factory=dict)
+    wall_seconds: float = 0.0
+    idle_frames: Tuple[int, float, float] = (0, 0.0, 0.0)
+    load_frames: Tuple[int, float, float] = (0, 0.0, 0.0)
+    server_stages: Dict[str, Tuple[int, float, float]] = field(default_factory=dict)
+
+    def summary(self) -> Dict[str, Any]:
+        """
+        Summarize the run.
+
+        Returns:
+            Latency percentiles in milliseconds, throughput and frame times, overall and per script
+        """
+        all_latencies = [latency for samples in self.latencies.values() for latency in samples]
+        num_requests = len(all_latencies) + sum(self.errors.values())
+
+        def describe(samples: List[float], num_errors: int) -> Dict[str, Any]:
+            return {
+                "requests": len(samples) + num_errors,
+                "errors": num_errors,
+                "p50_ms": percentile(samples, 0.5) * 1000.0,
+                "p99_ms": percentile(samples, 0.99) * 1000.0,
+                "max_ms": max(samples) * 1000.0 if samples else 0.0,
+            }
+
+        def describe_frames(frames: Tuple[int, float, float]) -> Dict[str, Any]:
+            return {"frames": frames[0], "p50_ms": frames[1] * 1000.0, "p99_ms": frames[2] * 1000.0}
+
+        summary = describe(all_latencies, sum(self.errors.values()))
+        summary["throughput_rps"] = num_requests / self.wall_seconds if self.wall_seconds > 0 else 0.0
+        summary["scripts"] = {
+            name: describe(self.latencies.get(name, []), self.errors.get(name, 0))
+            for name in sorted(set(self.latencies) | set(self.errors))
+        }
+        summary["frame_idle"] = describe_frames(self.idle_frames)
+        summary["frame_load"] = describe_frames(self.load_frames)
+        summary["server_stages"] = {
+            stage: {"samples": count, "p50_ms": p50 * 1000.0, "p99_ms": p99 * 1000.0}
+            for stage, (count, p50, p99) in self.server_stages.items()
+        }
+        return summary
+
+
+class PluginBenchmark:
+    """
+    Apply load to the UEPythonServer plugin and measure it.
+
+    Concurrent workers send requests back-to-back for the configured duration
+    or number of requests. Editor frame times and server-side stage latencies
+    come from diffing /metrics scrapes taken around an idle window and around
+    the load.
+    """
+
+    def __init__(self, config: BenchmarkConfig):
+        """
+        Initialize the benchmark.
+
+        Args:
+            config: Settings of the run
+        """
+        self.config = config
+        self.session: Optional[aiohttp.ClientSession] = None
+        self._rng = random.Random(0)
+
+    async def __aenter__(self):
+        """Enter the async context manager."""
+        connector = aiohttp.TCPConnector(limit=max(self.config.concurrency, 1) + 1)
+        self.session = aiohttp.ClientSession(
+            connector=connector,
+            timeout=aiohttp.ClientTimeout(total=self.config.timeout),
+        )
+        return self
+
+    async def __aexit__(self, exc_type, exc_val, exc_tb):
+        """Exit the async context manager."""
+        if self.session:
+            await self.session.close()
+
+    def make_code(self, script: str) -> str:
+        """
+        Build the code for one request.
+
+        Args:
+            script: Name of a script in SCRIPTS
+
+        Returns:
+            The script, padded with a trailing comment up to the configured payload size
+        """
+        code = SCRIPTS[script].format(stdout_bytes=self.config.stdout_bytes)
+        padding = self.config.payload_bytes - len(code)
+        if padding > 2:
+            code += "#" + "p" * (padding - 2) + "\n"
+        return code
+
+    def pick_script(self) -> str:
+        """Pick the script of the next request, weighted by the mix."""
+        names = list(self.config.mix)
+        weights = [self.config.mix[name] for name in names]
+        return self._rng.choices(names, weights=weights)[0]
+
+    async def send(self, script: str) -> bool:
+        """
+        Send one request.
+
+        Args:
+            script: Name of a script in SCRIPTS, ignored for the status endpoint
+
+        Returns:
+            Whether the plugin reported success
+        """
+        if self.config.endpoint == "status":
+            async with self.session.get(f"{self.config.base_url}/status") as response:
+                await response.read()
+                return response.status == 200
+
+        headers = {"X-Request-Id": f"bench-{script}"}
+        async with self.session.post(
+            f"{self.config.base_url}/execute",
+            json={"code": self.make_code(script)},
+            headers=headers,
+        ) as response:
+            body = await response.json(content_type=None)
+            return response.status == 200 and body.get("status") == "success"
+
+    async def scrape(self) -> Dict[Tuple[str, str], List[Tuple[float, int]]]:
+        """Scrape the plugin's histograms, empty if /metrics is not available."""
+        try:
+            async with self.session.get(f"{self.config.base_url}/metrics") as response:
+                if response.status != 200:
+                    return {}
+                return parse_histograms(await response.text())
+        except aiohttp.ClientError:
+            return {}
+
+    async def _worker(self, result: BenchmarkResult, deadline: float, budget: List[int]) -> None:
+        """Send requests until the deadline or the shared request budget runs out."""
+        while time.perf_counter() < deadline:
+            if budget:
+                if budget[0] <= 0:
+                    return
+                budget[0] -= 1
+
+            script = self.pick_script() if self.config.endpoint == "execute" else "status"
+            start = time.perf_counter()
+            try:
+                success = await self.send(script)
+            except (aiohttp.ClientError, asyncio.TimeoutError):
+                success = False
+            elapsed = time.perf_counter() - start
+
+            if success:
+                result.latencies.setdefault(script, []).append(elapsed)
+            else:
+                result.errors[script] = result.errors.get(script, 0) + 1
+
+    @staticmethod
+    def _window(before, after, key) -> Tuple[int, float, float]:
+        """Get the sample count, p50 and p99 of a histogram between two scrapes."""
+        if key not in before or key not in after:
+            return (0, 0.0, 0.0)
+        count, p50 = histogram_delta_quantile(before[key], after[key], 0.5)
+        _, p99 = histogram_delta_quantile(before[key], after[key], 0.99)
+        return (count, p50, p99)
+
+    async def run(self) -> BenchmarkResult:
+        """
+        Run the benchmark.
+
+        Returns:
+            The collected latencies, errors and frame times
+        """
+        result = BenchmarkResult()
+
+        # Warm the code cache and the connection pool, so the first requests do not skew the percentiles
+        for _ in range(self.config.warmup):
+            try:
+                await self.send(self.pick_script() if self.config.endpoint == "execute" else "status")
+            except (aiohttp.ClientError, asyncio.TimeoutError):
+                pass
+
+        # Frame times with no load, as the baseline to compare against
+        idle_before = await self.scrape()
+        await asyncio.sleep(self.config.idle_seconds)
+        idle_after = await self.scrape()
+        result.idle_frames = self._window(idle_before, idle_after, ("uepython_frame_seconds", ""))
+
+        budget = [self.config.requests] if self.config.requests else []
+        duration = self.config.duration if not self.config.requests else float("inf")
+
+        load_before = await self.scrape()
+        start = time.perf_counter()
+        deadline = start + duration
+        await asyncio.gather(*[
+            self._worker(result, deadline, budget) for _ in range(max(self.config.concurrency, 1))
+        ])
+        result.wall_seconds = time.perf_counter() - start
+        load_after = await self.scrape()
+
+        result.load_frames = self._window(load_before, load_after, ("uepython_frame_seconds", ""))
+        for name, stage in load_after:
+            if name == "uepython_stage_seconds":
+                window = self._window(load_before, load_after, (name, stage))
+                if window[0] > 0:
+                    result.server_stages[stage] = window
+        return result